@@ -22,6 +22,8 @@
 #include <QFileSystemWatcher>
 #include <QSet>
 #include <QDebug>
+#include <QPixmapCache>
+#include <QImageReader>
 
 #define MAX_SIZE 1024
 
@@ -39,10 +41,16 @@ IconList::IconList(const QStringList &builtinPaths, QString path, QObject *paren
 			builtinNames.insert(file_info.baseName());
 		}
 	}
+	// nothing is looking at the model yet and the theme resolves the names when drawn
 	for(auto & builtinName : builtinNames)
 	{
-		addThemeIcon(builtinName);
+		MMCIcon mmc_icon;
+		mmc_icon.m_name = builtinName;
+		mmc_icon.m_key = builtinName;
+		mmc_icon.replace(Builtin, builtinName);
+		icons.push_back(mmc_icon);
 	}
+	reindex();
 
 	m_watcher.reset(new QFileSystemWatcher());
 	is_watching = false;
@@ -99,6 +107,7 @@ void IconList::directoryChanged(const QString &path)
 		if (idx == -1)
 			continue;
 		icons[idx].remove(IconType::FileBased);
+		invalidatePixmaps(key);
 		if (icons[idx].type() == IconType::ToBeDeleted)
 		{
 			beginRemoveRows(QModelIndex(), idx, idx);
@@ -137,11 +146,9 @@ void IconList::fileChanged(const QString &path)
 	int idx = getIconIndex(key);
 	if (idx == -1)
 		return;
-	QIcon icon(path);
-	if (!icon.availableSizes().size())
-		return;
-
-	icons[idx].m_images[IconType::FileBased].icon = icon;
+	// loaded again the next time it is used
+	icons[idx].m_images[IconType::FileBased].icon = QIcon();
+	invalidatePixmaps(key);
 	dataChanged(index(idx), index(idx));
 	emit iconUpdated(key);
 }
@@ -307,6 +314,7 @@ bool IconList::addThemeIcon(const QString& key)
 	{
 		auto &oldOne = icons[*iter];
 		oldOne.replace(Builtin, key);
+		invalidatePixmaps(key);
 		dataChanged(index(*iter), index(*iter));
 		return true;
 	}
@@ -329,15 +337,16 @@ bool IconList::addThemeIcon(const QString& key)
 
 bool IconList::addIcon(const QString &key, const QString &name, const QString &path, const IconType type)
 {
-	// replace the icon even? is the input valid?
-	QIcon icon(path);
-	if (!icon.availableSizes().size())
+	// only the file is remembered here, the image is loaded when it is first used
+	// the folder can contain anything, a look at the header weeds out what is not an image
+	if (!QFileInfo(path).isFile() || QImageReader::imageFormat(path).isEmpty())
 		return false;
 	auto iter = name_index.find(key);
 	if (iter != name_index.end())
 	{
 		auto &oldOne = icons[*iter];
-		oldOne.replace(type, icon, path);
+		oldOne.replace(type, QIcon(), path);
+		invalidatePixmaps(key);
 		dataChanged(index(*iter), index(*iter));
 		return true;
 	}
@@ -349,7 +358,7 @@ bool IconList::addIcon(const QString &key, const QString &name, const QString &p
 			MMCIcon mmc_icon;
 			mmc_icon.m_name = name;
 			mmc_icon.m_key = key;
-			mmc_icon.replace(type, icon, path);
+			mmc_icon.replace(type, QIcon(), path);
 			icons.push_back(mmc_icon);
 			name_index[key] = icons.size() - 1;
 		}
@@ -393,17 +402,72 @@ QIcon IconList::getIcon(const QString &key) const
 }
 
 QIcon IconList::getBigIcon(const QString &key) const
+{
+	auto bigone = cachedPixmap(key, 256, QIcon::Normal, true);
+	if (bigone.isNull())
+		return QIcon();
+	return QIcon(bigone);
+}
+
+int IconList::sizeBucket(int size)
+{
+	static const int buckets[] = {16, 24, 32, 48, 64, 96, 128, 256};
+	for (auto bucket : buckets)
+	{
+		if (size <= bucket)
+			return bucket;
+	}
+	return size;
+}
+
+QPixmap IconList::getPixmap(const QString &key, int size, QIcon::Mode mode) const
+{
+	return cachedPixmap(key, sizeBucket(size), mode, false);
+}
+
+QPixmap IconList::cachedPixmap(const QString &key, int side, QIcon::Mode mode, bool stretch) const
 {
 	int icon_index = getIconIndex(key);
 
 	// Fallback for icons that don't exist.
-	icon_index = getIconIndex(icon_index == -1 ? "infinity" : key);
+	if (icon_index == -1)
+		icon_index = getIconIndex("infinity");
 
 	if (icon_index == -1)
-		return QIcon();
+		return QPixmap();
+
+	auto &entry = icons[icon_index];
+	// builtin icons come from the theme, so the theme is part of the key
+	const QString cacheKey = QString("MultiMC-icon-%1-%2-%3-%4-%5")
+		.arg(QIcon::themeName(), entry.m_key)
+		.arg(side)
+		.arg(int(mode))
+		.arg(stretch ? "stretched" : "fitted");
+	QPixmap pixmap;
+	if (QPixmapCache::find(cacheKey, &pixmap))
+		return pixmap;
+
+	pixmap = entry.icon().pixmap(side, side, mode);
+	if (pixmap.isNull())
+	{
+		// unreadable icon file
+		if (entry.m_key != "infinity")
+			return cachedPixmap("infinity", side, mode, stretch);
+		return pixmap;
+	}
+	if (stretch)
+		pixmap = pixmap.scaled(side, side);
+	QPixmapCache::insert(cacheKey, pixmap);
+	m_pixmapKeys[entry.m_key].insert(cacheKey);
+	return pixmap;
+}
 
-	QPixmap bigone = icons[icon_index].icon().pixmap(256,256).scaled(256,256);
-	return QIcon(bigone);
+void IconList::invalidatePixmaps(const QString &key)
+{
+	for (auto &cacheKey : m_pixmapKeys.take(key))
+	{
+		QPixmapCache::remove(cacheKey);
+	}
 }
 
 int IconList::getIconIndex(const QString &key) const
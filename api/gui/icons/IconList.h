@@ -19,6 +19,8 @@
 #include <QAbstractListModel>
 #include <QFile>
 #include <QDir>
+#include <QHash>
+#include <QSet>
 #include <QtGui/QIcon>
 #include <memory>
 #include "MMCIcon.h"
@@ -41,6 +43,14 @@ public:
 	QIcon getBigIcon(const QString &key) const;
 	int getIconIndex(const QString &key) const;
 
+	/**
+	 * The icon rendered for a given size, rounded up to one of a few common sizes.
+	 * Rendered pixmaps are kept in the pixmap cache until the icon changes, so views painting
+	 * the same icons over and over only decode and scale them once.
+	 */
+	QPixmap getPixmap(const QString &key, int size, QIcon::Mode mode = QIcon::Normal) const;
+	static int sizeBucket(int size);
+
 	virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 	virtual int rowCount(const QModelIndex &parent = QModelIndex()) const override;
 
@@ -71,6 +81,8 @@ private:
 	// hide assign op
 	IconList &operator=(const IconList &) = delete;
 	void reindex();
+	QPixmap cachedPixmap(const QString &key, int side, QIcon::Mode mode, bool stretch) const;
+	void invalidatePixmaps(const QString &key);
 
 public slots:
 	void directoryChanged(const QString &path);
@@ -84,4 +96,6 @@ private:
 	QMap<QString, int> name_index;
 	QVector<MMCIcon> icons;
 	QDir m_dir;
+	// pixmap cache keys in use by each icon
+	mutable QHash<QString, QSet<QString>> m_pixmapKeys;
 };
@@ -59,11 +59,16 @@ QIcon MMCIcon::icon() const
 {
 	if (m_current_type == IconType::ToBeDeleted)
 		return QIcon();
-	auto & icon = m_images[m_current_type].icon;
-	if(!icon.isNull())
-		return icon;
+	auto & image = m_images[m_current_type];
+	if(!image.icon.isNull())
+		return image.icon;
+	if(!image.filename.isEmpty())
+	{
+		image.icon = QIcon(image.filename);
+		return image.icon;
+	}
 	// FIXME: inject this.
-	return XdgIcon::fromTheme(m_images[m_current_type].key);
+	return XdgIcon::fromTheme(image.key);
 }
 
 void MMCIcon::remove(IconType rm_type)
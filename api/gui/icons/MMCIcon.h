@@ -23,12 +23,13 @@
 
 struct MULTIMC_GUI_EXPORT MMCImage
 {
-	QIcon icon;
+	// file based images are only loaded when first used
+	mutable QIcon icon;
 	QString key;
 	QString filename;
 	bool present() const
 	{
-		return !icon.isNull() || !key.isEmpty();
+		return !icon.isNull() || !key.isEmpty() || !filename.isEmpty();
 	}
 };
 
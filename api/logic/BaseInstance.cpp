@@ -20,10 +20,12 @@
 #include <QDebug>
 
 #include "settings/INISettingsObject.h"
+#include "settings/SaveScheduler.h"
 #include "settings/Setting.h"
 #include "settings/OverrideSetting.h"
 
 #include "FileSystem.h"
+#include "BaseInstanceProvider.h"
 #include "Commandline.h"
 
 BaseInstance::BaseInstance(SettingsObjectPtr globalSettings, SettingsObjectPtr settings, const QString &rootDir)
@@ -106,7 +108,13 @@ void BaseInstance::nuke()
 {
 	changeStatus(Status::Gone);
 	qDebug() << "Instance" << id() << "has been deleted by MultiMC.";
-	FS::deletePath(instanceRoot());
+	// pending settings writes would recreate the folder
+	SaveScheduler::instance().discard(instanceRoot());
+	// big instances take a while to delete, let the provider do it in the background if it can
+	if(!m_provider || !m_provider->trashInstance(instanceRoot()))
+	{
+		FS::deletePath(instanceRoot());
+	}
 }
 
 void BaseInstance::changeStatus(BaseInstance::Status newStatus)
@@ -30,6 +30,20 @@ public:
 public:
 	virtual QList<InstanceId> discoverInstances() = 0;
 	virtual InstancePtr loadInstance(const InstanceId &id) = 0;
+	/// Load many instances at once. Failed ones are left out of the result.
+	virtual QList<InstancePtr> loadInstances(const QList<InstanceId> &ids)
+	{
+		QList<InstancePtr> out;
+		for(auto & id: ids)
+		{
+			auto instance = loadInstance(id);
+			if(instance)
+			{
+				out.append(instance);
+			}
+		}
+		return out;
+	}
 	virtual void loadGroupList() = 0;
 	virtual void saveGroupList() = 0;
 
@@ -45,6 +59,14 @@ public:
 	{
 		return true;
 	}
+	/**
+	 * Take the instance folder out of the provider right away and delete it later.
+	 * Returns false if that is not possible and the caller has to delete it.
+	 */
+	virtual bool trashInstance(const QString & instanceRoot)
+	{
+		return false;
+	}
 
 signals:
 	// Emit this when the list of provided instances changed
@@ -20,6 +20,11 @@ BaseVersionList::BaseVersionList(QObject *parent) : QAbstractListModel(parent)
 {
 }
 
+const StringIndex *BaseVersionList::filterIndex(int) const
+{
+	return nullptr;
+}
+
 BaseVersionPtr BaseVersionList::findVersion(const QString &descriptor)
 {
 	for (int i = 0; i < count(); i++)
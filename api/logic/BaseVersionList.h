@@ -24,6 +24,8 @@
 #include "multimc_logic_export.h"
 #include "QObjectPtr.h"
 
+class StringIndex;
+
 /*!
  * \brief Class that each instance type's version list derives from.
  * Version lists are the lists that keep track of the available game versions
@@ -85,6 +87,13 @@ public:
 	//! which roles are provided by this version list?
 	virtual RoleList providesRoles() const;
 
+	/*!
+	 * \brief Gets the filter index of a role, if the list maintains one.
+	 * The index has to be up to date whenever the list emits a model signal.
+	 * \return The index, or nullptr if filtering by this role has to go through data().
+	 */
+	virtual const StringIndex *filterIndex(int role) const;
+
 	/*!
 	 * \brief Finds a version by its descriptor.
 	 * \param descriptor The descriptor of the version to find.
@@ -103,7 +103,8 @@ void Env::initHttpMetaCache()
 	m_metacache->addBase("translations", QDir("translations").absolutePath());
 	m_metacache->addBase("icons", QDir("cache/icons").absolutePath());
 	m_metacache->addBase("meta", QDir("meta").absolutePath());
-	m_metacache->Load();
+	m_metacache->addBase("flame", QDir("cache/flame").absolutePath());
+	m_metacache->LoadInBackground();
 }
 
 void Env::updateProxySettings(QString proxyTypeStr, QString addr, int port, QString user, QString password)
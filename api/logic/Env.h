@@ -43,7 +43,7 @@ public:
 
 	std::shared_ptr<IIconList> icons();
 
-	/// init the cache. FIXME: possible future hook point
+	/// init the cache. The index is read in the background. FIXME: possible future hook point
 	void initHttpMetaCache();
 
 	/// Updates the application proxy settings from the settings object.
@@ -8,6 +8,25 @@
 #include <QDebug>
 #include <QUrl>
 #include <QStandardPaths>
+#include <QtConcurrentMap>
+
+#if defined Q_OS_WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+#if defined Q_OS_LINUX
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+#if defined Q_OS_MAC && defined __has_include
+#if __has_include(<sys/clonefile.h>)
+#include <sys/clonefile.h>
+#define MMC_HAVE_CLONEFILE
+#endif
+#endif
 
 namespace FS {
 
@@ -164,11 +183,238 @@ bool copy::operator()(const QString &offset)
 }
 
 
+FolderCopy::FolderCopy(const QString & src, const QString & dst)
+{
+	m_src = src;
+	m_dst = dst;
+}
+
+bool FolderCopy::scan()
+{
+	//NOTE always deep copy on windows. the alternatives are too messy.
+	#if defined Q_OS_WIN32
+	m_followSymlinks = true;
+	#endif
+	m_folders.clear();
+	m_symlinks.clear();
+	m_files.clear();
+	m_totalBytes = 0;
+	return scan(QString());
+}
+
+bool FolderCopy::scan(const QString &offset)
+{
+	auto src = PathCombine(m_src.absolutePath(), offset);
+	auto dst = PathCombine(m_dst.absolutePath(), offset);
+
+	QFileInfo currentSrc(src);
+	if (!currentSrc.exists())
+		return false;
+
+	if(!m_followSymlinks && currentSrc.isSymLink())
+	{
+		m_symlinks.append(qMakePair(currentSrc.symLinkTarget(), dst));
+	}
+	else if(currentSrc.isFile())
+	{
+		File file;
+		file.src = src;
+		file.dst = dst;
+		file.size = currentSrc.size();
+		file.hardLink = m_hardLinks && m_hardLinks->matches(offset);
+		m_totalBytes += file.size;
+		m_files.append(file);
+	}
+	else if(currentSrc.isDir())
+	{
+		m_folders.append(dst);
+		QDir currentDir(src);
+		for(auto & f : currentDir.entryList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System))
+		{
+			auto inner_offset = PathCombine(offset, f);
+			// ignore and skip stuff that matches the blacklist.
+			if(m_blacklist && m_blacklist->matches(inner_offset))
+			{
+				continue;
+			}
+			if(!scan(inner_offset))
+			{
+				qWarning() << "Failed to read" << inner_offset;
+				return false;
+			}
+		}
+	}
+	else
+	{
+		qCritical() << "Copy ERROR: Unknown filesystem object:" << src;
+		return false;
+	}
+	return true;
+}
+
+// shares the storage of src with a new file dst (copy on write). Fails if the file system can't.
+static bool cloneFile(const QString &src, const QString &dst)
+{
+#if defined Q_OS_LINUX && defined FICLONE
+	int in = ::open(QFile::encodeName(src).constData(), O_RDONLY | O_CLOEXEC);
+	if (in < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	if (::fstat(in, &info) != 0)
+	{
+		::close(in);
+		return false;
+	}
+	int out = ::open(QFile::encodeName(dst).constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, info.st_mode & 07777);
+	if (out < 0)
+	{
+		::close(in);
+		return false;
+	}
+	bool cloned = ::ioctl(out, FICLONE, in) == 0;
+	::close(out);
+	::close(in);
+	if (!cloned)
+	{
+		QFile::remove(dst);
+	}
+	return cloned;
+#elif defined MMC_HAVE_CLONEFILE
+	return ::clonefile(QFile::encodeName(src).constData(), QFile::encodeName(dst).constData(), 0) == 0;
+#else
+	Q_UNUSED(src);
+	Q_UNUSED(dst);
+	return false;
+#endif
+}
+
+static bool hardLinkFile(const QString &src, const QString &dst)
+{
+#if defined Q_OS_WIN32
+	auto srcPath = QDir::toNativeSeparators(src).toStdWString();
+	auto dstPath = QDir::toNativeSeparators(dst).toStdWString();
+	return CreateHardLinkW(dstPath.c_str(), srcPath.c_str(), nullptr) != 0;
+#else
+	return ::link(QFile::encodeName(src).constData(), QFile::encodeName(dst).constData()) == 0;
+#endif
+}
+
+static bool copyFileContents(const QString &src, const QString &dst, std::function<void(qint64)> &progress,
+							 const QAtomicInt *aborted)
+{
+	QFile in(src);
+	if (!in.open(QIODevice::ReadOnly))
+	{
+		qCritical() << "Couldn't open" << src << "for reading:" << in.errorString();
+		return false;
+	}
+	QFile out(dst);
+	if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qCritical() << "Couldn't open" << dst << "for writing:" << out.errorString();
+		return false;
+	}
+	out.setPermissions(in.permissions());
+	QByteArray buffer(1024 * 1024, Qt::Uninitialized);
+	qint64 read;
+	while ((read = in.read(buffer.data(), buffer.size())) > 0)
+	{
+		if (out.write(buffer.constData(), read) != read)
+		{
+			qCritical() << "Couldn't write" << dst << ":" << out.errorString();
+			return false;
+		}
+		if (progress)
+		{
+			progress(read);
+		}
+		if (aborted && aborted->load())
+		{
+			return false;
+		}
+	}
+	if (read < 0)
+	{
+		qCritical() << "Couldn't read" << src << ":" << in.errorString();
+		return false;
+	}
+	return true;
+}
+
+bool FolderCopy::run(std::function<void(qint64)> progress, const QAtomicInt * aborted)
+{
+	// folders and symlinks are few and cheap, and the files need the folders to exist
+	for(auto & folder: m_folders)
+	{
+		if (!ensureFolderPathExists(folder))
+		{
+			qWarning() << "Cannot create path" << folder;
+			return false;
+		}
+	}
+	for(auto & symlink: m_symlinks)
+	{
+		if (!QFile::link(symlink.first, symlink.second))
+		{
+			qWarning() << "Cannot create symlink" << symlink.second;
+			return false;
+		}
+	}
+
+	QAtomicInt failed;
+	// the whole copy is on one file system, the first failed clone says it can't clone at all
+	QAtomicInt canClone(1);
+	QAtomicInt cloned;
+	QAtomicInt linked;
+	auto copyFile = [&](const File &file)
+	{
+		if (failed.load() || (aborted && aborted->load()))
+		{
+			return;
+		}
+		bool done = false;
+		if (file.hardLink && hardLinkFile(file.src, file.dst))
+		{
+			linked.fetchAndAddRelaxed(1);
+			done = true;
+		}
+		else if (canClone.load())
+		{
+			if (cloneFile(file.src, file.dst))
+			{
+				cloned.fetchAndAddRelaxed(1);
+				done = true;
+			}
+			else
+			{
+				canClone.storeRelease(0);
+			}
+		}
+		if (done)
+		{
+			if (progress)
+			{
+				progress(file.size);
+			}
+			return;
+		}
+		if (!copyFileContents(file.src, file.dst, progress, aborted))
+		{
+			failed.storeRelease(1);
+		}
+	};
+	QtConcurrent::blockingMap(m_files, copyFile);
+	m_clonedFiles = cloned.load();
+	m_linkedFiles = linked.load();
+	return !failed.load() && !(aborted && aborted->load());
+}
+
 #if defined Q_OS_WIN32
-#include <windows.h>
 #include <string>
 #endif
-bool deletePath(QString path)
+bool deletePath(QString path, const QAtomicInt * aborted)
 {
 	bool OK = true;
 	QDir dir(path);
@@ -183,6 +429,10 @@ bool deletePath(QString path)
 
 	for(auto & info: allEntries)
 	{
+		if (aborted && aborted->load())
+		{
+			return false;
+		}
 #if defined Q_OS_WIN32
 		QString nativePath = QDir::toNativeSeparators(info.absoluteFilePath());
 		auto wString = nativePath.toStdWString();
@@ -208,7 +458,7 @@ bool deletePath(QString path)
 #endif
 		else if (info.isDir())
 		{
-			OK &= deletePath(info.absoluteFilePath());
+			OK &= deletePath(info.absoluteFilePath(), aborted);
 		}
 		else if (info.isFile())
 		{
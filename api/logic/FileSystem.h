@@ -8,6 +8,8 @@
 #include "multimc_logic_export.h"
 #include <QDir>
 #include <QFlags>
+#include <QAtomicInt>
+#include <functional>
 
 namespace FS
 {
@@ -78,10 +80,90 @@ private:
 	QDir m_dst;
 };
 
+/**
+ * Copies a whole folder, for when there is a lot of it.
+ *
+ * The source is walked once by scan(), then run() clones the files where the file system can
+ * share their storage (reflinks), hard links the ones picked by the hard link filter, and copies
+ * the rest through the thread pool. Progress is reported in bytes and the copy can be aborted.
+ */
+class MULTIMC_LOGIC_EXPORT FolderCopy
+{
+public:
+	FolderCopy(const QString & src, const QString & dst);
+	FolderCopy & followSymlinks(const bool follow)
+	{
+		m_followSymlinks = follow;
+		return *this;
+	}
+	FolderCopy & blacklist(const IPathMatcher * filter)
+	{
+		m_blacklist = filter;
+		return *this;
+	}
+	/// Files matching the filter are hard linked instead of copied, if the file system allows it.
+	FolderCopy & hardLinks(const IPathMatcher * filter)
+	{
+		m_hardLinks = filter;
+		return *this;
+	}
+
+	/// Walks the source folder. Returns false if it can't be read.
+	bool scan();
+	qint64 totalBytes() const
+	{
+		return m_totalBytes;
+	}
+	int fileCount() const
+	{
+		return m_files.size();
+	}
+
+	/**
+	 * Copies what scan() found.
+	 * \param progress Gets the bytes done since its last call, from several threads at once.
+	 * \param aborted The copy stops early when this becomes non-zero.
+	 */
+	bool run(std::function<void(qint64)> progress = nullptr, const QAtomicInt * aborted = nullptr);
+
+	int clonedFiles() const
+	{
+		return m_clonedFiles;
+	}
+	int linkedFiles() const
+	{
+		return m_linkedFiles;
+	}
+
+private:
+	bool scan(const QString &offset);
+
+private:
+	struct File
+	{
+		QString src;
+		QString dst;
+		qint64 size = 0;
+		bool hardLink = false;
+	};
+	bool m_followSymlinks = true;
+	const IPathMatcher * m_blacklist = nullptr;
+	const IPathMatcher * m_hardLinks = nullptr;
+	QDir m_src;
+	QDir m_dst;
+	QStringList m_folders;
+	QList<QPair<QString, QString>> m_symlinks;
+	QList<File> m_files;
+	qint64 m_totalBytes = 0;
+	int m_clonedFiles = 0;
+	int m_linkedFiles = 0;
+};
+
 /**
  * Delete a folder recursively
+ * Stops early when \p aborted becomes non-zero.
  */
-MULTIMC_LOGIC_EXPORT bool deletePath(QString path);
+MULTIMC_LOGIC_EXPORT bool deletePath(QString path, const QAtomicInt * aborted = nullptr);
 
 MULTIMC_LOGIC_EXPORT QString PathCombine(QString path1, QString path2);
 MULTIMC_LOGIC_EXPORT QString PathCombine(QString path1, QString path2, QString path3);
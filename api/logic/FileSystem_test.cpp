@@ -4,6 +4,7 @@
 #include "TestUtil.h"
 
 #include "FileSystem.h"
+#include "pathmatcher/RegexpMatcher.h"
 
 class FileSystemTest : public QObject
 {
@@ -112,6 +113,53 @@ slots:
 		f();
 	}
 
+	void test_FolderCopy()
+	{
+		QTemporaryDir tempDir;
+		tempDir.setAutoRemove(true);
+		auto src = FS::PathCombine(tempDir.path(), "instance");
+		auto dst = FS::PathCombine(tempDir.path(), "copy");
+		FS::write(FS::PathCombine(src, "instance.cfg"), "name=Test\n");
+		FS::write(FS::PathCombine(src, "minecraft/mods/mod.jar"), QByteArray(300 * 1024, 'm'));
+		FS::write(FS::PathCombine(src, "minecraft/config/mod.cfg"), QByteArray(3 * 1024 * 1024 + 17, 'c'));
+		FS::write(FS::PathCombine(src, "minecraft/saves/world/level.dat"), "level");
+		QDir().mkpath(FS::PathCombine(src, "minecraft/empty"));
+
+		RegexpMatcher saves("[.]?minecraft/saves");
+		RegexpMatcher mods("^minecraft/mods/.*[.]jar$");
+		FS::FolderCopy folderCopy(src, dst);
+		folderCopy.followSymlinks(false).blacklist(&saves).hardLinks(&mods);
+		QVERIFY(folderCopy.scan());
+		QCOMPARE(folderCopy.fileCount(), 3);
+		QCOMPARE(folderCopy.totalBytes(), qint64(10 + 300 * 1024 + 3 * 1024 * 1024 + 17));
+
+		QAtomicInteger<qint64> done;
+		QVERIFY(folderCopy.run([&](qint64 bytes) { done.fetchAndAddRelaxed(bytes); }));
+		QCOMPARE(done.load(), folderCopy.totalBytes());
+
+		QCOMPARE(FS::read(FS::PathCombine(dst, "instance.cfg")), QByteArray("name=Test\n"));
+		QCOMPARE(FS::read(FS::PathCombine(dst, "minecraft/mods/mod.jar")), QByteArray(300 * 1024, 'm'));
+		QCOMPARE(FS::read(FS::PathCombine(dst, "minecraft/config/mod.cfg")), QByteArray(3 * 1024 * 1024 + 17, 'c'));
+		QVERIFY(QDir(FS::PathCombine(dst, "minecraft/empty")).exists());
+		QVERIFY(!QFile::exists(FS::PathCombine(dst, "minecraft/saves")));
+		QCOMPARE(folderCopy.linkedFiles(), 1);
+	}
+
+	void test_FolderCopyAbort()
+	{
+		QTemporaryDir tempDir;
+		tempDir.setAutoRemove(true);
+		auto src = FS::PathCombine(tempDir.path(), "instance");
+		for(int i = 0; i < 10; i++)
+		{
+			FS::write(FS::PathCombine(src, QString("file%1").arg(i)), QByteArray(1024, 'x'));
+		}
+		FS::FolderCopy folderCopy(src, FS::PathCombine(tempDir.path(), "copy"));
+		QVERIFY(folderCopy.scan());
+		QAtomicInt aborted(1);
+		QVERIFY(!folderCopy.run(nullptr, &aborted));
+	}
+
 	void test_getDesktop()
 	{
 		QCOMPARE(FS::getDesktopDir(), QStandardPaths::writableLocation(QStandardPaths::DesktopLocation));
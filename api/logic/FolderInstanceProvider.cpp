@@ -1,17 +1,21 @@
 #include "FolderInstanceProvider.h"
 #include "settings/INISettingsObject.h"
+#include "settings/SaveScheduler.h"
 #include "FileSystem.h"
 #include "minecraft/onesix/OneSixInstance.h"
 #include "minecraft/legacy/LegacyInstance.h"
 #include "NullInstance.h"
+#include "Trace.h"
 
 #include <QDir>
+#include <QtConcurrentMap>
 #include <QDirIterator>
 #include <QFileSystemWatcher>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QUuid>
+#include <QThread>
 
 const static int GROUP_FILE_FORMAT_VERSION = 1;
 
@@ -30,6 +34,41 @@ struct WatchLock
 	QString m_instDir;
 };
 
+// deletes everything in the trash folder, on its own thread so it can run at the lowest priority
+class TrashCollector : public QThread
+{
+public:
+	TrashCollector(const QString & trash) : m_trash(trash)
+	{
+	}
+	void stop()
+	{
+		m_aborted.storeRelease(1);
+	}
+
+protected:
+	void run() override
+	{
+		QDir trash(m_trash);
+		for(auto & entry: trash.entryList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System))
+		{
+			if(m_aborted.load())
+			{
+				return;
+			}
+			auto path = trash.absoluteFilePath(entry);
+			if(!FS::deletePath(path, &m_aborted) && !m_aborted.load())
+			{
+				qWarning() << "Could not delete" << path << "from the trash";
+			}
+		}
+	}
+
+private:
+	QString m_trash;
+	QAtomicInt m_aborted;
+};
+
 FolderInstanceProvider::FolderInstanceProvider(SettingsObjectPtr settings, const QString& instDir)
 	: BaseInstanceProvider(settings)
 {
@@ -41,6 +80,19 @@ FolderInstanceProvider::FolderInstanceProvider(SettingsObjectPtr settings, const
 	m_watcher = new QFileSystemWatcher(this);
 	connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &FolderInstanceProvider::instanceDirContentsChanged);
 	m_watcher->addPath(m_instDir);
+	// finish deleting what was trashed before the last exit
+	emptyTrash();
+}
+
+FolderInstanceProvider::~FolderInstanceProvider()
+{
+	if(m_trashCollector)
+	{
+		// the rest is picked up on the next start
+		m_trashCollector->stop();
+		m_trashCollector->wait();
+		delete m_trashCollector;
+	}
 }
 
 QList< InstanceId > FolderInstanceProvider::discoverInstances()
@@ -75,11 +127,64 @@ InstancePtr FolderInstanceProvider::loadInstance(const InstanceId& id)
 {
 	if(!m_groupsLoaded)
 	{
+		Trace::Span span("Load groups");
 		loadGroupList();
 	}
 
 	auto instanceRoot = FS::PathCombine(m_instDir, id);
-	auto instanceSettings = std::make_shared<INISettingsObject>(FS::PathCombine(instanceRoot, "instance.cfg"));
+	std::shared_ptr<INISettingsObject> instanceSettings;
+	{
+		Trace::Span span("Instance settings");
+		instanceSettings = std::make_shared<INISettingsObject>(FS::PathCombine(instanceRoot, "instance.cfg"));
+	}
+	return createInstance(id, instanceSettings);
+}
+
+QList<InstancePtr> FolderInstanceProvider::loadInstances(const QList<InstanceId> &ids)
+{
+	if(!m_groupsLoaded)
+	{
+		Trace::Span span("Load groups");
+		loadGroupList();
+	}
+
+	// reading and parsing the configs is most of the work, and it does not need this thread
+	struct Config
+	{
+		QString path;
+		INIFile contents;
+	};
+	QVector<Config> configs;
+	configs.reserve(ids.size());
+	for(auto & id: ids)
+	{
+		configs.append({FS::PathCombine(m_instDir, id, "instance.cfg"), INIFile()});
+	}
+	{
+		Trace::Span span("Read instance configs", QString::number(ids.size()));
+		QtConcurrent::blockingMap(configs, [](Config & config)
+		{
+			config.contents.loadFile(config.path);
+		});
+	}
+
+	QList<InstancePtr> out;
+	for(int i = 0; i < ids.size(); i++)
+	{
+		Trace::Span span("Load instance", ids[i]);
+		auto instanceSettings = std::make_shared<INISettingsObject>(configs[i].path, configs[i].contents);
+		auto inst = createInstance(ids[i], instanceSettings);
+		if(inst)
+		{
+			out.append(inst);
+		}
+	}
+	return out;
+}
+
+InstancePtr FolderInstanceProvider::createInstance(const InstanceId &id, std::shared_ptr<INISettingsObject> instanceSettings)
+{
+	auto instanceRoot = FS::PathCombine(m_instDir, id);
 	InstancePtr inst;
 
 	instanceSettings->registerSetting("InstanceType", "Legacy");
@@ -98,7 +203,10 @@ InstancePtr FolderInstanceProvider::loadInstance(const InstanceId& id)
 	{
 		inst.reset(new NullInstance(m_globalSettings, instanceSettings, instanceRoot));
 	}
-	inst->init();
+	{
+		Trace::Span span("Instance init", inst_type);
+		inst->init();
+	}
 	inst->setProvider(this);
 	auto iter = groupMap.find(id);
 	if (iter != groupMap.end())
@@ -123,9 +231,9 @@ Task * FolderInstanceProvider::creationTask(BaseVersionPtr version, const QStrin
 }
 
 #include "InstanceCopyTask.h"
-Task * FolderInstanceProvider::copyTask(const InstancePtr& oldInstance, const QString& instName, const QString& instGroup, const QString& instIcon, bool copySaves)
+Task * FolderInstanceProvider::copyTask(const InstancePtr& oldInstance, const QString& instName, const QString& instGroup, const QString& instIcon, bool copySaves, bool linkFiles)
 {
-	return new InstanceCopyTask(m_globalSettings, this, oldInstance, instName, instIcon, instGroup, copySaves);
+	return new InstanceCopyTask(m_globalSettings, this, oldInstance, instName, instIcon, instGroup, copySaves, linkFiles);
 }
 
 void FolderInstanceProvider::saveGroupList()
@@ -308,6 +416,7 @@ void FolderInstanceProvider::on_InstFolderChanged(const Setting &setting, QVaria
 		m_instDir = newInstDir;
 		m_groupsLoaded = false;
 		emit instancesChanged();
+		emptyTrash();
 	}
 }
 
@@ -334,6 +443,8 @@ bool FolderInstanceProvider::commitStagedInstance(const QString& keyPath, const
 	}
 	QDir dir;
 	QString instID = FS::DirNameFromString(instanceName, m_instDir);
+	// the staged settings have to be on disk before the folder moves
+	SaveScheduler::instance().flush(keyPath);
 	{
 		WatchLock lock(m_watcher, m_instDir);
 		if(!dir.rename(path, FS::PathCombine(m_instDir, instID)))
@@ -351,6 +462,71 @@ bool FolderInstanceProvider::commitStagedInstance(const QString& keyPath, const
 
 bool FolderInstanceProvider::destroyStagingPath(const QString& keyPath)
 {
+	SaveScheduler::instance().discard(keyPath);
+	if(moveToTrash(keyPath))
+	{
+		return true;
+	}
 	return FS::deletePath(keyPath);
 }
 
+bool FolderInstanceProvider::trashInstance(const QString& instanceRoot)
+{
+	{
+		WatchLock lock(m_watcher, m_instDir);
+		if(!moveToTrash(instanceRoot))
+		{
+			return false;
+		}
+		emit instancesChanged();
+	}
+	return true;
+}
+
+QString FolderInstanceProvider::trashPath() const
+{
+	return FS::PathCombine(m_instDir, "_MMC_TRASH");
+}
+
+bool FolderInstanceProvider::moveToTrash(const QString& path)
+{
+	// a rename within the instance folder is atomic, the folder is either there or in the trash
+	QString target = FS::PathCombine(trashPath(), QUuid::createUuid().toString());
+	QDir dir;
+	if(!dir.mkpath(trashPath()) || !dir.rename(path, target))
+	{
+		qWarning() << "Could not move" << path << "to the trash";
+		return false;
+	}
+	emptyTrash();
+	return true;
+}
+
+void FolderInstanceProvider::emptyTrash()
+{
+	if(m_trashCollector)
+	{
+		m_trashPending = true;
+		return;
+	}
+	auto trash = trashPath();
+	if(!QDir(trash).exists())
+	{
+		return;
+	}
+	m_trashPending = false;
+	m_trashCollector = new TrashCollector(trash);
+	connect(m_trashCollector, &QThread::finished, this, &FolderInstanceProvider::trashEmptied);
+	m_trashCollector->start(QThread::LowestPriority);
+}
+
+void FolderInstanceProvider::trashEmptied()
+{
+	m_trashCollector->deleteLater();
+	m_trashCollector = nullptr;
+	if(m_trashPending)
+	{
+		emptyTrash();
+	}
+}
+
@@ -4,12 +4,15 @@
 #include <QMap>
 
 class QFileSystemWatcher;
+class TrashCollector;
+class INISettingsObject;
 
 class MULTIMC_LOGIC_EXPORT FolderInstanceProvider : public BaseInstanceProvider
 {
 	Q_OBJECT
 public:
 	FolderInstanceProvider(SettingsObjectPtr settings, const QString & instDir);
+	virtual ~FolderInstanceProvider();
 
 public:
 	/// used by InstanceList to @return a list of plausible IDs to probe for
@@ -18,12 +21,15 @@ public:
 	/// used by InstanceList to (re)load an instance with the given @id.
 	InstancePtr loadInstance(const InstanceId& id) override;
 
+	/// reads all the instance configs in parallel, then creates the instances
+	QList<InstancePtr> loadInstances(const QList<InstanceId> &ids) override;
+
 
 	// create instance in this provider
 	Task * creationTask(BaseVersionPtr version, const QString &instName, const QString &instGroup, const QString &instIcon);
 
 	// copy instance to this provider
-	Task * copyTask(const InstancePtr &oldInstance, const QString& instName, const QString& instGroup, const QString& instIcon, bool copySaves);
+	Task * copyTask(const InstancePtr &oldInstance, const QString& instName, const QString& instGroup, const QString& instIcon, bool copySaves, bool linkFiles = false);
 
 	// import zipped instance into this provider
 	Task * zipImportTask(const QUrl sourceUrl, const QString &instName, const QString &instGroup, const QString &instIcon);
@@ -43,6 +49,11 @@ public:
 	 * Used by instance manipulation tasks.
 	 */
 	bool destroyStagingPath(const QString & keyPath) override;
+	/**
+	 * Move the instance into the trash folder, which is emptied in the background.
+	 * Whatever is left in the trash is deleted on the next start.
+	 */
+	bool trashInstance(const QString & instanceRoot) override;
 
 public slots:
 	void on_InstFolderChanged(const Setting &setting, QVariant value);
@@ -50,14 +61,21 @@ public slots:
 private slots:
 	void instanceDirContentsChanged(const QString &path);
 	void groupChanged();
+	void trashEmptied();
 
 private: /* methods */
 	void loadGroupList() override;
 	void saveGroupList() override;
+	QString trashPath() const;
+	bool moveToTrash(const QString & path);
+	void emptyTrash();
+	InstancePtr createInstance(const InstanceId &id, std::shared_ptr<INISettingsObject> instanceSettings);
 
 private: /* data */
 	QString m_instDir;
 	QFileSystemWatcher * m_watcher;
 	QMap<QString, QString> groupMap;
 	bool m_groupsLoaded = false;
+	TrashCollector * m_trashCollector = nullptr;
+	bool m_trashPending = false;
 };
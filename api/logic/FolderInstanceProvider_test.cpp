@@ -0,0 +1,126 @@
+#include <QTest>
+#include <QSignalSpy>
+#include "TestUtil.h"
+
+#include "FolderInstanceProvider.h"
+#include "BaseInstance.h"
+#include "FileSystem.h"
+#include "settings/INISettingsObject.h"
+
+class FolderInstanceProviderTest : public QObject
+{
+	Q_OBJECT
+private:
+	// what instances need from the global settings
+	SettingsObjectPtr makeGlobalSettings()
+	{
+		auto settings = std::make_shared<INISettingsObject>(QString());
+		for(auto id: {"PreLaunchCommand", "WrapperCommand", "PostExitCommand"})
+		{
+			settings->registerSetting(id, "");
+		}
+		for(auto id: {"ShowConsole", "AutoCloseConsole", "ShowConsoleOnError", "LogPrePostOutput", "ConsoleOverflowStop"})
+		{
+			settings->registerSetting(id, true);
+		}
+		settings->registerSetting("ConsoleMaxLines", 100000);
+		return settings;
+	}
+	// a big instance folder, the type is unknown so nothing but the config is read
+	void makeInstances(int count)
+	{
+		for(int i = 0; i < count; i++)
+		{
+			QString cfg = QString("InstanceType=Unknown\nname=Instance %1\niconKey=default\nnotes=\n").arg(i);
+			for(int j = 0; j < 40; j++)
+			{
+				cfg += QString("SomeSetting%1=some value %2\n").arg(j).arg(i);
+			}
+			FS::write(QString("test_instances/inst%1/instance.cfg").arg(i), cfg.toUtf8());
+		}
+	}
+
+private
+slots:
+	void init()
+	{
+		QDir("test_instances").removeRecursively();
+	}
+	void cleanupTestCase()
+	{
+		QDir("test_instances").removeRecursively();
+	}
+
+	void test_TrashInstance()
+	{
+		FS::write("test_instances/doomed/instance.cfg", "InstanceType=OneSix\n");
+		for(int i = 0; i < 20; i++)
+		{
+			FS::write(QString("test_instances/doomed/minecraft/mods/mod%1.jar").arg(i), QByteArray(64 * 1024, 'm'));
+		}
+		FolderInstanceProvider provider(nullptr, "test_instances");
+		QCOMPARE(provider.discoverInstances(), QList<InstanceId>({"doomed"}));
+
+		QSignalSpy changed(&provider, &BaseInstanceProvider::instancesChanged);
+		QVERIFY(provider.trashInstance(QDir("test_instances/doomed").absolutePath()));
+		// gone for everyone right away, deleted later
+		QCOMPARE(changed.count(), 1);
+		QVERIFY(provider.discoverInstances().isEmpty());
+		QVERIFY(!QDir("test_instances/doomed").exists());
+		QTRY_VERIFY(QDir("test_instances/_MMC_TRASH").entryList(QDir::AllEntries | QDir::NoDotAndDotDot).isEmpty());
+	}
+
+	void test_ResumeOnStart()
+	{
+		// left behind by an exit in the middle of deleting
+		FS::write("test_instances/_MMC_TRASH/{leftover}/instance.cfg", "InstanceType=OneSix\n");
+		FS::write("test_instances/_MMC_TRASH/{leftover}/minecraft/options.txt", "fov:70\n");
+		FolderInstanceProvider provider(nullptr, "test_instances");
+		QVERIFY(provider.discoverInstances().isEmpty());
+		QTRY_VERIFY(!QDir("test_instances/_MMC_TRASH/{leftover}").exists());
+	}
+
+	void test_LoadInstances()
+	{
+		makeInstances(20);
+		FolderInstanceProvider provider(makeGlobalSettings(), "test_instances");
+		auto ids = provider.discoverInstances();
+		QCOMPARE(ids.size(), 20);
+		auto instances = provider.loadInstances(ids);
+		QCOMPARE(instances.size(), 20);
+		for(int i = 0; i < ids.size(); i++)
+		{
+			QCOMPARE(instances[i]->id(), ids[i]);
+			QCOMPARE(instances[i]->name(), provider.loadInstance(ids[i])->name());
+		}
+	}
+
+	void test_LoadInstance_benchmark()
+	{
+		makeInstances(800);
+		FolderInstanceProvider provider(makeGlobalSettings(), "test_instances");
+		auto ids = provider.discoverInstances();
+		QBENCHMARK
+		{
+			for(auto &id: ids)
+			{
+				QVERIFY(provider.loadInstance(id));
+			}
+		}
+	}
+
+	void test_LoadInstances_benchmark()
+	{
+		makeInstances(800);
+		FolderInstanceProvider provider(makeGlobalSettings(), "test_instances");
+		auto ids = provider.discoverInstances();
+		QBENCHMARK
+		{
+			QCOMPARE(provider.loadInstances(ids).size(), ids.size());
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(FolderInstanceProviderTest)
+
+#include "FolderInstanceProvider_test.moc"
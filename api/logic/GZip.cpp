@@ -1,6 +1,7 @@
 #include "GZip.h"
 #include <zlib.h>
 #include <QByteArray>
+#include <QIODevice>
 
 bool GZip::unzip(const QByteArray &compressedBytes, QByteArray &uncompressedBytes)
 {
@@ -112,4 +113,84 @@ bool GZip::zip(const QByteArray &uncompressedBytes, QByteArray &compressedBytes)
 		return false;
 	}
 	return true;
-}
\ No newline at end of file
+}
+
+struct GZipStreamBuf::Private
+{
+	QIODevice *device = nullptr;
+	z_stream strm;
+	bool initialized = false;
+	bool finished = false;
+	bool error = false;
+	char in[16384];
+	char out[16384];
+};
+
+GZipStreamBuf::GZipStreamBuf(QIODevice *device) : d(new Private)
+{
+	d->device = device;
+	memset(&d->strm, 0, sizeof(d->strm));
+	// 32 makes zlib detect gzip and zlib headers
+	d->initialized = inflateInit2(&d->strm, (32 + MAX_WBITS)) == Z_OK;
+	d->error = !d->initialized;
+	setg(d->out, d->out, d->out);
+}
+
+GZipStreamBuf::~GZipStreamBuf()
+{
+	if (d->initialized)
+	{
+		inflateEnd(&d->strm);
+	}
+}
+
+bool GZipStreamBuf::hasError() const
+{
+	return d->error;
+}
+
+qint64 GZipStreamBuf::inflatedBytes() const
+{
+	return d->strm.total_out;
+}
+
+GZipStreamBuf::int_type GZipStreamBuf::underflow()
+{
+	if (gptr() < egptr())
+	{
+		return traits_type::to_int_type(*gptr());
+	}
+	while (!d->finished && !d->error)
+	{
+		if (d->strm.avail_in == 0)
+		{
+			auto got = d->device->read(d->in, sizeof(d->in));
+			if (got <= 0)
+			{
+				// the stream ended before the compressed data did
+				d->error = true;
+				break;
+			}
+			d->strm.next_in = (Bytef *)d->in;
+			d->strm.avail_in = got;
+		}
+		d->strm.next_out = (Bytef *)d->out;
+		d->strm.avail_out = sizeof(d->out);
+		auto err = inflate(&d->strm, Z_NO_FLUSH);
+		if (err == Z_STREAM_END)
+		{
+			d->finished = true;
+		}
+		else if (err != Z_OK)
+		{
+			d->error = true;
+		}
+		auto produced = sizeof(d->out) - d->strm.avail_out;
+		if (produced)
+		{
+			setg(d->out, d->out, d->out + produced);
+			return traits_type::to_int_type(*gptr());
+		}
+	}
+	return traits_type::eof();
+}
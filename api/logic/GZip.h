@@ -1,5 +1,7 @@
 #pragma once
 #include <QByteArray>
+#include <streambuf>
+#include <memory>
 
 #include "multimc_logic_export.h"
 
@@ -10,3 +12,30 @@ public:
 	static bool zip(const QByteArray &uncompressedBytes, QByteArray &compressedBytes);
 };
 
+
+class QIODevice;
+
+/**
+ * Input stream buffer that inflates gzip (or zlib) data from a device as it is read.
+ *
+ * Nothing past what the reader asks for is read from the device or inflated.
+ */
+class MULTIMC_LOGIC_EXPORT GZipStreamBuf : public std::streambuf
+{
+public:
+	explicit GZipStreamBuf(QIODevice *device);
+	virtual ~GZipStreamBuf();
+
+	/// true if the compressed data was corrupted or couldn't be read
+	bool hasError() const;
+
+	/// how many uncompressed bytes were produced so far
+	qint64 inflatedBytes() const;
+
+protected:
+	int_type underflow() override;
+
+private:
+	struct Private;
+	std::unique_ptr<Private> d;
+};
@@ -3,6 +3,8 @@
 
 #include "GZip.h"
 #include <random>
+#include <istream>
+#include <QBuffer>
 
 void fib(int &prev, int &cur)
 {
@@ -50,6 +52,41 @@ slots:
 			fib(prev, cur);
 		} while (cur < size);
 	}
+
+	void test_StreamBuf()
+	{
+		QByteArray data;
+		for(int i = 0; i < 100000; i++)
+		{
+			data.append(QByteArray::number(i));
+		}
+		QByteArray compressed;
+		QVERIFY(GZip::zip(data, compressed));
+
+		QBuffer device(&compressed);
+		device.open(QIODevice::ReadOnly);
+		GZipStreamBuf buffer(&device);
+		std::istream input(&buffer);
+		std::string result((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+		QVERIFY(!buffer.hasError());
+		QCOMPARE(QByteArray(result.data(), result.size()), data);
+		QCOMPARE(buffer.inflatedBytes(), qint64(data.size()));
+	}
+
+	void test_StreamBufTruncated()
+	{
+		QByteArray data(100000, 'a');
+		QByteArray compressed;
+		QVERIFY(GZip::zip(data, compressed));
+		compressed.chop(20);
+
+		QBuffer device(&compressed);
+		device.open(QIODevice::ReadOnly);
+		GZipStreamBuf buffer(&device);
+		std::istream input(&buffer);
+		std::string result((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+		QVERIFY(buffer.hasError());
+	}
 };
 
 QTEST_GUILESS_MAIN(GZipTest)
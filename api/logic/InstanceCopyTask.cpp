@@ -1,12 +1,13 @@
 #include "InstanceCopyTask.h"
 #include "BaseInstanceProvider.h"
 #include "settings/INISettingsObject.h"
+#include "settings/SaveScheduler.h"
 #include "FileSystem.h"
 #include "NullInstance.h"
 #include "pathmatcher/RegexpMatcher.h"
 #include <QtConcurrentRun>
 
-InstanceCopyTask::InstanceCopyTask(SettingsObjectPtr settings, BaseInstanceProvider* target, InstancePtr origInstance, const QString& instName, const QString& instIcon, const QString& instGroup, bool copySaves)
+InstanceCopyTask::InstanceCopyTask(SettingsObjectPtr settings, BaseInstanceProvider* target, InstancePtr origInstance, const QString& instName, const QString& instIcon, const QString& instGroup, bool copySaves, bool linkFiles)
 {
 	m_globalSettings = settings;
 	m_target = target;
@@ -22,23 +23,61 @@ InstanceCopyTask::InstanceCopyTask(SettingsObjectPtr settings, BaseInstanceProvi
 		matcherReal->caseSensitive(false);
 		m_matcher.reset(matcherReal);
 	}
+	if(linkFiles)
+	{
+		// these are only ever replaced, never changed in place, so both instances can share them
+		m_linkMatcher.reset(new RegexpMatcher("^([.]?minecraft/(mods|coremods)|jarmods|libraries)/.*[.](jar|zip|litemod)$"));
+	}
 }
 
 void InstanceCopyTask::executeTask()
 {
 	setStatus(tr("Copying instance %1").arg(m_origInstance->name()));
 	m_stagingPath = m_target->getStagedInstancePath();
-	FS::copy folderCopy(m_origInstance->instanceRoot(), m_stagingPath);
-	folderCopy.followSymlinks(false).blacklist(m_matcher.get());
+	SaveScheduler::instance().flush(m_origInstance->instanceRoot());
 
-	m_copyFuture = QtConcurrent::run(QThreadPool::globalInstance(), folderCopy);
+	m_copyFuture = QtConcurrent::run(QThreadPool::globalInstance(), [this]() { return copyFolder(); });
 	connect(&m_copyFutureWatcher, &QFutureWatcher<bool>::finished, this, &InstanceCopyTask::copyFinished);
 	connect(&m_copyFutureWatcher, &QFutureWatcher<bool>::canceled, this, &InstanceCopyTask::copyAborted);
 	m_copyFutureWatcher.setFuture(m_copyFuture);
+
+	connect(&m_copyProgressTimer, &QTimer::timeout, this, &InstanceCopyTask::copyProgressChanged);
+	m_copyProgressTimer.start(100);
+}
+
+// Runs on a worker thread
+bool InstanceCopyTask::copyFolder()
+{
+	FS::FolderCopy folderCopy(m_origInstance->instanceRoot(), m_stagingPath);
+	folderCopy.followSymlinks(false).blacklist(m_matcher.get()).hardLinks(m_linkMatcher.get());
+	if(!folderCopy.scan())
+	{
+		return false;
+	}
+	m_copyTotal.storeRelease(folderCopy.totalBytes());
+	auto progress = [this](qint64 bytes)
+	{
+		m_copiedBytes.fetchAndAddRelaxed(bytes);
+	};
+	bool result = folderCopy.run(progress, &m_copyAborted);
+	qDebug() << "Copied" << folderCopy.fileCount() << "files," << folderCopy.clonedFiles() << "cloned,"
+			 << folderCopy.linkedFiles() << "hard linked";
+	return result;
+}
+
+void InstanceCopyTask::copyProgressChanged()
+{
+	setProgress(m_copiedBytes.load(), qMax<qint64>(1, m_copyTotal.load()));
 }
 
 void InstanceCopyTask::copyFinished()
 {
+	m_copyProgressTimer.stop();
+	if(m_copyAborted.load())
+	{
+		copyAborted();
+		return;
+	}
 	auto successful = m_copyFuture.result();
 	if(!successful)
 	{
@@ -62,7 +101,24 @@ void InstanceCopyTask::copyFinished()
 
 void InstanceCopyTask::copyAborted()
 {
+	m_copyProgressTimer.stop();
 	m_target->destroyStagingPath(m_stagingPath);
-	emitFailed(tr("Instance folder copy has been aborted."));
+	emitAborted();
 	return;
 }
+
+bool InstanceCopyTask::canAbort() const
+{
+	return true;
+}
+
+bool InstanceCopyTask::abort()
+{
+	if(!isRunning())
+	{
+		return false;
+	}
+	// copyFinished cleans up once the workers stop
+	m_copyAborted.storeRelease(1);
+	return true;
+}
@@ -6,6 +6,7 @@
 #include <QUrl>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QTimer>
 #include "settings/SettingsObject.h"
 #include "BaseVersion.h"
 #include "BaseInstance.h"
@@ -18,13 +19,22 @@ class MULTIMC_LOGIC_EXPORT InstanceCopyTask : public Task
 	Q_OBJECT
 public:
 	explicit InstanceCopyTask(SettingsObjectPtr settings, BaseInstanceProvider * target, InstancePtr origInstance, const QString &instName,
-		const QString &instIcon, const QString &instGroup, bool copySaves);
+		const QString &instIcon, const QString &instGroup, bool copySaves, bool linkFiles = false);
+
+	bool canAbort() const override;
+
+public slots:
+	bool abort() override;
 
 protected:
 	//! Entry point for tasks.
 	virtual void executeTask() override;
 	void copyFinished();
 	void copyAborted();
+	void copyProgressChanged();
+
+private:
+	bool copyFolder();
 
 private: /* data */
 	SettingsObjectPtr m_globalSettings;
@@ -37,6 +47,12 @@ private: /* data */
 	QFuture<bool> m_copyFuture;
 	QFutureWatcher<bool> m_copyFutureWatcher;
 	std::unique_ptr<IPathMatcher> m_matcher;
+	std::unique_ptr<IPathMatcher> m_linkMatcher;
+
+	QAtomicInt m_copyAborted;
+	QAtomicInteger<qint64> m_copiedBytes;
+	QAtomicInteger<qint64> m_copyTotal;
+	QTimer m_copyProgressTimer;
 };
 
 
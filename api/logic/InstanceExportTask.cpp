@@ -0,0 +1,273 @@
+#include "InstanceExportTask.h"
+#include "FileSystem.h"
+
+#include <quazip.h>
+#include <quazipfile.h>
+#include <zlib.h>
+
+#include <QtConcurrentRun>
+#include <QDir>
+#include <QFileInfo>
+#include <QThread>
+#include <QDebug>
+
+namespace {
+// files at or below this size are read whole and deflated on the worker pool
+const qint64 parallelSizeLimit = 16 * 1024 * 1024;
+const qint64 copyChunkSize = 1024 * 1024;
+
+// deflating these again costs a lot of time for next to no gain
+const QStringList compressedSuffixes = {
+	"jar", "zip", "litemod", "gz", "xz", "lzma", "7z", "bz2", "pack",
+	"png", "jpg", "jpeg", "gif", "webp",
+	"ogg", "mp3", "flac", "mp4", "webm"
+};
+
+struct DeflatedFile
+{
+	bool ok = false;
+	QByteArray data;
+	quint32 crc = 0;
+	qint64 size = 0;
+};
+
+DeflatedFile deflateFile(const QString &path)
+{
+	DeflatedFile result;
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "Couldn't open" << path << "for export:" << file.errorString();
+		return result;
+	}
+	QByteArray input = file.readAll();
+	result.size = input.size();
+	result.crc = crc32(crc32(0L, Z_NULL, 0), (const Bytef *)input.constData(), input.size());
+
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	// raw deflate stream, the zip headers are written by QuaZip
+	if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		return result;
+	}
+	result.data.resize(deflateBound(&zs, input.size()));
+	zs.next_in = (Bytef *)input.data();
+	zs.avail_in = input.size();
+	zs.next_out = (Bytef *)result.data.data();
+	zs.avail_out = result.data.size();
+	int err = deflate(&zs, Z_FINISH);
+	deflateEnd(&zs);
+	if (err != Z_STREAM_END)
+	{
+		return result;
+	}
+	result.data.resize(zs.total_out);
+	result.ok = true;
+	return result;
+}
+}
+
+struct InstanceExportTask::Entry
+{
+	enum Kind
+	{
+		Directory,
+		Stored,
+		Deflated,
+		DeflatedInPlace
+	} kind;
+	QString path;
+	QString name;
+	qint64 size = 0;
+};
+
+InstanceExportTask::InstanceExportTask(const QString &output, const QString &root, const QString &prefix,
+	const SeparatorPrefixTree<'/'> &blocked)
+	: m_output(output), m_root(root), m_prefix(prefix), m_blocked(blocked)
+{
+	m_compressPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+}
+
+void InstanceExportTask::executeTask()
+{
+	setStatus(tr("Exporting instance to %1").arg(QFileInfo(m_output).fileName()));
+	m_exportFuture = QtConcurrent::run(QThreadPool::globalInstance(), [this]() { return exportZip(); });
+	connect(&m_exportFutureWatcher, &QFutureWatcher<bool>::finished, this, &InstanceExportTask::exportFinished);
+	m_exportFutureWatcher.setFuture(m_exportFuture);
+}
+
+bool InstanceExportTask::abort()
+{
+	m_aborted.storeRelease(1);
+	return true;
+}
+
+void InstanceExportTask::exportFinished()
+{
+	if (m_exportFuture.result())
+	{
+		emitSucceeded();
+		return;
+	}
+	QFile::remove(m_output);
+	if (m_aborted.load())
+	{
+		emitAborted();
+		return;
+	}
+	emitFailed(m_error);
+}
+
+void InstanceExportTask::reportProgress(qint64 current, qint64 total)
+{
+	QMetaObject::invokeMethod(this, "setProgress", Qt::QueuedConnection, Q_ARG(qint64, current), Q_ARG(qint64, total));
+}
+
+void InstanceExportTask::collect(const QString &path, QList<Entry> &entries, qint64 &totalSize) const
+{
+	QDir rootDir(m_root);
+	QDir dir(path);
+	const auto output = QFileInfo(m_output).absoluteFilePath();
+	for (auto &info : dir.entryInfoList(QDir::AllDirs | QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot, QDir::Name))
+	{
+		auto relative = rootDir.relativeFilePath(info.absoluteFilePath());
+		if (m_blocked.covers(relative) || info.absoluteFilePath() == output)
+		{
+			continue;
+		}
+		Entry entry;
+		entry.path = info.absoluteFilePath();
+		entry.name = FS::PathCombine(m_prefix, relative);
+		if (info.isDir())
+		{
+			entry.kind = Entry::Directory;
+			entry.name += '/';
+			entries.append(entry);
+			collect(entry.path, entries, totalSize);
+			continue;
+		}
+		entry.size = info.size();
+		if (compressedSuffixes.contains(info.suffix(), Qt::CaseInsensitive))
+		{
+			entry.kind = Entry::Stored;
+		}
+		else if (entry.size <= parallelSizeLimit)
+		{
+			entry.kind = Entry::Deflated;
+		}
+		else
+		{
+			entry.kind = Entry::DeflatedInPlace;
+		}
+		totalSize += entry.size;
+		entries.append(entry);
+	}
+}
+
+bool InstanceExportTask::exportZip()
+{
+	QList<Entry> entries;
+	qint64 totalSize = 0;
+	collect(m_root, entries, totalSize);
+
+	QuaZip zip(m_output);
+	// anything near the 4 GiB limit of plain zip needs the zip64 extensions
+	zip.setZip64Enabled(totalSize >= 0xF0000000LL);
+	if (!zip.open(QuaZip::mdCreate))
+	{
+		m_error = tr("Couldn't create %1").arg(m_output);
+		return false;
+	}
+
+	// keep a limited number of files in flight on the compression pool
+	const int window = 2 * m_compressPool.maxThreadCount();
+	QVector<QFuture<DeflatedFile>> pending(entries.size());
+	int submitted = 0;
+	qint64 done = 0;
+	bool ok = true;
+
+	for (int i = 0; i < entries.size() && ok; i++)
+	{
+		for (; submitted < entries.size() && submitted < i + window; submitted++)
+		{
+			if (entries[submitted].kind == Entry::Deflated)
+			{
+				pending[submitted] = QtConcurrent::run(&m_compressPool, deflateFile, entries[submitted].path);
+			}
+		}
+		if (m_aborted.load())
+		{
+			ok = false;
+			break;
+		}
+
+		const auto &entry = entries[i];
+		QuaZipFile out(&zip);
+		QuaZipNewInfo info(entry.name, entry.path);
+		info.uncompressedSize = entry.size;
+		switch (entry.kind)
+		{
+			case Entry::Directory:
+			{
+				ok = out.open(QIODevice::WriteOnly, info, nullptr, 0, 0, 0);
+				out.close();
+				break;
+			}
+			case Entry::Deflated:
+			{
+				DeflatedFile deflated = pending[i].result();
+				pending[i] = QFuture<DeflatedFile>();
+				ok = deflated.ok && out.open(QIODevice::WriteOnly, info, nullptr, deflated.crc, Z_DEFLATED, Z_DEFAULT_COMPRESSION, true);
+				if (ok)
+				{
+					ok = out.write(deflated.data) == deflated.data.size();
+					out.closeRaw(deflated.size, deflated.crc);
+				}
+				done += entry.size;
+				break;
+			}
+			case Entry::Stored:
+			case Entry::DeflatedInPlace:
+			{
+				QFile in(entry.path);
+				const bool store = entry.kind == Entry::Stored;
+				ok = in.open(QIODevice::ReadOnly) &&
+					out.open(QIODevice::WriteOnly, info, nullptr, 0, store ? 0 : Z_DEFLATED, store ? 0 : Z_DEFAULT_COMPRESSION);
+				while (ok && !in.atEnd())
+				{
+					if (m_aborted.load())
+					{
+						ok = false;
+						break;
+					}
+					auto chunk = in.read(copyChunkSize);
+					ok = out.write(chunk) == chunk.size();
+					done += chunk.size();
+					reportProgress(done, totalSize);
+				}
+				out.close();
+				break;
+			}
+		}
+		if (ok && out.getZipError() != 0)
+		{
+			ok = false;
+		}
+		if (!ok && m_error.isEmpty())
+		{
+			m_error = tr("Couldn't add %1 to the archive").arg(entry.name);
+		}
+		reportProgress(done, totalSize);
+	}
+
+	// nothing may touch the zip after this point
+	m_compressPool.waitForDone();
+	zip.close();
+	if (ok && zip.getZipError() != 0)
+	{
+		m_error = tr("Couldn't finalize %1").arg(m_output);
+		ok = false;
+	}
+	return ok;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "tasks/Task.h"
+#include "multimc_logic_export.h"
+#include "SeparatorPrefixTree.h"
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QAtomicInt>
+
+/*!
+ * Zips up an instance folder in the background.
+ *
+ * Files are deflated in parallel on a bounded pool and written to the archive in a fixed order.
+ * Files that are already compressed (jars, images, sounds...) are stored as they are.
+ */
+class MULTIMC_LOGIC_EXPORT InstanceExportTask : public Task
+{
+	Q_OBJECT
+public:
+	/*!
+	 * \param output path of the zip file to create
+	 * \param root folder to export
+	 * \param prefix name of the top level folder inside the zip
+	 * \param blocked paths relative to root that are left out of the export
+	 */
+	explicit InstanceExportTask(const QString &output, const QString &root, const QString &prefix,
+		const SeparatorPrefixTree<'/'> &blocked);
+
+	bool canAbort() const override
+	{
+		return true;
+	}
+
+public slots:
+	bool abort() override;
+
+protected:
+	//! Entry point for tasks.
+	virtual void executeTask() override;
+	void exportFinished();
+
+private:
+	struct Entry;
+	bool exportZip();
+	void collect(const QString &path, QList<Entry> &entries, qint64 &totalSize) const;
+	void reportProgress(qint64 current, qint64 total);
+
+private: /* data */
+	QString m_output;
+	QString m_root;
+	QString m_prefix;
+	SeparatorPrefixTree<'/'> m_blocked;
+	QString m_error;
+	QAtomicInt m_aborted;
+	QThreadPool m_compressPool;
+	QFuture<bool> m_exportFuture;
+	QFutureWatcher<bool> m_exportFutureWatcher;
+};
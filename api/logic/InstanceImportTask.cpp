@@ -72,138 +72,287 @@ void InstanceImportTask::downloadProgressChanged(qint64 current, qint64 total)
 	setProgress(current / 2, total);
 }
 
-static QFileInfo findRecursive(const QString &dir, const QString &name)
+static int pathDepth(const QString &entryName)
 {
-	for (const auto info : QDir(dir).entryInfoList(QDir::NoDotAndDotDot | QDir::Dirs | QDir::Files, QDir::DirsLast))
-	{
-		if (info.isFile() && info.fileName() == name)
-		{
-			return info;
-		}
-		else if (info.isDir())
-		{
-			const QFileInfo res = findRecursive(info.absoluteFilePath(), name);
-			if (res.isFile() && res.exists())
-			{
-				return res;
-			}
-		}
-	}
-	return QFileInfo();
+	return entryName.count('/');
 }
 
 void InstanceImportTask::extractAndTweak()
 {
 	setStatus(tr("Extracting modpack"));
 	m_stagingPath = m_target->getStagedInstancePath();
-	QDir extractDir(m_stagingPath);
 	qDebug() << "Attempting to create instance from" << m_archivePath;
 
-	m_extractFuture = QtConcurrent::run(QThreadPool::globalInstance(), MMCZip::extractDir, m_archivePath, extractDir.absolutePath());
-	connect(&m_extractFutureWatcher, &QFutureWatcher<QStringList>::finished, this, &InstanceImportTask::extractFinished);
-	connect(&m_extractFutureWatcher, &QFutureWatcher<QStringList>::canceled, this, &InstanceImportTask::extractAborted);
+	m_extractFuture = QtConcurrent::run(QThreadPool::globalInstance(), [this]() { return extractPack(); });
+	connect(&m_extractFutureWatcher, &QFutureWatcher<bool>::finished, this, &InstanceImportTask::extractFinished);
+	connect(&m_extractFutureWatcher, &QFutureWatcher<bool>::canceled, this, &InstanceImportTask::extractAborted);
 	m_extractFutureWatcher.setFuture(m_extractFuture);
+
+	connect(&m_extractProgressTimer, &QTimer::timeout, this, &InstanceImportTask::extractProgressChanged);
+	m_extractProgressTimer.start(100);
 }
 
-void InstanceImportTask::extractFinished()
+// Runs on a worker thread
+bool InstanceImportTask::extractPack()
 {
-	if (m_extractFuture.result().isEmpty())
+	QuaZip zip(m_archivePath);
+	if (!zip.open(QuaZip::mdUnzip))
 	{
-		m_target->destroyStagingPath(m_stagingPath);
-		emitFailed(tr("Failed to extract modpack"));
-		return;
+		m_extractError = tr("Failed to open modpack archive");
+		return false;
 	}
-	QDir extractDir(m_stagingPath);
+	const auto entries = zip.getFileInfoList64();
+	zip.close();
 
-	qDebug() << "Fixing permissions for extracted pack files...";
-	QDirIterator it(extractDir, QDirIterator::Subdirectories);
-	while (it.hasNext())
+	// the central directory tells us what kind of pack this is before anything is written
+	int configIndex = -1;
+	int manifestIndex = -1;
+	for (int i = 0; i < entries.size(); i++)
 	{
-		auto filepath = it.next();
-		QFileInfo file(filepath);
-		auto permissions = QFile::permissions(filepath);
-		auto origPermissions = permissions;
-		if(file.isDir())
+		const auto &name = entries[i].name;
+		const auto fileName = name.section('/', -1);
+		if (fileName == "instance.cfg" && (configIndex == -1 || pathDepth(name) < pathDepth(entries[configIndex].name)))
 		{
-			// Folder +rwx for current user
-			permissions |= QFileDevice::Permission::ReadUser | QFileDevice::Permission::WriteUser | QFileDevice::Permission::ExeUser;
+			configIndex = i;
 		}
-		else
+		else if (fileName == "manifest.json" && (manifestIndex == -1 || pathDepth(name) < pathDepth(entries[manifestIndex].name)))
+		{
+			manifestIndex = i;
+		}
+	}
+
+	QStringList targets;
+	const auto stagingRoot = QDir::cleanPath(QDir(m_stagingPath).absolutePath());
+	for (auto &entry : entries)
+	{
+		auto target = QDir::cleanPath(FS::PathCombine(stagingRoot, entry.name));
+		if (!target.startsWith(stagingRoot + '/'))
 		{
-			// File +rw for current user
-			permissions |= QFileDevice::Permission::ReadUser | QFileDevice::Permission::WriteUser;
+			qWarning() << "Skipping archive entry outside of the pack:" << entry.name;
+			target.clear();
 		}
-		if(origPermissions != permissions)
+		else if (entry.name.endsWith('/'))
 		{
-			if(!QFile::setPermissions(filepath, permissions))
+			target += '/';
+		}
+		targets.append(target);
+	}
+
+	if (configIndex != -1)
+	{
+		qDebug() << "Pack appears to be exported from MultiMC.";
+		m_packType = PackType::MultiMC;
+		m_packConfig = targets[configIndex];
+	}
+	else if (manifestIndex != -1)
+	{
+		qDebug() << "Pack appears to be from 'Flame'.";
+		m_packType = PackType::Flame;
+
+		// read the manifest first, so the mods can download while the rest extracts
+		QStringList manifestOnly;
+		for (int i = 0; i < entries.size(); i++)
+		{
+			manifestOnly.append(i == manifestIndex ? targets[i] : QString());
+		}
+		if (targets[manifestIndex].isEmpty() || !MMCZip::extractEntries(m_archivePath, entries, manifestOnly, nullptr))
+		{
+			m_extractError = tr("Failed to extract modpack");
+			return false;
+		}
+		try
+		{
+			Flame::loadManifest(m_pack, targets[manifestIndex]);
+		}
+		catch (JSONValidationError & e)
+		{
+			m_extractError = tr("Could not understand pack manifest:\n") + e.cause();
+			return false;
+		}
+		m_packRoot = QFileInfo(targets[manifestIndex]).absolutePath();
+		QMetaObject::invokeMethod(this, "flameManifestLoaded", Qt::QueuedConnection);
+
+		// overrides go straight to where the instance expects them
+		const auto packPrefix = entries[manifestIndex].name.left(entries[manifestIndex].name.lastIndexOf('/') + 1);
+		const auto overridesPrefix = packPrefix + m_pack.overrides + '/';
+		for (int i = 0; i < entries.size(); i++)
+		{
+			if (i == manifestIndex)
 			{
-				qWarning() << "Could not fix" << filepath;
+				targets[i].clear();
 			}
-			else
+			else if (!m_pack.overrides.isEmpty() && !targets[i].isEmpty() && entries[i].name.startsWith(overridesPrefix))
 			{
-				qDebug() << "Fixed" << filepath;
+				auto relative = entries[i].name.mid(overridesPrefix.size());
+				targets[i] = FS::PathCombine(m_packRoot, "minecraft", relative);
+				if (relative.isEmpty() || relative.endsWith('/'))
+				{
+					targets[i] += '/';
+				}
 			}
 		}
 	}
+	else
+	{
+		m_extractError = tr("Archive does not contain a recognized modpack type.");
+		return false;
+	}
 
-	const QFileInfo instanceCfgFile = findRecursive(extractDir.absolutePath(), "instance.cfg");
-	const QFileInfo flameJson = findRecursive(extractDir.absolutePath(), "manifest.json");
-	if (instanceCfgFile.isFile())
+	qint64 total = 0;
+	for (int i = 0; i < entries.size(); i++)
 	{
-		qDebug() << "Pack appears to be exported from MultiMC.";
-		processMultiMC(instanceCfgFile);
+		if (!targets[i].isEmpty())
+		{
+			total += entries[i].uncompressedSize;
+		}
 	}
-	else if (flameJson.isFile())
+	m_extractTotal.storeRelease(total);
+	auto progress = [this](qint64 bytes)
 	{
-		qDebug() << "Pack appears to be from 'Flame'.";
-		processFlame(flameJson);
+		m_extractedBytes.fetchAndAddRelaxed(bytes);
+	};
+	if (!MMCZip::extractEntries(m_archivePath, entries, targets, progress, &m_extractAborted))
+	{
+		m_extractError = tr("Failed to extract modpack");
+		return false;
 	}
-	else
+	return true;
+}
+
+void InstanceImportTask::extractProgressChanged()
+{
+	setProgress(m_extractedBytes.load(), qMax<qint64>(1, m_extractTotal.load()));
+}
+
+void InstanceImportTask::extractFinished()
+{
+	m_extractProgressTimer.stop();
+	m_extractDone = true;
+	if (m_failed)
 	{
-		qCritical() << "Archive does not contain a recognized modpack type.";
+		// something else failed while we were extracting, clean up now that nothing writes there
 		m_target->destroyStagingPath(m_stagingPath);
-		emitFailed(tr("Archive does not contain a recognized modpack type."));
+		emitFailed(m_failReason);
+		return;
+	}
+	if (!m_extractFuture.result())
+	{
+		qCritical() << m_extractError;
+		importFailed(m_extractError);
+		return;
+	}
+	extractProgressChanged();
+
+	switch (m_packType)
+	{
+		case PackType::MultiMC:
+			processMultiMC(QFileInfo(m_packConfig));
+			break;
+		case PackType::Flame:
+			processFlame();
+			break;
+		case PackType::Unknown:
+			importFailed(tr("Archive does not contain a recognized modpack type."));
+			break;
 	}
 }
 
 void InstanceImportTask::extractAborted()
 {
+	m_extractProgressTimer.stop();
 	m_target->destroyStagingPath(m_stagingPath);
 	emitFailed(tr("Instance import has been aborted."));
 	return;
 }
 
-void InstanceImportTask::processFlame(const QFileInfo & manifest)
+void InstanceImportTask::importFailed(const QString &reason)
 {
-	const static QMap<QString,QString> forgemap = {
-		{"1.2.5", "3.4.9.171"},
-		{"1.4.2", "6.0.1.355"},
-		{"1.4.7", "6.6.2.534"},
-		{"1.5.2", "7.8.1.737"}
-	};
-	Flame::Manifest pack;
-	try
+	if (m_failed)
 	{
-		Flame::loadManifest(pack, manifest.absoluteFilePath());
+		return;
 	}
-	catch (JSONValidationError & e)
+	m_failed = true;
+	m_failReason = reason;
+	if (m_modIdResolver)
 	{
-		m_target->destroyStagingPath(m_stagingPath);
-		emitFailed(tr("Could not understand pack manifest:\n") + e.cause());
+		disconnect(m_modIdResolver.get(), nullptr, this, nullptr);
+		m_modIdResolver->abort();
+		m_modIdResolver.reset();
+	}
+	if (m_filesNetJob)
+	{
+		disconnect(m_filesNetJob.get(), nullptr, this, nullptr);
+		m_filesNetJob->abort();
+		m_filesNetJob.reset();
+	}
+	if (!m_extractDone)
+	{
+		// extractFinished cleans up once the workers stop
+		m_extractAborted.storeRelease(1);
 		return;
 	}
-	m_packRoot = manifest.absolutePath();
-	if(!pack.overrides.isEmpty())
+	m_target->destroyStagingPath(m_stagingPath);
+	emitFailed(reason);
+}
+
+void InstanceImportTask::flameManifestLoaded()
+{
+	if (m_failed)
+	{
+		return;
+	}
+	// mods are downloaded as soon as they are resolved, while the overrides are still being extracted
+	auto modsPath = FS::PathCombine(m_packRoot, "minecraft/mods");
+	m_modIdResolver.reset(new Flame::FileResolvingTask(m_pack, modsPath));
+	connect(m_modIdResolver.get(), &Flame::FileResolvingTask::succeeded, this, [&]()
+	{
+		m_modIdResolver.reset();
+		m_modsDone = true;
+		tryCommitFlame();
+	});
+	connect(m_modIdResolver.get(), &Flame::FileResolvingTask::failed, this, [&](QString reason)
 	{
-		QString overridePath = FS::PathCombine(m_packRoot, pack.overrides);
-		QString mcPath = FS::PathCombine(m_packRoot, "minecraft");
-		if (!QFile::rename(overridePath, mcPath))
+		importFailed(tr("Unable to download mods:\n") + reason);
+	});
+	connect(m_modIdResolver.get(), &Flame::FileResolvingTask::progress, this, [&](qint64 current, qint64 total)
+	{
+		// extraction reports its own progress until it is done
+		if(m_extractDone)
 		{
-			m_target->destroyStagingPath(m_stagingPath);
-			emitFailed(tr("Could not rename the overrides folder:\n") + pack.overrides);
-			return;
+			setProgress(current, total);
 		}
+	});
+	if(m_extractDone)
+	{
+		setStatus(tr("Downloading mods..."));
+	}
+	m_modIdResolver->start();
+}
+
+void InstanceImportTask::tryCommitFlame()
+{
+	if (m_failed || !m_extractDone || !m_modsDone)
+	{
+		return;
+	}
+	if (!m_target->commitStagedInstance(m_stagingPath, m_packRoot, m_instName, m_instGroup))
+	{
+		m_target->destroyStagingPath(m_stagingPath);
+		emitFailed(tr("Unable to commit instance"));
+		return;
 	}
+	emitSucceeded();
+}
+
+void InstanceImportTask::processFlame()
+{
+	const static QMap<QString,QString> forgemap = {
+		{"1.2.5", "3.4.9.171"},
+		{"1.4.2", "6.0.1.355"},
+		{"1.4.7", "6.6.2.534"},
+		{"1.5.2", "7.8.1.737"}
+	};
+	const auto &pack = m_pack;
 
 	QString forgeVersion;
 	for(auto &loader: pack.minecraft.modLoaders)
@@ -287,59 +436,14 @@ void InstanceImportTask::processFlame(const QFileInfo & manifest)
 		FS::deletePath(jarmodsPath);
 	}
 	instance.setName(m_instName);
-	m_modIdResolver.reset(new Flame::FileResolvingTask(pack));
-	connect(m_modIdResolver.get(), &Flame::FileResolvingTask::succeeded, [&]()
+	if(m_modsDone)
 	{
-		auto results = m_modIdResolver->getResults();
-		m_filesNetJob.reset(new NetJob(tr("Mod download")));
-		for(auto result: results.files)
-		{
-			auto path = FS::PathCombine(m_packRoot, "minecraft/mods", result.fileName);
-			auto dl = Net::Download::makeFile(result.url,path);
-			m_filesNetJob->addNetAction(dl);
-		}
-		m_modIdResolver.reset();
-		connect(m_filesNetJob.get(), &NetJob::succeeded, this, [&]()
-		{
-			m_filesNetJob.reset();
-			if (!m_target->commitStagedInstance(m_stagingPath, m_packRoot, m_instName, m_instGroup))
-			{
-				m_target->destroyStagingPath(m_stagingPath);
-				emitFailed(tr("Unable to commit instance"));
-				return;
-			}
-			emitSucceeded();
-		}
-		);
-		connect(m_filesNetJob.get(), &NetJob::failed, [&](QString reason)
-		{
-			m_target->destroyStagingPath(m_stagingPath);
-			m_filesNetJob.reset();
-			emitFailed(reason);
-		});
-		connect(m_filesNetJob.get(), &NetJob::progress, [&](qint64 current, qint64 total)
-		{
-			setProgress(current, total);
-		});
-		setStatus(tr("Downloading mods..."));
-		m_filesNetJob->start();
+		tryCommitFlame();
 	}
-	);
-	connect(m_modIdResolver.get(), &Flame::FileResolvingTask::failed, [&](QString reason)
-	{
-		m_target->destroyStagingPath(m_stagingPath);
-		m_modIdResolver.reset();
-		emitFailed(tr("Unable to resolve mod IDs:\n") + reason);
-	});
-	connect(m_modIdResolver.get(), &Flame::FileResolvingTask::progress, [&](qint64 current, qint64 total)
-	{
-		setProgress(current, total);
-	});
-	connect(m_modIdResolver.get(), &Flame::FileResolvingTask::status, [&](QString status)
+	else
 	{
-		setStatus(status);
-	});
-	m_modIdResolver->start();
+		setStatus(tr("Downloading mods..."));
+	}
 }
 
 void InstanceImportTask::processMultiMC(const QFileInfo & config)
@@ -6,8 +6,11 @@
 #include <QUrl>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QAtomicInt>
+#include <QTimer>
 #include "settings/SettingsObject.h"
 #include "QObjectPtr.h"
+#include "minecraft/flame/PackManifest.h"
 
 class BaseInstanceProvider;
 namespace Flame
@@ -28,15 +31,28 @@ protected:
 
 private:
 	void extractAndTweak();
+	bool extractPack();
 	void processMultiMC(const QFileInfo &config);
-	void processFlame(const QFileInfo &manifest);
+	void processFlame();
+	void importFailed(const QString &reason);
+	void tryCommitFlame();
 
 private slots:
 	void downloadSucceeded();
 	void downloadFailed(QString reason);
 	void downloadProgressChanged(qint64 current, qint64 total);
+	void extractProgressChanged();
 	void extractFinished();
 	void extractAborted();
+	void flameManifestLoaded();
+
+private: /* types */
+	enum class PackType
+	{
+		Unknown,
+		MultiMC,
+		Flame
+	};
 
 private: /* data */
 	SettingsObjectPtr m_globalSettings;
@@ -51,6 +67,22 @@ private: /* data */
 	QString m_instIcon;
 	QString m_instGroup;
 	QString m_stagingPath;
-	QFuture<QStringList> m_extractFuture;
-	QFutureWatcher<QStringList> m_extractFutureWatcher;
+	QFuture<bool> m_extractFuture;
+	QFutureWatcher<bool> m_extractFutureWatcher;
+
+	// written by the extraction worker, read once it signals or finishes
+	PackType m_packType = PackType::Unknown;
+	QString m_packConfig;
+	Flame::Manifest m_pack;
+	QString m_extractError;
+
+	QAtomicInt m_extractAborted;
+	QAtomicInteger<qint64> m_extractedBytes;
+	QAtomicInteger<qint64> m_extractTotal;
+	QTimer m_extractProgressTimer;
+
+	bool m_failed = false;
+	QString m_failReason;
+	bool m_extractDone = false;
+	bool m_modsDone = false;
 };
@@ -25,6 +25,7 @@
 #include "BaseInstance.h"
 
 #include "FolderInstanceProvider.h"
+#include "Trace.h"
 
 InstanceList::InstanceList(SettingsObjectPtr globalSettings, const QString &instDir, QObject *parent)
 	: QAbstractListModel(parent), m_instDir(instDir)
@@ -138,12 +139,19 @@ static QMap<InstanceId, InstanceLocator> getIdMapping(const QList<InstancePtr> &
 
 InstanceList::InstListError InstanceList::loadList(bool complete)
 {
+	Trace::Span span("Load instance list", complete ? "complete" : "updated providers");
 	auto existingIds = getIdMapping(m_instances);
 
 	QList<InstancePtr> newList;
 
-	auto processIds = [&](BaseInstanceProvider * provider, QList<InstanceId> ids)
+	auto processIds = [&](BaseInstanceProvider * provider)
 	{
+		QList<InstanceId> ids;
+		{
+			Trace::Span span("Discover instances", provider->metaObject()->className());
+			ids = provider->discoverInstances();
+		}
+		QList<InstanceId> toLoad;
 		for(auto & id: ids)
 		{
 			if(existingIds.contains(id))
@@ -158,26 +166,27 @@ InstanceList::InstListError InstanceList::loadList(bool complete)
 			}
 			else
 			{
-				InstancePtr instPtr = provider->loadInstance(id);
-				if(instPtr)
-				{
-					newList.append(instPtr);
-				}
+				toLoad.append(id);
 			}
 		}
+		if(!toLoad.isEmpty())
+		{
+			Trace::Span span("Load instances", provider->metaObject()->className());
+			newList.append(provider->loadInstances(toLoad));
+		}
 	};
 	if(complete)
 	{
 		for(auto & item: m_providers)
 		{
-			processIds(item.get(), item->discoverInstances());
+			processIds(item.get());
 		}
 	}
 	else
 	{
 		for (auto & item: m_updatedProviders)
 		{
-			processIds(item, item->discoverInstances());
+			processIds(item);
 		}
 	}
 
@@ -235,6 +244,7 @@ InstanceList::InstListError InstanceList::loadList(bool complete)
 	}
 	if(newList.size())
 	{
+		Trace::Span span("Add instances");
 		add(newList);
 	}
 	m_updatedProviders.clear();
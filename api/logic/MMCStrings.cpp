@@ -74,3 +74,120 @@ int Strings::naturalCompare(const QString &s1, const QString &s2, Qt::CaseSensit
 	// The two strings are the same (02 == 2) so fall back to the normal sort
 	return QString::compare(s1, s2, cs);
 }
+
+#include <QCollator>
+#include <QMutex>
+
+// numbers are zero padded to this many digits, so the collation sees them ordered by value
+static const int naturalDigits = 20;
+
+// building a collator is expensive, one per case sensitivity is shared by everything
+static QMutex collatorLock;
+static QCollatorSortKey collationKey(const QString &string, Qt::CaseSensitivity cs)
+{
+	static QCollator collators[2];
+	QMutexLocker locker(&collatorLock);
+	auto &collator = collators[cs == Qt::CaseSensitive ? 1 : 0];
+	// follow changes of the application language
+	if (collator.locale() != QLocale() || collator.caseSensitivity() != cs)
+	{
+		collator = QCollator(QLocale());
+		collator.setCaseSensitivity(cs);
+	}
+	return collator.sortKey(string);
+}
+
+// what naturalCompare looks at: no whitespace, and digit runs without leading zeros
+static QString naturalForm(const QString &s)
+{
+	QString out;
+	out.reserve(s.size() + naturalDigits);
+	int i = 0;
+	while (i < s.size())
+	{
+		QChar c = s.at(i);
+		if (c.isSpace())
+		{
+			i++;
+			continue;
+		}
+		if (!c.isDigit())
+		{
+			out.append(c);
+			i++;
+			continue;
+		}
+		QString digits;
+		for (; i < s.size() && s.at(i).isDigit(); i++)
+		{
+			int value = s.at(i).digitValue();
+			if (value == 0 && digits.isEmpty())
+			{
+				continue;
+			}
+			digits.append(QChar('0' + value));
+		}
+		if (digits.size() < naturalDigits)
+		{
+			out.append(QString(naturalDigits - digits.size(), '0'));
+		}
+		out.append(digits);
+	}
+	return out;
+}
+
+Strings::SortKey::SortKey() : SortKey(collationKey(QString(), Qt::CaseSensitive), QString(), Qt::CaseSensitive)
+{
+}
+
+Strings::SortKey::SortKey(const QCollatorSortKey &key, const QString &string, Qt::CaseSensitivity cs)
+	: m_key(key), m_string(string), m_cs(cs)
+{
+}
+
+int Strings::SortKey::compare(const Strings::SortKey &other) const
+{
+	int result = m_key.compare(other.m_key);
+	if (result != 0)
+	{
+		return result < 0 ? -1 : 1;
+	}
+	result = QString::compare(m_string, other.m_string, m_cs);
+	return result < 0 ? -1 : (result > 0 ? 1 : 0);
+}
+
+Strings::SortKey Strings::naturalSortKey(const QString &string, Qt::CaseSensitivity cs)
+{
+	return SortKey(collationKey(naturalForm(string), cs), string, cs);
+}
+
+Strings::SortKey Strings::localeSortKey(const QString &string)
+{
+	return SortKey(collationKey(string, Qt::CaseSensitive), string, Qt::CaseSensitive);
+}
+
+Strings::SortKeyCache::SortKeyCache(KeyFunction function, int maxSize)
+	: m_function(function), m_maxSize(maxSize)
+{
+}
+
+Strings::SortKey Strings::SortKeyCache::key(const QString &string)
+{
+	// keys of two collations do not order consistently against each other
+	if (m_locale != QLocale() || m_keys.size() >= m_maxSize)
+	{
+		m_keys.clear();
+		m_locale = QLocale();
+	}
+	auto iter = m_keys.find(string);
+	if (iter == m_keys.end())
+	{
+		iter = m_keys.insert(string, m_function(string));
+	}
+	return *iter;
+}
+
+void Strings::SortKeyCache::clear()
+{
+	m_keys.clear();
+}
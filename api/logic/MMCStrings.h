@@ -1,10 +1,69 @@
 #pragma once
 
 #include <QString>
+#include <QHash>
+#include <QLocale>
+#include <QCollatorSortKey>
 
 #include "multimc_logic_export.h"
 
 namespace Strings
 {
 	int MULTIMC_LOGIC_EXPORT naturalCompare(const QString &s1, const QString &s2, Qt::CaseSensitivity cs);
+
+	/**
+	 * The collation key of a string, computed once.
+	 *
+	 * Comparing two keys orders the strings without asking the locale again, which is what makes
+	 * sorting many strings cheap. Keep the keys around instead of recomputing them per comparison.
+	 */
+	class MULTIMC_LOGIC_EXPORT SortKey
+	{
+	public:
+		SortKey();
+		int compare(const SortKey &other) const;
+		bool operator<(const SortKey &other) const
+		{
+			return compare(other) < 0;
+		}
+
+	private:
+		SortKey(const QCollatorSortKey &key, const QString &string, Qt::CaseSensitivity cs);
+		friend SortKey naturalSortKey(const QString &string, Qt::CaseSensitivity cs);
+		friend SortKey localeSortKey(const QString &string);
+
+		QCollatorSortKey m_key;
+		// strings the collation considers equal are ordered by this, like naturalCompare does
+		QString m_string;
+		Qt::CaseSensitivity m_cs;
+	};
+
+	/// Key that orders like naturalCompare: whitespace is ignored and numbers are compared by value.
+	MULTIMC_LOGIC_EXPORT SortKey naturalSortKey(const QString &string, Qt::CaseSensitivity cs);
+
+	/// Key that orders like QString::localeAwareCompare.
+	MULTIMC_LOGIC_EXPORT SortKey localeSortKey(const QString &string);
+
+	/**
+	 * Sort keys of strings that are compared over and over, like the names in a sorted model.
+	 *
+	 * Keys made for another application language are dropped, so all keys handed out at a time
+	 * come from the same collation. Once more than maxSize strings are cached, the cache starts over.
+	 */
+	class MULTIMC_LOGIC_EXPORT SortKeyCache
+	{
+	public:
+		typedef SortKey (*KeyFunction)(const QString &string);
+		explicit SortKeyCache(KeyFunction function, int maxSize = 4096);
+
+		/// The key is shared, copying it is cheap
+		SortKey key(const QString &string);
+		void clear();
+
+	private:
+		KeyFunction m_function;
+		int m_maxSize;
+		QLocale m_locale;
+		QHash<QString, SortKey> m_keys;
+	};
 }
@@ -0,0 +1,163 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "MMCStrings.h"
+
+#include <algorithm>
+
+class MMCStringsTest : public QObject
+{
+	Q_OBJECT
+private:
+	// what a big instance list looks like
+	QStringList makeNames(int count)
+	{
+		QStringList names;
+		const char *packs[] = {"FTB Infinity", "SkyFactory", "All the Mods", "Vanilla", "RLCraft", "Sevtech Ages"};
+		for (int i = 0; i < count; i++)
+		{
+			names.append(QString("%1 %2 (copy %3)").arg(packs[(i * 7) % 6]).arg((i * 37) % 113).arg(i % 5));
+		}
+		return names;
+	}
+	QStringList sortedByKeys(const QStringList &names)
+	{
+		std::vector<std::pair<Strings::SortKey, QString>> keyed;
+		for (auto &name : names)
+		{
+			keyed.emplace_back(Strings::naturalSortKey(name, Qt::CaseInsensitive), name);
+		}
+		std::sort(keyed.begin(), keyed.end(), [](const std::pair<Strings::SortKey, QString> &a, const std::pair<Strings::SortKey, QString> &b)
+		{
+			return a.first < b.first;
+		});
+		QStringList out;
+		for (auto &item : keyed)
+		{
+			out.append(item.second);
+		}
+		return out;
+	}
+
+private
+slots:
+	void test_NaturalKey_data()
+	{
+		QTest::addColumn<QString>("left");
+		QTest::addColumn<QString>("right");
+		QTest::addColumn<int>("result");
+
+		QTest::newRow("numbers by value") << "Instance 2" << "Instance 10" << -1;
+		QTest::newRow("numbers by value, reverse") << "mod10.jar" << "mod9.jar" << 1;
+		QTest::newRow("case insensitive") << "abc" << "ABD" << -1;
+		QTest::newRow("whitespace ignored") << "a b" << "ab1" << -1;
+		QTest::newRow("leading zeros, tie broken like naturalCompare") << "007" << "7" << -1;
+		QTest::newRow("equal") << "Same Name" << "Same Name" << 0;
+		QTest::newRow("huge numbers") << "v1234567890123" << "v999" << 1;
+	}
+	void test_NaturalKey()
+	{
+		QFETCH(QString, left);
+		QFETCH(QString, right);
+		QFETCH(int, result);
+		QCOMPARE(Strings::naturalSortKey(left, Qt::CaseInsensitive).compare(Strings::naturalSortKey(right, Qt::CaseInsensitive)), result);
+		QCOMPARE(Strings::naturalSortKey(right, Qt::CaseInsensitive).compare(Strings::naturalSortKey(left, Qt::CaseInsensitive)), -result);
+	}
+
+	void test_SameOrderAsNaturalCompare()
+	{
+		auto names = makeNames(200);
+		auto expected = names;
+		std::sort(expected.begin(), expected.end(), [](const QString &a, const QString &b)
+		{
+			return Strings::naturalCompare(a, b, Qt::CaseInsensitive) < 0;
+		});
+		QCOMPARE(sortedByKeys(names), expected);
+	}
+
+	void test_LocaleKey()
+	{
+		QStringList names = {"beta", "Alpha", "alpha", "Gamma", "delta"};
+		for (auto &a : names)
+		{
+			for (auto &b : names)
+			{
+				int expected = QString::localeAwareCompare(a, b);
+				int actual = Strings::localeSortKey(a).compare(Strings::localeSortKey(b));
+				if (expected != 0)
+				{
+					QCOMPARE(actual < 0, expected < 0);
+				}
+			}
+		}
+	}
+
+	void test_SortKeyCache()
+	{
+		Strings::SortKeyCache cache(&Strings::localeSortKey, 2);
+		auto beta = cache.key("beta");
+		auto alpha = cache.key("alpha");
+		// over the limit the cache starts over, keys that were handed out stay usable
+		auto gamma = cache.key("gamma");
+		QVERIFY(alpha < beta);
+		QVERIFY(beta < gamma);
+		QCOMPARE(cache.key("alpha").compare(alpha), 0);
+	}
+
+	void test_NaturalCompareSort_benchmark()
+	{
+		auto names = makeNames(1000);
+		QBENCHMARK
+		{
+			auto sorted = names;
+			std::sort(sorted.begin(), sorted.end(), [](const QString &a, const QString &b)
+			{
+				return Strings::naturalCompare(a, b, Qt::CaseInsensitive) < 0;
+			});
+		}
+	}
+
+	void test_NaturalKeySort_benchmark()
+	{
+		// includes computing the keys, once per name
+		auto names = makeNames(1000);
+		QBENCHMARK
+		{
+			sortedByKeys(names);
+		}
+	}
+
+	void test_LocaleAwareSort_benchmark()
+	{
+		auto names = makeNames(1000);
+		QBENCHMARK
+		{
+			auto sorted = names;
+			std::sort(sorted.begin(), sorted.end(), [](const QString &a, const QString &b)
+			{
+				return QString::localeAwareCompare(a, b) < 0;
+			});
+		}
+	}
+
+	void test_LocaleKeySort_benchmark()
+	{
+		auto names = makeNames(1000);
+		QBENCHMARK
+		{
+			std::vector<std::pair<Strings::SortKey, QString>> keyed;
+			for (auto &name : names)
+			{
+				keyed.emplace_back(Strings::localeSortKey(name), name);
+			}
+			std::sort(keyed.begin(), keyed.end(), [](const std::pair<Strings::SortKey, QString> &a, const std::pair<Strings::SortKey, QString> &b)
+			{
+				return a.first < b.first;
+			});
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(MMCStringsTest)
+
+#include "MMCStrings_test.moc"
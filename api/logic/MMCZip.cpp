@@ -20,6 +20,8 @@
 #include "MMCZip.h"
 #include "FileSystem.h"
 
+#include <QtConcurrentMap>
+#include <QThread>
 #include <QDebug>
 
 // ours
@@ -249,3 +251,138 @@ QStringList MMCZip::extractDir(QString fileCompressed, QString dir)
 	}
 	return MMCZip::extractSubDir(&zip, "", dir);
 }
+
+// ours
+static bool extractCurrentEntry(QuaZip &zip, const QuaZipFileInfo64 &info, const QString &target,
+								std::function<void(qint64)> &progress, const QAtomicInt *aborted)
+{
+	if (info.name.endsWith('/'))
+	{
+		if (!QDir().mkpath(target))
+		{
+			return false;
+		}
+		auto permissions = QFile::permissions(target) | QFileDevice::ReadUser | QFileDevice::WriteUser | QFileDevice::ExeUser;
+		QFile::setPermissions(target, permissions);
+		return true;
+	}
+	if (!FS::ensureFilePathExists(target))
+	{
+		qCritical() << "Couldn't create folder for" << target;
+		return false;
+	}
+	QuaZipFile in(&zip);
+	if (!in.open(QIODevice::ReadOnly))
+	{
+		qCritical() << "Couldn't open" << info.name << "in" << zip.getZipName();
+		return false;
+	}
+	QFile out(target);
+	if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qCritical() << "Couldn't open" << target << "for writing:" << out.errorString();
+		return false;
+	}
+	// archives made on Windows have no unix permissions, those files keep the defaults
+	auto permissions = info.getPermissions();
+	if (permissions)
+	{
+		out.setPermissions(permissions | QFileDevice::ReadUser | QFileDevice::WriteUser);
+	}
+	char buffer[64 * 1024];
+	qint64 read;
+	while ((read = in.read(buffer, sizeof(buffer))) > 0)
+	{
+		if (out.write(buffer, read) != read)
+		{
+			qCritical() << "Couldn't write" << target << ":" << out.errorString();
+			return false;
+		}
+		if (progress)
+		{
+			progress(read);
+		}
+		if (aborted && aborted->load())
+		{
+			return false;
+		}
+	}
+	// closing checks the CRC
+	in.close();
+	if (read < 0 || in.getZipError() != UNZ_OK)
+	{
+		qCritical() << "Couldn't extract" << info.name << "from" << zip.getZipName();
+		return false;
+	}
+	return true;
+}
+
+// ours
+bool MMCZip::extractEntries(const QString &fileCompressed, const QList<QuaZipFileInfo64> &entries,
+							const QStringList &targets, std::function<void(qint64)> progress,
+							const QAtomicInt *aborted)
+{
+	if (entries.size() != targets.size())
+	{
+		return false;
+	}
+
+	// split the archive into contiguous slices of similar size, one per worker
+	qint64 totalSize = 0;
+	for (int i = 0; i < entries.size(); i++)
+	{
+		if (!targets[i].isEmpty())
+		{
+			totalSize += entries[i].uncompressedSize;
+		}
+	}
+	const int workers = qMax(1, QThread::idealThreadCount());
+	const qint64 sliceSize = qMax<qint64>(1, totalSize / workers);
+	QList<QPair<int, int>> slices;
+	int sliceStart = 0;
+	qint64 currentSize = 0;
+	for (int i = 0; i < entries.size(); i++)
+	{
+		if (!targets[i].isEmpty())
+		{
+			currentSize += entries[i].uncompressedSize;
+		}
+		if (currentSize >= sliceSize || i == entries.size() - 1)
+		{
+			slices.append(qMakePair(sliceStart, i + 1));
+			sliceStart = i + 1;
+			currentSize = 0;
+		}
+	}
+
+	QAtomicInt failed;
+	auto extractSlice = [&](const QPair<int, int> &slice)
+	{
+		QuaZip zip(fileCompressed);
+		if (!zip.open(QuaZip::mdUnzip) || !zip.goToFirstFile())
+		{
+			failed.storeRelease(1);
+			return;
+		}
+		// walking the central directory is cheap, no data is read here
+		for (int i = 0; i < slice.first; i++)
+		{
+			zip.goToNextFile();
+		}
+		for (int i = slice.first; i < slice.second; i++)
+		{
+			if (failed.load() || (aborted && aborted->load()))
+			{
+				return;
+			}
+			if (!targets[i].isEmpty() && !extractCurrentEntry(zip, entries[i], targets[i], progress, aborted))
+			{
+				failed.storeRelease(1);
+				return;
+			}
+			zip.goToNextFile();
+		}
+	};
+	QtConcurrent::blockingMap(slices, extractSlice);
+	return !failed.load() && !(aborted && aborted->load());
+}
@@ -20,6 +20,8 @@
 #include <QSet>
 #include "minecraft/Mod.h"
 #include <functional>
+#include <QAtomicInt>
+#include <quazip.h>
 
 #include "multimc_logic_export.h"
 
@@ -68,4 +70,21 @@ namespace MMCZip
 	 */
 	QStringList MULTIMC_LOGIC_EXPORT extractDir(QString fileCompressed, QString dir);
 
+	/**
+	 * Extract entries of an archive in parallel, each worker reading its own slice of the archive.
+	 *
+	 * Files keep the permissions stored in the archive, but are always readable and writable by
+	 * the current user. Directories are always accessible by the current user.
+	 *
+	 * \param fileCompressed The name of the archive.
+	 * \param entries The archive's central directory, as returned by QuaZip::getFileInfoList64.
+	 * \param targets One absolute target path per entry. Entries with an empty target are skipped.
+	 * \param progress Called from the worker threads with the number of bytes just written.
+	 * \param aborted Extraction stops early when this becomes non-zero.
+	 * \return true if all wanted entries were extracted.
+	 */
+	bool MULTIMC_LOGIC_EXPORT extractEntries(const QString &fileCompressed, const QList<QuaZipFileInfo64> &entries,
+											 const QStringList &targets, std::function<void(qint64)> progress,
+											 const QAtomicInt *aborted = nullptr);
+
 }
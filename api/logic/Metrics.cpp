@@ -0,0 +1,173 @@
+#include "Metrics.h"
+
+#include "Trace.h"
+#include "Json.h"
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+
+namespace
+{
+QAtomicInt enabled(0);
+QAtomicInteger<quint64> lastId(0);
+QMutex lock;
+QVector<Metrics::DownloadRecord> downloads;
+QHash<quint64, int> downloadIndex;
+QVector<Metrics::TaskRecord> tasks;
+
+QString resultName(Metrics::Result result)
+{
+	switch (result)
+	{
+		case Metrics::Result::Succeeded:
+			return "succeeded";
+		case Metrics::Result::Failed:
+			return "failed";
+		case Metrics::Result::Aborted:
+			return "aborted";
+	}
+	return QString();
+}
+
+double ms(qint64 us)
+{
+	return us / 1000.0;
+}
+}
+
+void Metrics::enable()
+{
+	Trace::startClock();
+	enabled.store(1);
+}
+
+bool Metrics::isEnabled()
+{
+	return enabled.load() != 0;
+}
+
+void Metrics::clear()
+{
+	QMutexLocker locker(&lock);
+	downloads.clear();
+	downloadIndex.clear();
+	tasks.clear();
+}
+
+qint64 Metrics::now()
+{
+	if (!isEnabled())
+	{
+		return -1;
+	}
+	return Trace::now();
+}
+
+quint64 Metrics::nextId()
+{
+	return ++lastId;
+}
+
+void Metrics::record(const DownloadRecord &download)
+{
+	if (!isEnabled())
+	{
+		return;
+	}
+	QMutexLocker locker(&lock);
+	auto iter = downloadIndex.find(download.id);
+	if (iter != downloadIndex.end())
+	{
+		downloads[*iter] = download;
+		return;
+	}
+	downloadIndex.insert(download.id, downloads.size());
+	downloads.append(download);
+}
+
+void Metrics::record(const TaskRecord &task)
+{
+	if (!isEnabled())
+	{
+		return;
+	}
+	QMutexLocker locker(&lock);
+	tasks.append(task);
+}
+
+QByteArray Metrics::serialize()
+{
+	QVector<DownloadRecord> downloadsCopy;
+	QVector<TaskRecord> tasksCopy;
+	{
+		QMutexLocker locker(&lock);
+		downloadsCopy = downloads;
+		tasksCopy = tasks;
+	}
+
+	int cacheHits = 0;
+	int failures = 0;
+	int retries = 0;
+	qint64 bytes = 0;
+	QJsonArray downloadsOut;
+	for (auto &download : downloadsCopy)
+	{
+		QJsonObject obj;
+		obj.insert("url", download.url);
+		obj.insert("result", resultName(download.result));
+		obj.insert("cache_hit", download.cacheHit);
+		obj.insert("bytes", double(download.bytes));
+		obj.insert("start_ms", ms(download.start));
+		obj.insert("duration_ms", ms(download.duration));
+		if (download.timeToFirstByte >= 0)
+		{
+			obj.insert("ttfb_ms", ms(download.timeToFirstByte));
+		}
+		obj.insert("sink_ms", ms(download.sinkTime));
+		obj.insert("retries", download.retries);
+		obj.insert("redirects", download.redirects);
+		if (download.httpStatus)
+		{
+			obj.insert("http_status", download.httpStatus);
+		}
+		downloadsOut.append(obj);
+
+		cacheHits += download.cacheHit ? 1 : 0;
+		failures += download.result == Result::Succeeded ? 0 : 1;
+		retries += download.retries;
+		bytes += download.bytes;
+	}
+
+	QJsonArray tasksOut;
+	for (auto &task : tasksCopy)
+	{
+		QJsonObject obj;
+		obj.insert("name", task.name);
+		obj.insert("type", task.type);
+		obj.insert("result", resultName(task.result));
+		obj.insert("start_ms", ms(task.start));
+		obj.insert("duration_ms", ms(task.duration));
+		tasksOut.append(obj);
+	}
+
+	QJsonObject totals;
+	totals.insert("downloads", downloadsCopy.size());
+	totals.insert("cache_hits", cacheHits);
+	totals.insert("failed", failures);
+	totals.insert("retries", retries);
+	totals.insert("bytes", double(bytes));
+	totals.insert("tasks", tasksCopy.size());
+
+	QJsonObject root;
+	root.insert("totals", totals);
+	root.insert("downloads", downloadsOut);
+	root.insert("tasks", tasksOut);
+	return Json::toText(root);
+}
+
+bool Metrics::save(const QString &path)
+{
+	return Trace::writeFile(path, serialize());
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+
+#include "multimc_logic_export.h"
+
+/**
+ * Numbers about what the network and tasks did during a session.
+ *
+ * Downloads and tasks report themselves when they finish, so what is collected can be written
+ * out at any point as a JSON document. Times are taken from the Trace clock, a download can be
+ * placed among the startup spans of the same run.
+ */
+namespace Metrics
+{
+enum class Result
+{
+	Succeeded,
+	Failed,
+	Aborted
+};
+
+struct DownloadRecord
+{
+	/// unique per download, a download that is retried updates its record
+	quint64 id = 0;
+	QString url;
+	/// bytes received over the network by the last attempt, 0 for cache hits
+	qint64 bytes = 0;
+	/// when the first attempt started, on the Trace clock
+	qint64 start = -1;
+	/// from sending the request to the first response byte of the last attempt, -1 if none came
+	qint64 timeToFirstByte = -1;
+	/// from the first attempt starting to the last one ending
+	qint64 duration = 0;
+	/// time the last attempt spent in the sinks: writing to disk and checking checksums
+	qint64 sinkTime = 0;
+	int retries = 0;
+	int redirects = 0;
+	int httpStatus = 0;
+	bool cacheHit = false;
+	Result result = Result::Succeeded;
+};
+
+struct TaskRecord
+{
+	QString name;
+	QString type;
+	/// on the Trace clock
+	qint64 start = -1;
+	qint64 duration = 0;
+	Result result = Result::Succeeded;
+};
+
+/// Downloads and tasks only report anything after this
+MULTIMC_LOGIC_EXPORT void enable();
+MULTIMC_LOGIC_EXPORT bool isEnabled();
+
+/// Drop the records, for tests
+MULTIMC_LOGIC_EXPORT void clear();
+
+/// Trace::now(), or -1 while metrics are off so nothing that started then gets recorded
+MULTIMC_LOGIC_EXPORT qint64 now();
+
+/// A new id for a DownloadRecord
+MULTIMC_LOGIC_EXPORT quint64 nextId();
+
+MULTIMC_LOGIC_EXPORT void record(const DownloadRecord &download);
+MULTIMC_LOGIC_EXPORT void record(const TaskRecord &task);
+
+/// The records and totals over them
+MULTIMC_LOGIC_EXPORT QByteArray serialize();
+MULTIMC_LOGIC_EXPORT bool save(const QString &path);
+}
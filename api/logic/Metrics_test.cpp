@@ -0,0 +1,178 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "Metrics.h"
+#include "Trace.h"
+#include "Json.h"
+#include "FileSystem.h"
+#include "net/NetJob.h"
+#include "net/Download.h"
+
+class SleepTask : public Task
+{
+	Q_OBJECT
+protected:
+	void executeTask() override
+	{
+		QTest::qSleep(5);
+		emitSucceeded();
+	}
+};
+
+class MetricsTest : public QObject
+{
+	Q_OBJECT
+private:
+	QJsonObject serialized()
+	{
+		return Json::requireObject(Json::requireDocument(Metrics::serialize()));
+	}
+
+private
+slots:
+	void cleanupTestCase()
+	{
+		QFile::remove("metrics_download.txt");
+	}
+
+	void test_Disabled()
+	{
+		Metrics::DownloadRecord download;
+		download.id = Metrics::nextId();
+		Metrics::record(download);
+		SleepTask task;
+		task.start();
+		auto obj = serialized();
+		QCOMPARE(Json::requireArray(obj, "downloads").size(), 0);
+		QCOMPARE(Json::requireArray(obj, "tasks").size(), 0);
+		QCOMPARE(Metrics::now(), qint64(-1));
+	}
+
+	void test_RetryUpdatesRecord()
+	{
+		Metrics::enable();
+		Metrics::clear();
+		Metrics::DownloadRecord download;
+		download.id = Metrics::nextId();
+		download.url = "https://example.com/a.jar";
+		download.result = Metrics::Result::Failed;
+		Metrics::record(download);
+		download.retries = 1;
+		download.bytes = 100;
+		download.result = Metrics::Result::Succeeded;
+		Metrics::record(download);
+
+		Metrics::DownloadRecord cached;
+		cached.id = Metrics::nextId();
+		cached.cacheHit = true;
+		Metrics::record(cached);
+
+		auto obj = serialized();
+		auto downloads = Json::requireArray(obj, "downloads");
+		QCOMPARE(downloads.size(), 2);
+		auto first = downloads[0].toObject();
+		QCOMPARE(first["url"].toString(), QString("https://example.com/a.jar"));
+		QCOMPARE(first["result"].toString(), QString("succeeded"));
+		QCOMPARE(first["retries"].toInt(), 1);
+		QVERIFY(!first.contains("ttfb_ms"));
+		auto totals = Json::requireObject(obj, "totals");
+		QCOMPARE(totals["downloads"].toInt(), 2);
+		QCOMPARE(totals["cache_hits"].toInt(), 1);
+		QCOMPARE(totals["retries"].toInt(), 1);
+		QCOMPARE(totals["bytes"].toInt(), 100);
+		QCOMPARE(totals["failed"].toInt(), 0);
+	}
+
+	void test_Task()
+	{
+		Metrics::enable();
+		Metrics::clear();
+		SleepTask task;
+		task.setObjectName("sleeper");
+		task.start();
+		auto tasks = Json::requireArray(serialized(), "tasks");
+		QCOMPARE(tasks.size(), 1);
+		auto obj = tasks[0].toObject();
+		QCOMPARE(obj["name"].toString(), QString("sleeper"));
+		QCOMPARE(obj["type"].toString(), QString("SleepTask"));
+		QCOMPARE(obj["result"].toString(), QString("succeeded"));
+		QVERIFY(obj["duration_ms"].toDouble() >= 5.0);
+	}
+
+	void test_SharedClock()
+	{
+		Trace::enable();
+		Trace::clear();
+		Metrics::enable();
+		Metrics::clear();
+		{
+			Trace::Span span("Outer");
+			SleepTask task;
+			task.start();
+		}
+		auto trace = Json::requireObject(Json::requireDocument(Trace::serialize(Trace::Format::Json)));
+		auto span = Json::requireArray(trace, "spans")[0].toObject();
+		auto task = Json::requireArray(serialized(), "tasks")[0].toObject();
+		// the task happened inside the span
+		QVERIFY(task["start_ms"].toDouble() >= span["start_ms"].toDouble());
+		QVERIFY(task["start_ms"].toDouble() + task["duration_ms"].toDouble()
+				<= span["start_ms"].toDouble() + span["duration_ms"].toDouble());
+	}
+
+	void test_Download()
+	{
+		Metrics::enable();
+		Metrics::clear();
+		QByteArray contents(4096, 'x');
+		FS::write("metrics_download.txt", contents);
+		QByteArray output;
+		auto url = QUrl::fromLocalFile(QFileInfo("metrics_download.txt").absoluteFilePath());
+		NetJobPtr job(new NetJob("Metrics test"));
+		job->addNetAction(Net::Download::makeByteArray(url, &output));
+		job->start();
+		QTRY_VERIFY_WITH_TIMEOUT(job->isFinished(), 10000);
+		QVERIFY(job->wasSuccessful());
+		QCOMPARE(output, contents);
+
+		auto obj = serialized();
+		auto downloads = Json::requireArray(obj, "downloads");
+		QCOMPARE(downloads.size(), 1);
+		auto download = downloads[0].toObject();
+		QCOMPARE(download["url"].toString(), url.toString());
+		QCOMPARE(download["bytes"].toInt(), contents.size());
+		QCOMPARE(download["cache_hit"].toBool(), false);
+		QCOMPARE(download["retries"].toInt(), 0);
+		QVERIFY(download.contains("ttfb_ms"));
+		QVERIFY(download["duration_ms"].toDouble() >= download["ttfb_ms"].toDouble());
+
+		// the job is a task too
+		auto tasks = Json::requireArray(obj, "tasks");
+		QCOMPARE(tasks.size(), 1);
+		QCOMPARE(tasks[0].toObject()["type"].toString(), QString("NetJob"));
+	}
+
+	void test_Unreachable()
+	{
+		Metrics::enable();
+		Metrics::clear();
+		QByteArray output;
+		auto url = QUrl::fromLocalFile(QFileInfo("metrics_missing.txt").absoluteFilePath());
+		NetJobPtr job(new NetJob("Metrics test"));
+		job->addNetAction(Net::Download::makeByteArray(url, &output));
+		job->start();
+		QTRY_VERIFY_WITH_TIMEOUT(job->isFinished(), 10000);
+		QVERIFY(!job->wasSuccessful());
+
+		auto downloads = Json::requireArray(serialized(), "downloads");
+		QCOMPARE(downloads.size(), 1);
+		auto download = downloads[0].toObject();
+		QCOMPARE(download["result"].toString(), QString("failed"));
+		QCOMPARE(download["bytes"].toInt(), 0);
+		// nothing answered, so there was no first byte
+		QVERIFY(!download.contains("ttfb_ms"));
+	}
+};
+
+QTEST_GUILESS_MAIN(MetricsTest)
+
+#include "Metrics_test.moc"
@@ -0,0 +1,162 @@
+#include "StringIndex.h"
+
+#include <QSet>
+#include <algorithm>
+
+static const int trigramLength = 3;
+
+static QSet<QString> trigramsOf(const QString &value)
+{
+	QSet<QString> out;
+	for (int i = 0; i + trigramLength <= value.size(); i++)
+	{
+		out.insert(value.mid(i, trigramLength));
+	}
+	return out;
+}
+
+static void insertSorted(QVector<int> &rows, int row)
+{
+	auto it = std::lower_bound(rows.begin(), rows.end(), row);
+	if (it == rows.end() || *it != row)
+	{
+		rows.insert(it, row);
+	}
+}
+
+static void removeSorted(QHash<QString, QVector<int>> &lists, const QString &key, int row)
+{
+	auto iter = lists.find(key);
+	if (iter == lists.end())
+	{
+		return;
+	}
+	auto &rows = iter.value();
+	auto it = std::lower_bound(rows.begin(), rows.end(), row);
+	if (it != rows.end() && *it == row)
+	{
+		rows.erase(it);
+	}
+	if (rows.isEmpty())
+	{
+		lists.erase(iter);
+	}
+}
+
+void StringIndex::reset(const QVector<QString> &values)
+{
+	clear();
+	m_values = values;
+	for (int i = 0; i < m_values.size(); i++)
+	{
+		add(i);
+	}
+}
+
+void StringIndex::setValue(int row, const QString &value)
+{
+	if (row < 0 || row >= m_values.size() || m_values[row] == value)
+	{
+		return;
+	}
+	remove(row);
+	m_values[row] = value;
+	add(row);
+}
+
+void StringIndex::clear()
+{
+	m_values.clear();
+	m_exact.clear();
+	m_trigrams.clear();
+}
+
+void StringIndex::add(int row)
+{
+	const auto &value = m_values[row];
+	insertSorted(m_exact[value], row);
+	for (auto &trigram : trigramsOf(value))
+	{
+		insertSorted(m_trigrams[trigram], row);
+	}
+}
+
+void StringIndex::remove(int row)
+{
+	const auto &value = m_values[row];
+	removeSorted(m_exact, value, row);
+	for (auto &trigram : trigramsOf(value))
+	{
+		removeSorted(m_trigrams, trigram, row);
+	}
+}
+
+bool StringIndex::matches(int row, const QString &filter, bool exact) const
+{
+	if (row < 0 || row >= m_values.size())
+	{
+		return false;
+	}
+	if (exact)
+	{
+		return m_values[row] == filter;
+	}
+	return m_values[row].contains(filter);
+}
+
+QBitArray StringIndex::find(const QString &filter, bool exact, const QBitArray &candidates) const
+{
+	QBitArray out(m_values.size());
+	bool restricted = !candidates.isEmpty();
+	auto consider = [&](int row)
+	{
+		return !restricted || (row < candidates.size() && candidates.testBit(row));
+	};
+
+	if (exact)
+	{
+		for (int row : m_exact.value(filter))
+		{
+			if (consider(row))
+			{
+				out.setBit(row);
+			}
+		}
+		return out;
+	}
+
+	if (filter.size() < trigramLength)
+	{
+		for (int row = 0; row < m_values.size(); row++)
+		{
+			if (consider(row) && m_values[row].contains(filter))
+			{
+				out.setBit(row);
+			}
+		}
+		return out;
+	}
+
+	// walk the rarest trigram of the filter, the value comparison weeds out the rest
+	const QVector<int> *shortest = nullptr;
+	for (auto &trigram : trigramsOf(filter))
+	{
+		auto iter = m_trigrams.find(trigram);
+		if (iter == m_trigrams.end())
+		{
+			return out;
+		}
+		if (!shortest || iter.value().size() < shortest->size())
+		{
+			shortest = &iter.value();
+		}
+	}
+	for (int row : *shortest)
+	{
+		if (consider(row) && m_values[row].contains(filter))
+		{
+			out.setBit(row);
+		}
+	}
+	return out;
+}
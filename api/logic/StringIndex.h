@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QBitArray>
+
+#include "multimc_logic_export.h"
+
+/**
+ * Lookup structure over one column of strings, addressed by row.
+ *
+ * Exact matches come from a hash of the values. Substring matches come from an index of all
+ * three character sequences: only rows containing every trigram of the filter are compared.
+ * Filters shorter than a trigram are compared against the stored values directly.
+ *
+ * Matching is case sensitive, like QString::contains.
+ */
+class MULTIMC_LOGIC_EXPORT StringIndex
+{
+public:
+	/// Replace the whole column
+	void reset(const QVector<QString> &values);
+
+	/// Change the value of one existing row
+	void setValue(int row, const QString &value);
+
+	void clear();
+
+	int size() const
+	{
+		return m_values.size();
+	}
+	const QString &value(int row) const
+	{
+		return m_values.at(row);
+	}
+
+	bool matches(int row, const QString &filter, bool exact) const;
+
+	/**
+	 * Find all matching rows.
+	 * If candidates is not empty, only the rows set in it are considered. This makes narrowing
+	 * an existing substring filter cost as much as the previous result, not the whole column.
+	 */
+	QBitArray find(const QString &filter, bool exact, const QBitArray &candidates = QBitArray()) const;
+
+private:
+	void add(int row);
+	void remove(int row);
+
+private:
+	QVector<QString> m_values;
+	// rows in the lists are kept sorted
+	QHash<QString, QVector<int>> m_exact;
+	QHash<QString, QVector<int>> m_trigrams;
+};
@@ -0,0 +1,133 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "StringIndex.h"
+
+class StringIndexTest : public QObject
+{
+	Q_OBJECT
+private:
+	// about the size and shape of the Forge version list
+	QVector<QString> makeVersions()
+	{
+		QVector<QString> versions;
+		const char *minecraft[] = {"1.7.10", "1.8.9", "1.10.2", "1.11.2", "1.12.2"};
+		for (int i = 0; i < 5000; i++)
+		{
+			versions.append(QString("%1-%2.%3.%4.%5").arg(minecraft[i % 5]).arg(10 + i % 5).arg(i % 23).arg(i % 7).arg(i));
+		}
+		return versions;
+	}
+	QList<int> rows(const QBitArray &bits)
+	{
+		QList<int> out;
+		for (int i = 0; i < bits.size(); i++)
+		{
+			if (bits.testBit(i))
+			{
+				out.append(i);
+			}
+		}
+		return out;
+	}
+
+private
+slots:
+	void test_Exact()
+	{
+		StringIndex index;
+		index.reset({"release", "snapshot", "release", "old_alpha"});
+		QCOMPARE(rows(index.find("release", true)), QList<int>({0, 2}));
+		QCOMPARE(rows(index.find("releas", true)), QList<int>());
+		QCOMPARE(rows(index.find("release", true, QBitArray(4, false))), QList<int>());
+	}
+
+	void test_Substring()
+	{
+		StringIndex index;
+		index.reset({"1.12.2-14.23.0", "1.12.2-14.23.1", "1.7.10-10.13.4", "1.12", ""});
+		QCOMPARE(rows(index.find("1.12", false)), QList<int>({0, 1, 3}));
+		QCOMPARE(rows(index.find("14.23.1", false)), QList<int>({1}));
+		QCOMPARE(rows(index.find("1.13", false)), QList<int>());
+		// shorter than a trigram
+		QCOMPARE(rows(index.find("7", false)), QList<int>({2}));
+		QCOMPARE(rows(index.find("", false)), QList<int>({0, 1, 2, 3, 4}));
+		// trigrams all present, but not next to each other
+		QCOMPARE(rows(index.find("2.210", false)), QList<int>());
+	}
+
+	void test_Narrowing()
+	{
+		StringIndex index;
+		index.reset({"1.12.2-14.23.0", "1.12.2-14.23.1", "1.7.10-10.13.4"});
+		auto wide = index.find("1.1", false);
+		QCOMPARE(rows(wide), QList<int>({0, 1, 2}));
+		auto narrow = index.find("1.12", false, wide);
+		QCOMPARE(rows(narrow), QList<int>({0, 1}));
+		QCOMPARE(rows(index.find("23.1", false, narrow)), QList<int>({1}));
+	}
+
+	void test_SetValue()
+	{
+		StringIndex index;
+		index.reset({"release", "snapshot", "release"});
+		index.setValue(2, "snapshot");
+		QCOMPARE(rows(index.find("release", true)), QList<int>({0}));
+		QCOMPARE(rows(index.find("snapshot", true)), QList<int>({1, 2}));
+		QCOMPARE(rows(index.find("apsh", false)), QList<int>({1, 2}));
+		QCOMPARE(rows(index.find("leas", false)), QList<int>({0}));
+		QVERIFY(index.matches(2, "snap", false));
+		QVERIFY(!index.matches(2, "release", true));
+	}
+
+	void test_Same_As_Contains()
+	{
+		auto versions = makeVersions();
+		StringIndex index;
+		index.reset(versions);
+		for (auto filter : {"1.12.2", "14.", "2.1", ".3.", "-1", "999"})
+		{
+			QBitArray expected(versions.size());
+			for (int i = 0; i < versions.size(); i++)
+			{
+				expected.setBit(i, versions[i].contains(filter));
+			}
+			QCOMPARE(index.find(filter, false), expected);
+		}
+	}
+
+	void test_Scan_benchmark()
+	{
+		auto versions = makeVersions();
+		QBENCHMARK
+		{
+			for (auto filter : {"1", "1.", "1.1", "1.12", "1.12.", "1.12.2", "1.12.2-", "1.12.2-14"})
+			{
+				QBitArray out(versions.size());
+				for (int i = 0; i < versions.size(); i++)
+				{
+					out.setBit(i, QVariant(versions[i]).toString().contains(filter));
+				}
+			}
+		}
+	}
+
+	void test_Index_benchmark()
+	{
+		// typing a filter, one character at a time
+		StringIndex index;
+		index.reset(makeVersions());
+		QBENCHMARK
+		{
+			QBitArray previous;
+			for (auto filter : {"1", "1.", "1.1", "1.12", "1.12.", "1.12.2", "1.12.2-", "1.12.2-14"})
+			{
+				previous = index.find(filter, false, previous);
+			}
+		}
+	}
+};
+
+QTEST_GUILESS_MAIN(StringIndexTest)
+
+#include "StringIndex_test.moc"
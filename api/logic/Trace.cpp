@@ -0,0 +1,203 @@
+#include "Trace.h"
+
+#include "FileSystem.h"
+#include "Json.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QDebug>
+#include <algorithm>
+
+namespace
+{
+struct Event
+{
+	QString name;
+	QString detail;
+	int thread;
+	int depth;
+	qint64 start;
+	qint64 duration;
+};
+
+QAtomicInt enabled(0);
+QMutex lock;
+QElapsedTimer traceClock;
+QVector<Event> events;
+QHash<Qt::HANDLE, int> threads;
+
+thread_local int depth = 0;
+
+// small numbers in order of appearance, the main thread usually being 0
+int threadNumber()
+{
+	auto handle = QThread::currentThreadId();
+	auto iter = threads.find(handle);
+	if (iter == threads.end())
+	{
+		iter = threads.insert(handle, threads.size());
+	}
+	return *iter;
+}
+}
+
+void Trace::enable()
+{
+	startClock();
+	enabled.store(1);
+}
+
+bool Trace::isEnabled()
+{
+	return enabled.load() != 0;
+}
+
+void Trace::startClock()
+{
+	QMutexLocker locker(&lock);
+	if (!traceClock.isValid())
+	{
+		traceClock.start();
+	}
+}
+
+qint64 Trace::now()
+{
+	if (!traceClock.isValid())
+	{
+		return -1;
+	}
+	return traceClock.nsecsElapsed() / 1000;
+}
+
+void Trace::clear()
+{
+	QMutexLocker locker(&lock);
+	events.clear();
+}
+
+Trace::Span::Span(const QString &name, const QString &detail)
+{
+	if (!isEnabled())
+	{
+		return;
+	}
+	m_name = name;
+	m_detail = detail;
+	m_depth = depth++;
+	QMutexLocker locker(&lock);
+	m_start = now();
+}
+
+Trace::Span::~Span()
+{
+	finish();
+}
+
+void Trace::Span::finish()
+{
+	if (m_start < 0)
+	{
+		return;
+	}
+	depth--;
+	QMutexLocker locker(&lock);
+	Event event;
+	event.name = m_name;
+	event.detail = m_detail;
+	event.thread = threadNumber();
+	event.depth = m_depth;
+	event.start = m_start;
+	event.duration = now() - m_start;
+	events.append(event);
+	m_start = -1;
+}
+
+QByteArray Trace::serialize(Format format)
+{
+	QVector<Event> sorted;
+	{
+		QMutexLocker locker(&lock);
+		sorted = events;
+	}
+	// spans are recorded when they end, parents after their children
+	std::stable_sort(sorted.begin(), sorted.end(), [](const Event &a, const Event &b)
+	{
+		if (a.start != b.start)
+		{
+			return a.start < b.start;
+		}
+		return a.depth < b.depth;
+	});
+
+	QJsonArray out;
+	if (format == Format::Chrome)
+	{
+		auto pid = QCoreApplication::applicationPid();
+		for (auto &event : sorted)
+		{
+			QJsonObject obj;
+			obj.insert("name", event.name);
+			obj.insert("cat", "MultiMC");
+			obj.insert("ph", "X");
+			obj.insert("ts", double(event.start));
+			obj.insert("dur", double(event.duration));
+			obj.insert("pid", double(pid));
+			obj.insert("tid", event.thread);
+			if (!event.detail.isEmpty())
+			{
+				QJsonObject args;
+				args.insert("detail", event.detail);
+				obj.insert("args", args);
+			}
+			out.append(obj);
+		}
+		QJsonObject root;
+		root.insert("traceEvents", out);
+		root.insert("displayTimeUnit", "ms");
+		return Json::toText(root);
+	}
+
+	for (auto &event : sorted)
+	{
+		QJsonObject obj;
+		obj.insert("name", event.name);
+		if (!event.detail.isEmpty())
+		{
+			obj.insert("detail", event.detail);
+		}
+		obj.insert("thread", event.thread);
+		obj.insert("depth", event.depth);
+		obj.insert("start_ms", event.start / 1000.0);
+		obj.insert("duration_ms", event.duration / 1000.0);
+		out.append(obj);
+	}
+	QJsonObject root;
+	root.insert("spans", out);
+	return Json::toText(root);
+}
+
+bool Trace::writeFile(const QString &path, const QByteArray &data)
+{
+	try
+	{
+		FS::write(path, data);
+	}
+	catch (FS::FileSystemException &e)
+	{
+		qWarning() << "Could not write" << path << ":" << e.cause();
+		return false;
+	}
+	qDebug() << "Wrote" << path;
+	return true;
+}
+
+bool Trace::save(const QString &path, Format format)
+{
+	return writeFile(path, serialize(format));
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+
+#include "multimc_logic_export.h"
+
+/**
+ * Timing of coarse program phases, like the steps of startup.
+ *
+ * Nothing is recorded until enable() is called; until then a Span costs one flag check.
+ * What was recorded can be written as a Chrome trace (chrome://tracing, Perfetto) or as a plain
+ * JSON list of spans, which is easier to compare between runs and machines.
+ */
+namespace Trace
+{
+enum class Format
+{
+	Chrome,
+	Json
+};
+
+/// Start recording spans
+MULTIMC_LOGIC_EXPORT void enable();
+MULTIMC_LOGIC_EXPORT bool isEnabled();
+
+/**
+ * The clock of all recordings, shared with Metrics so their times can be lined up.
+ * Started by whichever is enabled first, now() is -1 until then.
+ */
+MULTIMC_LOGIC_EXPORT void startClock();
+/// Microseconds since the clock was started
+MULTIMC_LOGIC_EXPORT qint64 now();
+
+/// Write recorded data to a file, logging why if that fails
+MULTIMC_LOGIC_EXPORT bool writeFile(const QString &path, const QByteArray &data);
+
+/// Forget everything recorded so far
+MULTIMC_LOGIC_EXPORT void clear();
+
+MULTIMC_LOGIC_EXPORT QByteArray serialize(Format format);
+MULTIMC_LOGIC_EXPORT bool save(const QString &path, Format format);
+
+/**
+ * Records the time from its construction until it is finished or destroyed.
+ * Spans alive at the same time on one thread are nested.
+ */
+class MULTIMC_LOGIC_EXPORT Span
+{
+public:
+	explicit Span(const QString &name, const QString &detail = QString());
+	~Span();
+
+	/// End the span before it goes out of scope
+	void finish();
+
+private:
+	Span(const Span &) = delete;
+	Span &operator=(const Span &) = delete;
+
+	QString m_name;
+	QString m_detail;
+	qint64 m_start = -1;
+	int m_depth = 0;
+};
+}
@@ -0,0 +1,72 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "Trace.h"
+#include "Json.h"
+
+class TraceTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_Disabled()
+	{
+		{
+			Trace::Span span("nothing");
+		}
+		auto obj = Json::requireObject(Json::requireDocument(Trace::serialize(Trace::Format::Json)));
+		QCOMPARE(Json::requireArray(obj, "spans").size(), 0);
+	}
+
+	void test_Nested()
+	{
+		Trace::enable();
+		Trace::clear();
+		{
+			Trace::Span outer("Instances");
+			{
+				Trace::Span inner("Load instance", "foo");
+				QTest::qSleep(5);
+			}
+			Trace::Span early("Discover");
+			early.finish();
+		}
+		auto obj = Json::requireObject(Json::requireDocument(Trace::serialize(Trace::Format::Json)));
+		auto spans = Json::requireArray(obj, "spans");
+		QCOMPARE(spans.size(), 3);
+		auto outer = spans[0].toObject();
+		auto inner = spans[1].toObject();
+		auto early = spans[2].toObject();
+		QCOMPARE(outer["name"].toString(), QString("Instances"));
+		QCOMPARE(outer["depth"].toInt(), 0);
+		QCOMPARE(inner["name"].toString(), QString("Load instance"));
+		QCOMPARE(inner["detail"].toString(), QString("foo"));
+		QCOMPARE(inner["depth"].toInt(), 1);
+		QCOMPARE(early["depth"].toInt(), 1);
+		QVERIFY(inner["duration_ms"].toDouble() >= 5.0);
+		QVERIFY(outer["duration_ms"].toDouble() >= inner["duration_ms"].toDouble());
+		QVERIFY(early["start_ms"].toDouble() >= inner["start_ms"].toDouble() + inner["duration_ms"].toDouble());
+	}
+
+	void test_Chrome()
+	{
+		Trace::enable();
+		Trace::clear();
+		{
+			Trace::Span span("Settings");
+		}
+		auto obj = Json::requireObject(Json::requireDocument(Trace::serialize(Trace::Format::Chrome)));
+		auto events = Json::requireArray(obj, "traceEvents");
+		QCOMPARE(events.size(), 1);
+		auto event = events[0].toObject();
+		QCOMPARE(event["name"].toString(), QString("Settings"));
+		QCOMPARE(event["ph"].toString(), QString("X"));
+		QVERIFY(event.contains("ts"));
+		QVERIFY(event.contains("dur"));
+		QVERIFY(!event.contains("args"));
+	}
+};
+
+QTEST_GUILESS_MAIN(TraceTest)
+
+#include "Trace_test.moc"
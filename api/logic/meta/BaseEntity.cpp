@@ -68,6 +68,9 @@ private: /* data */
 	Meta::BaseEntity *m_entity;
 };
 
+// the meta server is asked about a file it already confirmed only after this many seconds
+static const qint64 metaMaxAge = 10 * 60;
+
 Meta::BaseEntity::~BaseEntity()
 {
 }
@@ -99,7 +102,7 @@ bool Meta::BaseEntity::loadLocalFile()
 	}
 }
 
-void Meta::BaseEntity::load()
+void Meta::BaseEntity::load(bool forceRefresh)
 {
 	// load local file if nothing is loaded yet
 	if(!isLoaded())
@@ -114,10 +117,14 @@ void Meta::BaseEntity::load()
 	{
 		return;
 	}
+	auto entry = ENV.metacache()->resolveFreshEntry("meta", localFilename(), metaMaxAge);
+	if(isLoaded() && !entry->isStale() && !forceRefresh)
+	{
+		return;
+	}
+	entry->setStale(true);
 	NetJob *job = new NetJob(QObject::tr("Download of meta file %1").arg(localFilename()));
 	auto url = this->url();
-	auto entry = ENV.metacache()->resolveEntry("meta", localFilename());
-	entry->setStale(true);
 	auto dl = Net::Download::makeCached(url, entry);
 	/*
 	 * The validator parses the file and loads it into the object.
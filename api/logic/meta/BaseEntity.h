@@ -54,7 +54,8 @@ public:
 	bool isLoaded() const;
 	bool shouldStartRemoteUpdate() const;
 
-	void load();
+	/// Loads the local file and updates it from the server, unless the server confirmed it recently or \p forceRefresh is set
+	void load(bool forceRefresh = false);
 	shared_qobject_ptr<Task> getCurrentTask();
 
 protected: /* methods */
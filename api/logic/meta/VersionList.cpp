@@ -55,6 +55,12 @@ void VersionList::sortVersions()
 	{
 		return *a.get() < *b.get();
 	});
+	// the rows moved, so did everything that refers to them
+	for (int i = 0; i < m_versions.size(); ++i)
+	{
+		setupAddedVersion(i, m_versions.at(i));
+	}
+	rebuildFilterIndexes();
 	endResetModel();
 }
 
@@ -75,17 +81,12 @@ QVariant VersionList::data(const QModelIndex &index, int role) const
 		return version->version();
 	case ParentVersionRole:
 	{
-		auto parentUid = this->parentUid();
-		if(parentUid.isEmpty())
+		auto parentVersion = parentVersionOf(*version);
+		if(parentVersion.isEmpty())
 		{
 			return QVariant();
 		}
-		auto & reqs = version->requires();
-		auto iter = reqs.find(parentUid);
-		if (iter != reqs.end())
-		{
-			return iter.value();
-		}
+		return parentVersion;
 	}
 	case TypeRole: return version->type();
 
@@ -108,6 +109,22 @@ BaseVersionList::RoleList VersionList::providesRoles() const
 				RecommendedRole, LatestRole, VersionPtrRole};
 }
 
+const StringIndex *VersionList::filterIndex(int role) const
+{
+	switch (role)
+	{
+	case VersionRole:
+	case VersionIdRole:
+		return &m_versionIndex;
+	case ParentVersionRole:
+		return &m_parentVersionIndex;
+	case TypeRole:
+		return &m_typeIndex;
+	default:
+		return nullptr;
+	}
+}
+
 QHash<int, QByteArray> VersionList::roleNames() const
 {
 	QHash<int, QByteArray> roles = BaseVersionList::roleNames();
@@ -161,6 +178,7 @@ void VersionList::setVersions(const QVector<VersionPtr> &versions)
 
 	auto recommendedIt = std::find_if(m_versions.constBegin(), m_versions.constEnd(), [](const VersionPtr &ptr) { return ptr->type() == "release"; });
 	m_recommended = recommendedIt == m_versions.constEnd() ? nullptr : *recommendedIt;
+	rebuildFilterIndexes();
 	endResetModel();
 }
 
@@ -204,6 +222,7 @@ void VersionList::merge(const BaseEntity::Ptr &other)
 			m_recommended = version;
 		}
 	}
+	rebuildFilterIndexes();
 	endResetModel();
 }
 
@@ -211,9 +230,45 @@ void VersionList::setupAddedVersion(const int row, const VersionPtr &version)
 {
 	// FIXME: do not disconnect from everythin, disconnect only the lambdas here
 	version->disconnect();
-	connect(version.get(), &Version::requiresChanged, this, [this, row]() { emit dataChanged(index(row), index(row), QVector<int>() << RequiresRole); });
-	connect(version.get(), &Version::timeChanged, this, [this, row]() { emit dataChanged(index(row), index(row), QVector<int>() << TimeRole << SortRole); });
-	connect(version.get(), &Version::typeChanged, this, [this, row]() { emit dataChanged(index(row), index(row), QVector<int>() << TypeRole); });
+	// the version owns the connections, so it must not be kept alive by them
+	auto raw = version.get();
+	connect(raw, &Version::requiresChanged, this, [this, row, raw]()
+	{
+		m_parentVersionIndex.setValue(row, parentVersionOf(*raw));
+		emit dataChanged(index(row), index(row), QVector<int>() << RequiresRole << ParentVersionRole);
+	});
+	connect(raw, &Version::timeChanged, this, [this, row]() { emit dataChanged(index(row), index(row), QVector<int>() << TimeRole << SortRole); });
+	connect(raw, &Version::typeChanged, this, [this, row, raw]()
+	{
+		m_typeIndex.setValue(row, raw->type());
+		emit dataChanged(index(row), index(row), QVector<int>() << TypeRole);
+	});
+}
+
+QString VersionList::parentVersionOf(const Version &version) const
+{
+	if(m_parentUid.isEmpty())
+	{
+		return QString();
+	}
+	return version.requires().value(m_parentUid);
+}
+
+void VersionList::rebuildFilterIndexes()
+{
+	QVector<QString> versions, parentVersions, types;
+	versions.reserve(m_versions.size());
+	parentVersions.reserve(m_versions.size());
+	types.reserve(m_versions.size());
+	for (auto &version : m_versions)
+	{
+		versions.append(version->version());
+		parentVersions.append(parentVersionOf(*version));
+		types.append(version->type());
+	}
+	m_versionIndex.reset(versions);
+	m_parentVersionIndex.reset(parentVersions);
+	m_typeIndex.reset(types);
 }
 
 BaseVersionPtr VersionList::getRecommended() const
@@ -17,6 +17,7 @@
 
 #include "BaseEntity.h"
 #include "BaseVersionList.h"
+#include "StringIndex.h"
 #include <QJsonObject>
 #include <memory>
 
@@ -51,6 +52,7 @@ public:
 
 	QVariant data(const QModelIndex &index, int role) const override;
 	RoleList providesRoles() const override;
+	const StringIndex *filterIndex(int role) const override;
 	QHash<int, QByteArray> roleNames() const override;
 
 	QString localFilename() const override;
@@ -100,7 +102,14 @@ private:
 
 	VersionPtr m_recommended;
 
+	// filter indexes, kept in sync with m_versions
+	StringIndex m_versionIndex;
+	StringIndex m_parentVersionIndex;
+	StringIndex m_typeIndex;
+
 	void setupAddedVersion(const int row, const VersionPtr &version);
+	QString parentVersionOf(const Version &version) const;
+	void rebuildFilterIndexes();
 };
 }
 Q_DECLARE_METATYPE(Meta::VersionListPtr)
@@ -33,7 +33,46 @@ Mod::Mod(const QFileInfo &file)
 	m_changedDateTime = file.lastModified();
 }
 
+Mod::Mod(const QFileInfo &file, const QJsonObject &metadata)
+{
+	setFile(file);
+	m_changedDateTime = file.lastModified();
+	if (metadata.contains("name"))
+	{
+		m_name = metadata.value("name").toString();
+	}
+	m_mod_id = metadata.value("modId").toString();
+	m_version = metadata.value("version").toString();
+	m_mcversion = metadata.value("mcVersion").toString();
+	m_homeurl = metadata.value("homeUrl").toString();
+	m_updateurl = metadata.value("updateUrl").toString();
+	m_description = metadata.value("description").toString();
+	m_authors = metadata.value("authors").toString();
+	m_credits = metadata.value("credits").toString();
+}
+
+QJsonObject Mod::metadata() const
+{
+	QJsonObject metadata;
+	metadata.insert("name", m_name);
+	metadata.insert("modId", m_mod_id);
+	metadata.insert("version", m_version);
+	metadata.insert("mcVersion", m_mcversion);
+	metadata.insert("homeUrl", m_homeurl);
+	metadata.insert("updateUrl", m_updateurl);
+	metadata.insert("description", m_description);
+	metadata.insert("authors", m_authors);
+	metadata.insert("credits", m_credits);
+	return metadata;
+}
+
 void Mod::repath(const QFileInfo &file)
+{
+	setFile(file);
+	readMetadata();
+}
+
+void Mod::setFile(const QFileInfo &file)
 {
 	m_file = file;
 	QString name_base = file.fileName();
@@ -74,7 +113,10 @@ void Mod::repath(const QFileInfo &file)
 		}
 		m_name = name_base;
 	}
+}
 
+void Mod::readMetadata()
+{
 	if (m_type == MOD_ZIPFILE)
 	{
 		QuaZip zip(m_file.filePath());
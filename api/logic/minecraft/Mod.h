@@ -16,6 +16,7 @@
 #pragma once
 #include <QFileInfo>
 #include <QDateTime>
+#include <QJsonObject>
 
 class Mod
 {
@@ -30,6 +31,8 @@ public:
 	};
 
 	Mod(const QFileInfo &file);
+	/// Create the mod from previously read metadata, without opening its files
+	Mod(const QFileInfo &file, const QJsonObject &metadata);
 
 	QFileInfo filename() const
 	{
@@ -106,11 +109,21 @@ public:
 	// change the mod's filesystem path (used by mod lists for *MAGIC* purposes)
 	void repath(const QFileInfo &file);
 
+	/// the information read from the mod's files, to be passed back to the constructor later
+	QJsonObject metadata() const;
+	/// true if reading the metadata involves opening an archive
+	bool isArchive() const
+	{
+		return m_type == MOD_ZIPFILE || m_type == MOD_LITEMOD;
+	}
+
 	// WEAK compare operator - used for replacing mods
 	bool operator==(const Mod &other) const;
 	bool strongCompare(const Mod &other) const;
 
 private:
+	void setFile(const QFileInfo &file);
+	void readMetadata();
 	void ReadMCModInfo(QByteArray contents);
 	void ReadForgeInfo(QByteArray contents);
 	void ReadLiteModInfo(QByteArray contents);
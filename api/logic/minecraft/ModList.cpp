@@ -14,6 +14,7 @@
  */
 
 #include "ModList.h"
+#include "ModMetadataCache.h"
 #include <FileSystem.h>
 #include <QMimeData>
 #include <QUrl>
@@ -21,6 +22,8 @@
 #include <QString>
 #include <QFileSystemWatcher>
 #include <QDebug>
+#include <QSet>
+#include <QtConcurrentRun>
 
 ModList::ModList(const QString &dir) : QAbstractListModel(), m_dir(dir)
 {
@@ -30,6 +33,7 @@ ModList::ModList(const QString &dir) : QAbstractListModel(), m_dir(dir)
 	m_dir.setSorting(QDir::Name | QDir::IgnoreCase | QDir::LocaleAware);
 	m_watcher = new QFileSystemWatcher(this);
 	connect(m_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(directoryChanged(QString)));
+	connect(&m_scanWatcher, &QFutureWatcher<QList<Mod>>::finished, this, &ModList::scanFinished);
 }
 
 void ModList::startWatching()
@@ -66,58 +70,152 @@ void ModList::stopWatching()
 	}
 }
 
+QList<Mod> ModList::scan(QDir dir)
+{
+	dir.refresh();
+	auto &cache = ModMetadataCache::instance();
+	auto result = cache.mods(dir.entryInfoList());
+	// every list of an instance scans when it is opened, write the cache once for all of them
+	cache.saveEventually();
+	return result;
+}
+
 bool ModList::update()
 {
 	if (!isValid())
 		return false;
 
-	QList<Mod> orderedMods;
-	QList<Mod> newMods;
-	m_dir.refresh();
-	auto folderContents = m_dir.entryInfoList();
-	bool orderOrStateChanged = false;
+	if (m_scanFuture.isRunning())
+	{
+		// whatever the background scan finds is older than this
+		m_scanOutdated = true;
+	}
+	applyScan(scan(m_dir));
+	return true;
+}
 
-	// if there are any untracked files...
-	if (folderContents.size())
+void ModList::updateAsync()
+{
+	if (!isValid())
+		return;
+
+	if (m_scanFuture.isRunning())
 	{
-		// the order surely changed!
-		for (auto entry : folderContents)
+		// the running scan may have missed something, go again once it's done
+		m_scanPending = true;
+		return;
+	}
+	m_scanOutdated = false;
+	m_scanFuture = QtConcurrent::run(&ModList::scan, m_dir);
+	m_scanWatcher.setFuture(m_scanFuture);
+}
+
+void ModList::scanFinished()
+{
+	if (!m_scanOutdated)
+	{
+		applyScan(m_scanFuture.result());
+	}
+	m_scanOutdated = false;
+	if (m_scanPending)
+	{
+		m_scanPending = false;
+		updateAsync();
+	}
+}
+
+static QString modKey(const Mod &mod)
+{
+	return mod.filename().absoluteFilePath();
+}
+
+void ModList::applyScan(const QList<Mod> &newMods)
+{
+	bool listChanged = false;
+	QSet<QString> newKeys;
+	for (auto &mod : newMods)
+	{
+		newKeys.insert(modKey(mod));
+	}
+
+	// remove what's gone, one contiguous range at a time
+	for (int last = mods.size() - 1; last >= 0; last--)
+	{
+		if (newKeys.contains(modKey(mods[last])))
+			continue;
+		int first = last;
+		while (first > 0 && !newKeys.contains(modKey(mods[first - 1])))
 		{
-			newMods.append(Mod(entry));
+			first--;
 		}
-		orderedMods.append(newMods);
-		orderOrStateChanged = true;
+		beginRemoveRows(QModelIndex(), first, last);
+		mods.erase(mods.begin() + first, mods.begin() + last + 1);
+		endRemoveRows();
+		listChanged = true;
+		last = first;
 	}
-	// otherwise, if we were already tracking some mods
-	else if (mods.size())
+
+	// the remaining mods have to be in the same order as in the new list, or merging makes no sense
 	{
-		// if the number doesn't match, order changed.
-		if (mods.size() != orderedMods.size())
-			orderOrStateChanged = true;
-		// if it does match, compare the mods themselves
-		else
-			for (int i = 0; i < mods.size(); i++)
+		QSet<QString> oldKeys;
+		for (auto &mod : mods)
+		{
+			oldKeys.insert(modKey(mod));
+		}
+		int i = 0;
+		bool sameOrder = oldKeys.size() == mods.size();
+		for (auto &mod : newMods)
+		{
+			if (!sameOrder)
+				break;
+			if (!oldKeys.contains(modKey(mod)))
+				continue;
+			sameOrder = modKey(mods[i++]) == modKey(mod);
+		}
+		if (!sameOrder)
+		{
+			beginResetModel();
+			mods = newMods;
+			endResetModel();
+			emit changed();
+			return;
+		}
+	}
+
+	// insert new mods and update the ones that changed
+	int row = 0;
+	for (auto &mod : newMods)
+	{
+		if (row < mods.size() && modKey(mods[row]) == modKey(mod))
+		{
+			auto &current = mods[row];
+			if (!current.strongCompare(mod) || current.name() != mod.name() ||
+				current.enabled() != mod.enabled() ||
+				current.dateTimeChanged() != mod.dateTimeChanged())
 			{
-				if (!mods[i].strongCompare(orderedMods[i]))
-				{
-					orderOrStateChanged = true;
-					break;
-				}
+				current = mod;
+				emit dataChanged(index(row, 0), index(row, columnCount(QModelIndex()) - 1));
+				listChanged = true;
 			}
+		}
+		else
+		{
+			beginInsertRows(QModelIndex(), row, row);
+			mods.insert(row, mod);
+			endInsertRows();
+			listChanged = true;
+		}
+		row++;
 	}
-	beginResetModel();
-	mods.swap(orderedMods);
-	endResetModel();
-	if (orderOrStateChanged)
+	if (listChanged)
 	{
 		emit changed();
 	}
-	return true;
 }
 
 void ModList::directoryChanged(QString path)
 {
-	update();
+	updateAsync();
 }
 
 bool ModList::isValid()
@@ -19,6 +19,8 @@
 #include <QString>
 #include <QDir>
 #include <QAbstractListModel>
+#include <QFuture>
+#include <QFutureWatcher>
 
 #include "minecraft/Mod.h"
 
@@ -77,9 +79,12 @@ public:
 		return mods[index];
 	}
 
-	/// Reloads the mod list and returns true if the list changed.
+	/// Reloads the mod list right away. Returns false if the folder can't be read.
 	virtual bool update();
 
+	/// Reloads the mod list in the background, the rows are updated when it's done.
+	void updateAsync();
+
 	/**
 	 * Adds the given mod to the list at the given index - if the list supports custom ordering
 	 */
@@ -109,6 +114,11 @@ public:
 private
 slots:
 	void directoryChanged(QString path);
+	void scanFinished();
+
+private:
+	static QList<Mod> scan(QDir dir);
+	void applyScan(const QList<Mod> &newMods);
 
 signals:
 	void changed();
@@ -118,4 +128,8 @@ protected:
 	bool is_watching = false;
 	QDir m_dir;
 	QList<Mod> mods;
+	QFuture<QList<Mod>> m_scanFuture;
+	QFutureWatcher<QList<Mod>> m_scanWatcher;
+	bool m_scanPending = false;
+	bool m_scanOutdated = false;
 };
@@ -1,17 +1,51 @@
 
 #include <QTest>
 #include <QTemporaryDir>
+#include <QSignalSpy>
 #include "TestUtil.h"
 
 #include "FileSystem.h"
 #include "minecraft/ModList.h"
+#include "minecraft/ModMetadataCache.h"
+#include "settings/SaveScheduler.h"
+
+#include <quazip.h>
+#include <quazipfile.h>
 
 class ModListTest : public QObject
 {
 	Q_OBJECT
 
+private:
+	bool makeMod(const QString &path, const QString &modid, const QString &version)
+	{
+		QuaZip zip(path);
+		if (!zip.open(QuaZip::mdCreate))
+			return false;
+		QuaZipFile file(&zip);
+		if (!file.open(QIODevice::WriteOnly, QuaZipNewInfo("mcmod.info")))
+			return false;
+		auto info = QString("[{\"modid\": \"%1\", \"name\": \"Mod %1\", \"version\": \"%2\"}]").arg(modid, version);
+		file.write(info.toUtf8());
+		file.close();
+		zip.close();
+		return true;
+	}
+
 private
 slots:
+	void initTestCase()
+	{
+		// the shared cache stays out of the working directory
+		QVERIFY(m_cacheDir.isValid());
+		ModMetadataCache::setInstanceFile(FS::PathCombine(m_cacheDir.path(), "mods.json"));
+	}
+	void cleanupTestCase()
+	{
+		// write it while the folder is still there
+		SaveScheduler::instance().flush();
+	}
+
 	// test for GH-1178 - install a folder with files to a mod list
 	void test_1178()
 	{
@@ -46,6 +80,78 @@ slots:
 			verify(tempDir.path());
 		}
 	}
+
+	void test_MetadataCache()
+	{
+		QTemporaryDir tempDir;
+		QDir dir(tempDir.path());
+		for (int i = 0; i < 5; i++)
+		{
+			QVERIFY(makeMod(dir.filePath(QString("mod%1.jar").arg(i)), QString("mod%1").arg(i), "1.0"));
+		}
+		dir.setFilter(QDir::Files);
+		dir.setSorting(QDir::Name);
+
+		ModMetadataCache cache(QString());
+		auto mods = cache.mods(dir.entryInfoList());
+		QCOMPARE(mods.size(), 5);
+		QCOMPARE(mods[3].name(), QString("Mod mod3"));
+		QCOMPARE(mods[3].version(), QString("1.0"));
+		QCOMPARE(cache.parsedCount(), 5);
+
+		// nothing changed, nothing is opened
+		mods = cache.mods(dir.entryInfoList());
+		QCOMPARE(mods[3].name(), QString("Mod mod3"));
+		QCOMPARE(cache.parsedCount(), 5);
+
+		// disabling a mod doesn't change what's in it
+		QVERIFY(mods[1].enable(false));
+		dir.refresh();
+		mods = cache.mods(dir.entryInfoList());
+		QCOMPARE(mods[1].name(), QString("Mod mod1"));
+		QVERIFY(!mods[1].enabled());
+		QCOMPARE(cache.parsedCount(), 5);
+
+		// only the changed mod is read again
+		QVERIFY(QFile::remove(dir.filePath("mod2.jar")));
+		QVERIFY(makeMod(dir.filePath("mod2.jar"), "mod2", "2.0-with-a-longer-version"));
+		dir.refresh();
+		mods = cache.mods(dir.entryInfoList());
+		QCOMPARE(mods[2].version(), QString("2.0-with-a-longer-version"));
+		QCOMPARE(cache.parsedCount(), 6);
+	}
+
+	void test_IncrementalUpdate()
+	{
+		QTemporaryDir tempDir;
+		QDir dir(tempDir.path());
+		QVERIFY(makeMod(dir.filePath("a.jar"), "a", "1.0"));
+		QVERIFY(makeMod(dir.filePath("c.jar"), "c", "1.0"));
+
+		ModList list(tempDir.path());
+		QVERIFY(list.update());
+		QCOMPARE(list.rowCount(QModelIndex()), 2);
+
+		QSignalSpy resetSpy(&list, SIGNAL(modelReset()));
+		QSignalSpy insertSpy(&list, SIGNAL(rowsInserted(QModelIndex, int, int)));
+		QSignalSpy removeSpy(&list, SIGNAL(rowsRemoved(QModelIndex, int, int)));
+
+		QVERIFY(makeMod(dir.filePath("b.jar"), "b", "1.0"));
+		QVERIFY(list.update());
+		QCOMPARE(list.rowCount(QModelIndex()), 3);
+		QCOMPARE(list[1].name(), QString("Mod b"));
+		QCOMPARE(insertSpy.count(), 1);
+		QCOMPARE(insertSpy[0][1].toInt(), 1);
+
+		QVERIFY(QFile::remove(dir.filePath("a.jar")));
+		list.updateAsync();
+		QTRY_COMPARE(list.rowCount(QModelIndex()), 2);
+		QCOMPARE(removeSpy.count(), 1);
+		QCOMPARE(resetSpy.count(), 0);
+	}
+
+private:
+	QTemporaryDir m_cacheDir;
 };
 
 QTEST_GUILESS_MAIN(ModListTest)
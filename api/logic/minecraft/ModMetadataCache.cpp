@@ -0,0 +1,217 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ModMetadataCache.h"
+#include "settings/SaveScheduler.h"
+#include <FileSystem.h>
+
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QtConcurrentMap>
+#include <QDebug>
+
+ModMetadataCache::ModMetadataCache(const QString &cacheFile) : m_cacheFile(cacheFile)
+{
+}
+
+static QString &instanceFile()
+{
+	static QString file = "cache/mods.json";
+	return file;
+}
+
+ModMetadataCache &ModMetadataCache::instance()
+{
+	// never destroyed, scans may still be running in the background when the application quits
+	static ModMetadataCache *cache = []()
+	{
+		auto cache = new ModMetadataCache(instanceFile());
+		cache->load();
+		return cache;
+	}();
+	return *cache;
+}
+
+void ModMetadataCache::setInstanceFile(const QString &cacheFile)
+{
+	instanceFile() = cacheFile;
+}
+
+void ModMetadataCache::load()
+{
+	if (m_cacheFile.isEmpty() || !QFile::exists(m_cacheFile))
+	{
+		return;
+	}
+	QByteArray data;
+	try
+	{
+		data = FS::read(m_cacheFile);
+	}
+	catch (FS::FileSystemException &e)
+	{
+		qWarning() << "Unable to read the mod metadata cache:" << e.cause();
+		return;
+	}
+	auto files = QJsonDocument::fromJson(data).object().value("files").toArray();
+	QMutexLocker locker(&m_mutex);
+	for (auto fileValue : files)
+	{
+		auto fileObj = fileValue.toObject();
+		auto path = fileObj.value("path").toString();
+		// forget about mods that were removed since
+		if (path.isEmpty() || !(QFile::exists(path) || QFile::exists(path + ".disabled")))
+		{
+			m_dirty = true;
+			continue;
+		}
+		Entry entry;
+		entry.size = fileObj.value("size").toVariant().toLongLong();
+		entry.mtime = fileObj.value("mtime").toVariant().toLongLong();
+		entry.metadata = fileObj.value("metadata").toObject();
+		m_entries.insert(path, entry);
+	}
+}
+
+QByteArray ModMetadataCache::serialize()
+{
+	QJsonArray files;
+	for (auto iter = m_entries.begin(); iter != m_entries.end(); iter++)
+	{
+		QJsonObject fileObj;
+		fileObj.insert("path", iter.key());
+		// as strings, JSON numbers are doubles
+		fileObj.insert("size", QString::number(iter->size));
+		fileObj.insert("mtime", QString::number(iter->mtime));
+		fileObj.insert("metadata", iter->metadata);
+		files.append(fileObj);
+	}
+	QJsonObject root;
+	root.insert("formatVersion", 1);
+	root.insert("files", files);
+	return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool ModMetadataCache::save()
+{
+	QMutexLocker locker(&m_mutex);
+	if (m_cacheFile.isEmpty() || !m_dirty)
+	{
+		return true;
+	}
+	try
+	{
+		FS::write(m_cacheFile, serialize());
+	}
+	catch (FS::FileSystemException &e)
+	{
+		qWarning() << "Unable to save the mod metadata cache:" << e.cause();
+		return false;
+	}
+	m_dirty = false;
+	return true;
+}
+
+void ModMetadataCache::saveEventually()
+{
+	QMutexLocker locker(&m_mutex);
+	if (m_cacheFile.isEmpty() || !m_dirty)
+	{
+		return;
+	}
+	SaveScheduler::instance().schedule(m_cacheFile, serialize());
+	m_dirty = false;
+}
+
+QString ModMetadataCache::key(const QFileInfo &file)
+{
+	// enabling and disabling a mod only renames it, the contents stay the same
+	auto path = file.absoluteFilePath();
+	if (path.endsWith(".disabled"))
+	{
+		path.chop(9);
+	}
+	return path;
+}
+
+bool ModMetadataCache::lookup(const QFileInfo &file, QJsonObject &metadata)
+{
+	QMutexLocker locker(&m_mutex);
+	auto iter = m_entries.find(key(file));
+	if (iter == m_entries.end() || iter->size != file.size() ||
+		iter->mtime != file.lastModified().toMSecsSinceEpoch())
+	{
+		return false;
+	}
+	metadata = iter->metadata;
+	return true;
+}
+
+QList<Mod> ModMetadataCache::mods(const QFileInfoList &files)
+{
+	QList<Mod> result;
+	QList<int> toParse;
+	for (int i = 0; i < files.size(); i++)
+	{
+		auto &file = files[i];
+		QJsonObject metadata;
+		if (lookup(file, metadata))
+		{
+			result.append(Mod(file, metadata));
+			continue;
+		}
+		// the name decides what kind of mod it is, no need to open anything yet
+		Mod mod(file, QJsonObject());
+		if (mod.isArchive())
+		{
+			toParse.append(i);
+			result.append(mod);
+		}
+		else
+		{
+			// folders and loose files are cheap to look at, they are not worth remembering
+			result.append(Mod(file));
+		}
+	}
+	if (toParse.isEmpty())
+	{
+		return result;
+	}
+
+	QtConcurrent::blockingMap(toParse, [&](int index)
+	{
+		Mod mod(files[index]);
+		auto file = files[index];
+		Entry entry;
+		entry.size = file.size();
+		entry.mtime = file.lastModified().toMSecsSinceEpoch();
+		entry.metadata = mod.metadata();
+
+		QMutexLocker locker(&m_mutex);
+		result[index] = mod;
+		m_entries.insert(key(file), entry);
+		m_parsedCount++;
+		m_dirty = true;
+	});
+	return result;
+}
+
+int ModMetadataCache::parsedCount() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_parsedCount;
+}
@@ -0,0 +1,74 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QMutex>
+
+#include "minecraft/Mod.h"
+
+#include "multimc_logic_export.h"
+
+/**
+ * Remembers what was read from mod archives, keyed by path, size and modification time.
+ *
+ * Only archives that are new or changed since the last time are opened, and those are read in
+ * parallel. Safe to use from several threads at once.
+ */
+class MULTIMC_LOGIC_EXPORT ModMetadataCache
+{
+public:
+	explicit ModMetadataCache(const QString &cacheFile);
+
+	/// the cache shared by all mod lists, loaded on first use
+	static ModMetadataCache &instance();
+
+	/// Where instance() keeps its cache. Only has an effect before instance() is first used.
+	static void setInstanceFile(const QString &cacheFile);
+
+	void load();
+	bool save();
+	/// Save through the SaveScheduler, so saves that come in quick succession are written once
+	void saveEventually();
+
+	/// Mods for the given files, in the same order
+	QList<Mod> mods(const QFileInfoList &files);
+
+	/// how many archives had to be opened so far
+	int parsedCount() const;
+
+private:
+	struct Entry
+	{
+		qint64 size = 0;
+		qint64 mtime = 0;
+		QJsonObject metadata;
+	};
+	static QString key(const QFileInfo &file);
+	QByteArray serialize();
+	bool lookup(const QFileInfo &file, QJsonObject &metadata);
+
+private:
+	QString m_cacheFile;
+	mutable QMutex m_mutex;
+	QHash<QString, Entry> m_entries;
+	int m_parsedCount = 0;
+	bool m_dirty = false;
+};
@@ -0,0 +1,285 @@
+#include "NbtScanner.h"
+
+#include <io/stream_reader.h>
+
+// same as libnbt++, deeper than this is not a sane file
+static const int maxDepth = 1024;
+
+NbtScanner::NbtScanner(const QStringList &paths)
+{
+	for (auto &path : paths)
+	{
+		m_wanted.insert(path);
+		auto parts = path.split('/');
+		QString prefix;
+		for (int i = 0; i < parts.size() - 1; i++)
+		{
+			prefix = prefix.isEmpty() ? parts[i] : prefix + '/' + parts[i];
+			m_prefixes.insert(prefix);
+		}
+	}
+}
+
+NbtScanner::TagType NbtScanner::type(const QString &path) const
+{
+	return m_types.value(path, End);
+}
+
+QVariant NbtScanner::value(const QString &path) const
+{
+	return m_values.value(path);
+}
+
+bool NbtScanner::scan(std::istream &in)
+{
+	m_types.clear();
+	m_values.clear();
+	m_rootName.clear();
+	m_skipped = 0;
+	try
+	{
+		nbt::io::stream_reader reader(in);
+		int8_t rootType = 0;
+		reader.read_num(rootType);
+		if (!in || rootType != Compound)
+		{
+			return false;
+		}
+		m_rootName = QString::fromStdString(reader.read_string());
+		scanCompound(reader, QString(), 0);
+		return true;
+	}
+	catch (nbt::io::input_error &e)
+	{
+		return false;
+	}
+}
+
+bool NbtScanner::scanCompound(nbt::io::stream_reader &reader, const QString &prefix, int depth)
+{
+	if (depth > maxDepth)
+	{
+		throw nbt::io::input_error("NBT nested too deeply");
+	}
+	while (true)
+	{
+		int8_t rawType = 0;
+		reader.read_num(rawType);
+		if (!reader.get_istr())
+		{
+			throw nbt::io::input_error("Unexpected end of NBT data");
+		}
+		auto type = TagType(rawType);
+		if (type == End)
+		{
+			return false;
+		}
+		if (type > LongArray || type < End)
+		{
+			throw nbt::io::input_error("Invalid NBT tag type");
+		}
+		auto name = QString::fromStdString(reader.read_string());
+		auto path = prefix.isEmpty() ? name : prefix + '/' + name;
+
+		if (m_wanted.contains(path))
+		{
+			m_types.insert(path, type);
+			if (m_types.size() == m_wanted.size())
+			{
+				// this is the last one, read it and stop
+				if (type != Compound && type != List)
+				{
+					m_values.insert(path, readValue(reader, type));
+				}
+				return true;
+			}
+		}
+
+		if (type == Compound && m_prefixes.contains(path))
+		{
+			if (scanCompound(reader, path, depth + 1))
+			{
+				return true;
+			}
+		}
+		else if (m_wanted.contains(path) && type != Compound && type != List)
+		{
+			m_values.insert(path, readValue(reader, type));
+		}
+		else
+		{
+			m_skipped++;
+			skipPayload(reader, type, depth + 1);
+		}
+	}
+}
+
+QVariant NbtScanner::readValue(nbt::io::stream_reader &reader, TagType type)
+{
+	switch (type)
+	{
+	case Byte:
+	{
+		int8_t value;
+		reader.read_num(value);
+		return int(value);
+	}
+	case Short:
+	{
+		int16_t value;
+		reader.read_num(value);
+		return int(value);
+	}
+	case Int:
+	{
+		int32_t value;
+		reader.read_num(value);
+		return int(value);
+	}
+	case Long:
+	{
+		int64_t value;
+		reader.read_num(value);
+		return qlonglong(value);
+	}
+	case Float:
+	{
+		float value;
+		reader.read_num(value);
+		return value;
+	}
+	case Double:
+	{
+		double value;
+		reader.read_num(value);
+		return value;
+	}
+	case String:
+		return QString::fromStdString(reader.read_string());
+	default:
+		// arrays are not interesting enough to keep
+		skipPayload(reader, type, 0);
+		return QVariant();
+	}
+}
+
+void NbtScanner::skipBytes(nbt::io::stream_reader &reader, qint64 count)
+{
+	auto &in = reader.get_istr();
+	in.ignore(count);
+	if (!in || in.gcount() != count)
+	{
+		throw nbt::io::input_error("Unexpected end of NBT data");
+	}
+}
+
+void NbtScanner::skipPayload(nbt::io::stream_reader &reader, TagType type, int depth)
+{
+	if (depth > maxDepth)
+	{
+		throw nbt::io::input_error("NBT nested too deeply");
+	}
+	switch (type)
+	{
+	case Byte:
+		skipBytes(reader, 1);
+		return;
+	case Short:
+		skipBytes(reader, 2);
+		return;
+	case Int:
+	case Float:
+		skipBytes(reader, 4);
+		return;
+	case Long:
+	case Double:
+		skipBytes(reader, 8);
+		return;
+	case String:
+	{
+		uint16_t length;
+		reader.read_num(length);
+		skipBytes(reader, length);
+		return;
+	}
+	case ByteArray:
+	case IntArray:
+	case LongArray:
+	{
+		int32_t length;
+		reader.read_num(length);
+		if (length < 0)
+		{
+			throw nbt::io::input_error("Negative NBT array length");
+		}
+		int elementSize = type == ByteArray ? 1 : (type == IntArray ? 4 : 8);
+		skipBytes(reader, qint64(length) * elementSize);
+		return;
+	}
+	case List:
+	{
+		int8_t rawElementType;
+		int32_t length;
+		reader.read_num(rawElementType);
+		reader.read_num(length);
+		auto elementType = TagType(rawElementType);
+		if (length < 0 || elementType < End || elementType > LongArray)
+		{
+			throw nbt::io::input_error("Invalid NBT list");
+		}
+		// lists of fixed size elements are skipped in one go
+		switch (elementType)
+		{
+		case End:
+			return;
+		case Byte:
+			skipBytes(reader, length);
+			return;
+		case Short:
+			skipBytes(reader, qint64(length) * 2);
+			return;
+		case Int:
+		case Float:
+			skipBytes(reader, qint64(length) * 4);
+			return;
+		case Long:
+		case Double:
+			skipBytes(reader, qint64(length) * 8);
+			return;
+		default:
+			for (int32_t i = 0; i < length; i++)
+			{
+				skipPayload(reader, elementType, depth + 1);
+			}
+			return;
+		}
+	}
+	case Compound:
+	{
+		while (true)
+		{
+			int8_t rawType = 0;
+			reader.read_num(rawType);
+			if (!reader.get_istr())
+			{
+				throw nbt::io::input_error("Unexpected end of NBT data");
+			}
+			auto childType = TagType(rawType);
+			if (childType == End)
+			{
+				return;
+			}
+			if (childType > LongArray || childType < End)
+			{
+				throw nbt::io::input_error("Invalid NBT tag type");
+			}
+			uint16_t nameLength;
+			reader.read_num(nameLength);
+			skipBytes(reader, nameLength);
+			skipPayload(reader, childType, depth + 1);
+		}
+	}
+	case End:
+		return;
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QHash>
+#include <QSet>
+#include <istream>
+
+#include "multimc_logic_export.h"
+
+namespace nbt
+{
+namespace io
+{
+class stream_reader;
+}
+}
+
+/**
+ * Picks a few values out of an NBT stream without building the tag tree.
+ *
+ * Tags are addressed by their names below the root compound, separated by '/', like
+ * "Data/LevelName". Anything that doesn't lead to a wanted tag is skipped without being
+ * stored, and reading stops as soon as all the wanted tags were seen.
+ */
+class MULTIMC_LOGIC_EXPORT NbtScanner
+{
+public:
+	enum TagType
+	{
+		End = 0,
+		Byte = 1,
+		Short = 2,
+		Int = 3,
+		Long = 4,
+		Float = 5,
+		Double = 6,
+		ByteArray = 7,
+		String = 8,
+		List = 9,
+		Compound = 10,
+		IntArray = 11,
+		LongArray = 12
+	};
+
+	explicit NbtScanner(const QStringList &paths);
+
+	/*!
+	 * Reads the root compound from the stream until all the wanted tags are found.
+	 *
+	 * @return false if the stream isn't valid NBT. Wanted tags that don't exist are not an error.
+	 */
+	bool scan(std::istream &in);
+
+	/// name of the root compound
+	QString rootName() const
+	{
+		return m_rootName;
+	}
+
+	/// type of a wanted tag, End if it wasn't found
+	TagType type(const QString &path) const;
+
+	/// value of a wanted numeric or string tag, null for everything else
+	QVariant value(const QString &path) const;
+
+	/// how many tags were skipped over (with everything inside them) during the last scan
+	int skippedTags() const
+	{
+		return m_skipped;
+	}
+
+private:
+	bool scanCompound(nbt::io::stream_reader &reader, const QString &prefix, int depth);
+	QVariant readValue(nbt::io::stream_reader &reader, TagType type);
+	void skipPayload(nbt::io::stream_reader &reader, TagType type, int depth);
+	void skipBytes(nbt::io::stream_reader &reader, qint64 count);
+
+private:
+	QSet<QString> m_wanted;
+	// all the compounds leading to wanted tags
+	QSet<QString> m_prefixes;
+	QHash<QString, TagType> m_types;
+	QHash<QString, QVariant> m_values;
+	QString m_rootName;
+	int m_skipped = 0;
+};
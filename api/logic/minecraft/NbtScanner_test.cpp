@@ -0,0 +1,187 @@
+#include <QTest>
+#include <QBuffer>
+#include "TestUtil.h"
+
+#include "minecraft/NbtScanner.h"
+#include "minecraft/World.h"
+#include "GZip.h"
+#include "FileSystem.h"
+
+#include <sstream>
+#include <io/stream_reader.h>
+#include <io/stream_writer.h>
+#include <tag_compound.h>
+#include <tag_list.h>
+#include <tag_array.h>
+#include <tag_string.h>
+#include <tag_primitive.h>
+
+class NbtScannerTest : public QObject
+{
+	Q_OBJECT
+private:
+	// roughly what a big modpack leaves in level.dat: huge registries next to the few tags we want
+	QByteArray makeLevelDat()
+	{
+		nbt::tag_compound root;
+
+		nbt::tag_compound registries;
+		for(int r = 0; r < 20; r++)
+		{
+			nbt::tag_list ids;
+			for(int i = 0; i < 2000; i++)
+			{
+				nbt::tag_compound id;
+				id.put("K", nbt::tag_string(QString("somemod%1:block_%2").arg(r).arg(i).toStdString()));
+				id.put("V", nbt::tag_int(i));
+				ids.push_back(std::move(id));
+			}
+			nbt::tag_compound registry;
+			registry.put("ids", std::move(ids));
+			registry.put("blocked", nbt::tag_int_array(std::vector<int32_t>(500, r)));
+			registries.put(QString("somemod%1:blocks").arg(r).toStdString(), std::move(registry));
+		}
+		nbt::tag_compound fml;
+		fml.put("Registries", std::move(registries));
+		root.put("FML", std::move(fml));
+
+		nbt::tag_compound data;
+		nbt::tag_list inventory;
+		for(int i = 0; i < 36; i++)
+		{
+			nbt::tag_compound stack;
+			stack.put("id", nbt::tag_string("minecraft:stone"));
+			stack.put("Count", nbt::tag_byte(64));
+			stack.put("Slot", nbt::tag_byte(i));
+			inventory.push_back(std::move(stack));
+		}
+		nbt::tag_compound player;
+		player.put("Inventory", std::move(inventory));
+		player.put("Pos", nbt::tag_list({1.0, 64.0, -3.5}));
+		data.put("Player", std::move(player));
+
+		nbt::tag_compound gameRules;
+		for(int i = 0; i < 200; i++)
+		{
+			gameRules.put(QString("rule%1").arg(i).toStdString(), nbt::tag_string("true"));
+		}
+		data.put("GameRules", std::move(gameRules));
+		data.put("LevelName", nbt::tag_string("Modded World"));
+		data.put("LastPlayed", nbt::tag_long(1500000000000));
+		data.put("RandomSeed", nbt::tag_long(-1234567890123));
+		root.put("Data", std::move(data));
+
+		std::ostringstream out;
+		nbt::io::write_tag("", root, out);
+		auto str = out.str();
+		return QByteArray(str.data(), str.size());
+	}
+
+private
+slots:
+	void initTestCase()
+	{
+		m_levelDat = makeLevelDat();
+		QVERIFY(GZip::zip(m_levelDat, m_compressed));
+	}
+	void cleanupTestCase()
+	{
+		QDir("test_world").removeRecursively();
+	}
+
+	void test_Values()
+	{
+		QBuffer device(&m_compressed);
+		device.open(QIODevice::ReadOnly);
+		GZipStreamBuf buffer(&device);
+		std::istream input(&buffer);
+
+		NbtScanner scanner({"Data", "Data/LevelName", "Data/LastPlayed", "Data/RandomSeed"});
+		QVERIFY(scanner.scan(input));
+		QCOMPARE(scanner.rootName(), QString());
+		QCOMPARE(scanner.type("Data"), NbtScanner::Compound);
+		QCOMPARE(scanner.value("Data/LevelName").toString(), QString("Modded World"));
+		QCOMPARE(scanner.value("Data/LastPlayed").toLongLong(), qlonglong(1500000000000));
+		QCOMPARE(scanner.value("Data/RandomSeed").toLongLong(), qlonglong(-1234567890123));
+		// GameRules and Player are skipped as whole subtrees, FML is never reached
+		QCOMPARE(scanner.skippedTags(), 2);
+	}
+
+	void test_StopsEarly()
+	{
+		QBuffer device(&m_compressed);
+		device.open(QIODevice::ReadOnly);
+		GZipStreamBuf buffer(&device);
+		std::istream input(&buffer);
+
+		// the registries come after the level name
+		NbtScanner scanner({"Data/LevelName"});
+		QVERIFY(scanner.scan(input));
+		QCOMPARE(scanner.value("Data/LevelName").toString(), QString("Modded World"));
+		QVERIFY(buffer.inflatedBytes() < m_levelDat.size());
+	}
+
+	void test_Missing()
+	{
+		std::istringstream input(std::string(m_levelDat.constData(), m_levelDat.size()));
+		NbtScanner scanner({"Data/LevelName", "Data/Version/Name"});
+		QVERIFY(scanner.scan(input));
+		QCOMPARE(scanner.type("Data/Version/Name"), NbtScanner::End);
+		QVERIFY(scanner.value("Data/Version/Name").isNull());
+		QCOMPARE(scanner.value("Data/LevelName").toString(), QString("Modded World"));
+	}
+
+	void test_Truncated()
+	{
+		auto truncated = m_levelDat.left(m_levelDat.size() / 2);
+		std::istringstream input(std::string(truncated.constData(), truncated.size()));
+		NbtScanner scanner({"Data/LevelName"});
+		QVERIFY(!scanner.scan(input));
+	}
+
+	void test_World()
+	{
+		QDir().mkpath("test_world");
+		QVERIFY(FS::write("test_world/level.dat", m_compressed));
+		World world(QFileInfo("test_world"));
+		QVERIFY(world.isValid());
+		QCOMPARE(world.name(), QString("Modded World"));
+		QCOMPARE(world.seed(), int64_t(-1234567890123));
+		QCOMPARE(world.lastPlayed(), QDateTime::fromMSecsSinceEpoch(1500000000000));
+	}
+
+	void test_FullParse_benchmark()
+	{
+		QBENCHMARK
+		{
+			QByteArray uncompressed;
+			QVERIFY(GZip::unzip(m_compressed, uncompressed));
+			std::istringstream input(std::string(uncompressed.constData(), uncompressed.size()));
+			auto pair = nbt::io::read_compound(input);
+			auto &data = pair.second->at("Data");
+			QCOMPARE(QString::fromStdString(data.at("LevelName").as<nbt::tag_string>().get()), QString("Modded World"));
+		}
+	}
+
+	void test_Scan_benchmark()
+	{
+		QBENCHMARK
+		{
+			QBuffer device(&m_compressed);
+			device.open(QIODevice::ReadOnly);
+			GZipStreamBuf buffer(&device);
+			std::istream input(&buffer);
+			NbtScanner scanner({"Data", "Data/LevelName", "Data/LastPlayed", "Data/RandomSeed"});
+			QVERIFY(scanner.scan(input));
+			QCOMPARE(scanner.value("Data/LevelName").toString(), QString("Modded World"));
+		}
+	}
+
+private:
+	QByteArray m_levelDat;
+	QByteArray m_compressed;
+};
+
+QTEST_GUILESS_MAIN(NbtScannerTest)
+
+#include "NbtScanner_test.moc"
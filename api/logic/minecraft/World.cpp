@@ -26,6 +26,7 @@
 #include <io/stream_reader.h>
 #include <tag_string.h>
 #include <tag_primitive.h>
+#include "NbtScanner.h"
 #include <quazip.h>
 #include <quazipfile.h>
 #include <quazipdir.h>
@@ -128,14 +129,15 @@ void World::repath(const QFileInfo &file)
 
 void World::readFromFS(const QFileInfo &file)
 {
-	auto bytes = getLevelDatDataFromFS(file);
-	if(bytes.isEmpty())
+	auto fullFilePath = getLevelDatFromFS(file);
+	QFile levelDat(fullFilePath);
+	if(fullFilePath.isNull() || !levelDat.open(QIODevice::ReadOnly))
 	{
 		is_valid = false;
 		return;
 	}
-	loadFromLevelDat(bytes);
 	levelDatTime = file.lastModified();
+	loadFromLevelDat(levelDat);
 }
 
 void World::readFromZip(const QFileInfo &file)
@@ -173,7 +175,8 @@ void World::readFromZip(const QFileInfo &file)
 	{
 		return;
 	}
-	loadFromLevelDat(zippedFile.readAll());
+	// inflated straight from the archive, the entry is never held in memory as a whole
+	loadFromLevelDat(zippedFile);
 	zippedFile.close();
 }
 
@@ -251,99 +254,57 @@ bool World::rename(const QString &newName)
 	return true;
 }
 
-static QString read_string (nbt::value& parent, const char * name, const QString & fallback = QString())
+void World::loadFromLevelDat(QIODevice &device)
 {
-	try
+	// only the few values we show are read, the rest of the file is skipped or not read at all
+	GZipStreamBuf buffer(&device);
+	std::istream input(&buffer);
+	NbtScanner scanner({"Data", "Data/LevelName", "Data/LastPlayed", "Data/RandomSeed"});
+	if(!scanner.scan(input) || !scanner.rootName().isEmpty())
 	{
-		auto &namedValue = parent.at(name);
-		if(namedValue.get_type() != nbt::tag_type::String)
-		{
-			return fallback;
-		}
-		auto & tag_str = namedValue.as<nbt::tag_string>();
-		return QString::fromStdString(tag_str.get());
+		qWarning() << "Unable to load" << m_folderName << ": level.dat is not valid NBT";
+		is_valid = false;
+		return;
 	}
-	catch(std::out_of_range e)
+
+	is_valid = scanner.type("Data") == NbtScanner::Compound;
+	if(!is_valid)
+		return;
+
+	if(scanner.type("Data/LevelName") == NbtScanner::String)
 	{
-		// fallback for old world formats
-		qWarning() << "String NBT tag" << name << "could not be found. Defaulting to" << fallback;
-		return fallback;
+		m_actualName = scanner.value("Data/LevelName").toString();
 	}
-	catch(std::bad_cast e)
+	else
 	{
-		// type mismatch
-		qWarning() << "NBT tag" << name << "could not be converted to string. Defaulting to" << fallback;
-		return fallback;
+		// fallback for old world formats
+		qWarning() << "String NBT tag LevelName could not be found. Defaulting to" << m_folderName;
+		m_actualName = m_folderName;
 	}
-};
 
-static int64_t read_long (nbt::value& parent, const char * name, const int64_t & fallback = 0)
-{
-	try
+	int64_t temp = 0;
+	if(scanner.type("Data/LastPlayed") == NbtScanner::Long)
 	{
-		auto &namedValue = parent.at(name);
-		if(namedValue.get_type() != nbt::tag_type::Long)
-		{
-			return fallback;
-		}
-		auto & tag_str = namedValue.as<nbt::tag_long>();
-		return tag_str.get();
+		temp = scanner.value("Data/LastPlayed").toLongLong();
 	}
-	catch(std::out_of_range e)
+	if(temp == 0)
 	{
-		// fallback for old world formats
-		qWarning() << "Long NBT tag" << name << "could not be found. Defaulting to" << fallback;
-		return fallback;
+		m_lastPlayed = levelDatTime;
 	}
-	catch(std::bad_cast e)
+	else
 	{
-		// type mismatch
-		qWarning() << "NBT tag" << name << "could not be converted to long. Defaulting to" << fallback;
-		return fallback;
+		m_lastPlayed = QDateTime::fromMSecsSinceEpoch(temp);
 	}
-};
-
-void World::loadFromLevelDat(QByteArray data)
-{
-	try
-	{
-		auto levelData = parseLevelDat(data);
-		if(!levelData)
-		{
-			is_valid = false;
-			return;
-		}
-
-		auto &val = levelData->at("Data");
-		is_valid = val.get_type() == nbt::tag_type::Compound;
-		if(!is_valid)
-			return;
-
-		m_actualName = read_string(val, "LevelName", m_folderName);
-
-
-		int64_t temp = read_long(val, "LastPlayed", 0);
-		if(temp == 0)
-		{
-			m_lastPlayed = levelDatTime;
-		}
-		else
-		{
-			m_lastPlayed = QDateTime::fromMSecsSinceEpoch(temp);
-		}
-
-		m_randomSeed = read_long(val, "RandomSeed", 0);
 
-		qDebug() << "World Name:" << m_actualName;
-		qDebug() << "Last Played:" << m_lastPlayed.toString();
-		qDebug() << "Seed:" << m_randomSeed;
-	}
-	catch (nbt::io::input_error e)
+	m_randomSeed = 0;
+	if(scanner.type("Data/RandomSeed") == NbtScanner::Long)
 	{
-		qWarning() << "Unable to load" << m_folderName << ":" << e.what();
-		is_valid = false;
-		return;
+		m_randomSeed = scanner.value("Data/RandomSeed").toLongLong();
 	}
+
+	qDebug() << "World Name:" << m_actualName;
+	qDebug() << "Last Played:" << m_lastPlayed.toString();
+	qDebug() << "Seed:" << m_randomSeed;
 }
 
 bool World::replace(World &with)
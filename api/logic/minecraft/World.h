@@ -19,6 +19,8 @@
 
 #include "multimc_logic_export.h"
 
+class QIODevice;
+
 class MULTIMC_LOGIC_EXPORT World
 {
 public:
@@ -68,7 +70,7 @@ public:
 private:
 	void readFromZip(const QFileInfo &file);
 	void readFromFS(const QFileInfo &file);
-	void loadFromLevelDat(QByteArray data);
+	void loadFromLevelDat(QIODevice &device);
 
 protected:
 
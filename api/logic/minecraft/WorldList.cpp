@@ -20,7 +20,10 @@
 #include <QUuid>
 #include <QString>
 #include <QFileSystemWatcher>
+#include <QDirIterator>
+#include <QSet>
 #include <QDebug>
+#include <QtConcurrentRun>
 
 WorldList::WorldList(const QString &dir)
 	: QAbstractListModel(), m_dir(dir)
@@ -33,6 +36,8 @@ WorldList::WorldList(const QString &dir)
 	is_watching = false;
 	connect(m_watcher, SIGNAL(directoryChanged(QString)), this,
 			SLOT(directoryChanged(QString)));
+	connect(&m_scanWatcher, &QFutureWatcher<ScanResult>::finished, this, &WorldList::scanFinished);
+	connect(&m_sizeWatcher, &QFutureWatcher<QHash<QString, qint64>>::finished, this, &WorldList::sizeScanFinished);
 }
 
 void WorldList::startWatching()
@@ -70,30 +75,247 @@ void WorldList::stopWatching()
 	}
 }
 
-bool WorldList::update()
+static QString worldKey(const World &world)
 {
-	if (!isValid())
-		return false;
+	return world.container().absoluteFilePath();
+}
+
+// what has to change for a world to be parsed again
+static qint64 worldStamp(const QFileInfo &entry)
+{
+	if(entry.isDir())
+	{
+		QFileInfo levelDat(QDir(entry.absoluteFilePath()).absoluteFilePath("level.dat"));
+		return levelDat.exists() ? levelDat.lastModified().toMSecsSinceEpoch() : -1;
+	}
+	return entry.lastModified().toMSecsSinceEpoch();
+}
 
-	QList<World> newWorlds;
-	m_dir.refresh();
-	auto folderContents = m_dir.entryInfoList();
+WorldList::ScanResult WorldList::scan(QDir dir, WorldCache cache)
+{
+	ScanResult result;
+	dir.refresh();
+	auto folderContents = dir.entryInfoList();
 	// if there are any untracked files...
 	for (QFileInfo entry : folderContents)
 	{
 		if(!entry.isDir())
 			continue;
 
+		auto key = entry.absoluteFilePath();
+		auto stamp = worldStamp(entry);
+		auto cached = cache.find(key);
+		if(cached != cache.end() && cached->stamp == stamp)
+		{
+			if(cached->world.isValid())
+			{
+				result.worlds.append(cached->world);
+			}
+			result.cache.insert(key, *cached);
+			continue;
+		}
+
 		World w(entry);
 		if(w.isValid())
 		{
-			newWorlds.append(w);
+			result.worlds.append(w);
 		}
+		result.cache.insert(key, CachedWorld{stamp, w});
 	}
+	return result;
+}
+
+bool WorldList::update()
+{
+	if (!isValid())
+		return false;
+
+	if (m_scanFuture.isRunning())
+	{
+		// the running scan may have missed something, go again once it's done
+		m_scanPending = true;
+		return true;
+	}
+	m_scanFuture = QtConcurrent::run(&WorldList::scan, m_dir, m_cache);
+	m_scanWatcher.setFuture(m_scanFuture);
+	return true;
+}
+
+void WorldList::scanFinished()
+{
+	auto result = m_scanFuture.result();
+	m_cache = result.cache;
+	applyScan(result.worlds);
+	if (m_scanPending)
+	{
+		m_scanPending = false;
+		update();
+	}
+	if (m_computeSizes)
+	{
+		startSizeScan();
+	}
+}
+
+void WorldList::applyScan(const QList<World> &newWorlds)
+{
+	QSet<QString> newKeys;
+	for (auto &world : newWorlds)
+	{
+		newKeys.insert(worldKey(world));
+	}
+
+	// remove what's gone, one contiguous range at a time
+	for (int last = worlds.size() - 1; last >= 0; last--)
+	{
+		if (newKeys.contains(worldKey(worlds[last])))
+			continue;
+		int first = last;
+		while (first > 0 && !newKeys.contains(worldKey(worlds[first - 1])))
+		{
+			first--;
+		}
+		beginRemoveRows(QModelIndex(), first, last);
+		for (int i = first; i <= last; i++)
+		{
+			m_sizes.remove(worldKey(worlds[i]));
+		}
+		worlds.erase(worlds.begin() + first, worlds.begin() + last + 1);
+		endRemoveRows();
+		last = first;
+	}
+
+	// the remaining worlds have to be in the same order as in the new list, or merging makes no sense
+	{
+		QSet<QString> oldKeys;
+		for (auto &world : worlds)
+		{
+			oldKeys.insert(worldKey(world));
+		}
+		int i = 0;
+		bool sameOrder = true;
+		for (auto &world : newWorlds)
+		{
+			if (!oldKeys.contains(worldKey(world)))
+				continue;
+			if (worldKey(worlds[i++]) != worldKey(world))
+			{
+				sameOrder = false;
+				break;
+			}
+		}
+		if (!sameOrder)
+		{
+			beginResetModel();
+			worlds = newWorlds;
+			m_sizes.clear();
+			endResetModel();
+			return;
+		}
+	}
+
+	// insert new worlds and update the ones that changed
+	int row = 0;
+	for (auto &world : newWorlds)
+	{
+		if (row < worlds.size() && worldKey(worlds[row]) == worldKey(world))
+		{
+			auto &current = worlds[row];
+			if (current.name() != world.name() || current.lastPlayed() != world.lastPlayed() ||
+				current.seed() != world.seed())
+			{
+				current = world;
+				m_sizes.remove(worldKey(world));
+				emit dataChanged(index(row, 0), index(row, columnCount(QModelIndex()) - 1));
+			}
+		}
+		else
+		{
+			beginInsertRows(QModelIndex(), row, row);
+			worlds.insert(row, world);
+			endInsertRows();
+		}
+		row++;
+	}
+}
+
+void WorldList::setComputeSizes(bool compute)
+{
+	if (m_computeSizes == compute)
+		return;
 	beginResetModel();
-	worlds.swap(newWorlds);
+	m_computeSizes = compute;
 	endResetModel();
-	return true;
+	if (m_computeSizes)
+	{
+		startSizeScan();
+	}
+}
+
+static qint64 sizeOnDisk(const QString &path)
+{
+	QFileInfo info(path);
+	if (!info.isDir())
+	{
+		return info.size();
+	}
+	qint64 total = 0;
+	QDirIterator iter(path, QDir::Files | QDir::Hidden | QDir::System | QDir::NoSymLinks, QDirIterator::Subdirectories);
+	while (iter.hasNext())
+	{
+		iter.next();
+		total += iter.fileInfo().size();
+	}
+	return total;
+}
+
+void WorldList::startSizeScan()
+{
+	if (m_sizeFuture.isRunning())
+	{
+		m_sizeScanPending = true;
+		return;
+	}
+	QStringList paths;
+	for (auto &world : worlds)
+	{
+		auto key = worldKey(world);
+		if (!m_sizes.contains(key))
+		{
+			paths.append(key);
+		}
+	}
+	if (paths.isEmpty())
+		return;
+	m_sizeFuture = QtConcurrent::run([paths]()
+	{
+		QHash<QString, qint64> sizes;
+		for (auto &path : paths)
+		{
+			sizes.insert(path, sizeOnDisk(path));
+		}
+		return sizes;
+	});
+	m_sizeWatcher.setFuture(m_sizeFuture);
+}
+
+void WorldList::sizeScanFinished()
+{
+	auto sizes = m_sizeFuture.result();
+	for (int row = 0; row < worlds.size(); row++)
+	{
+		auto key = worldKey(worlds[row]);
+		auto found = sizes.find(key);
+		if (found == sizes.end())
+			continue;
+		m_sizes.insert(key, *found);
+		emit dataChanged(index(row, SizeColumn), index(row, SizeColumn));
+	}
+	if (m_sizeScanPending)
+	{
+		m_sizeScanPending = false;
+		startSizeScan();
+	}
 }
 
 void WorldList::directoryChanged(QString path)
@@ -138,7 +360,20 @@ bool WorldList::deleteWorlds(int first, int last)
 
 int WorldList::columnCount(const QModelIndex &parent) const
 {
-	return 2;
+	return m_computeSizes ? 3 : 2;
+}
+
+static QString formatSize(qint64 bytes)
+{
+	const char *units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+	double size = bytes;
+	int unit = 0;
+	while (size >= 1024.0 && unit < 4)
+	{
+		size /= 1024.0;
+		unit++;
+	}
+	return QString("%1 %2").arg(size, 0, 'f', unit ? 1 : 0).arg(units[unit]);
 }
 
 QVariant WorldList::data(const QModelIndex &index, int role) const
@@ -164,6 +399,28 @@ QVariant WorldList::data(const QModelIndex &index, int role) const
 		case LastPlayedColumn:
 			return world.lastPlayed();
 
+		case SizeColumn:
+		{
+			auto found = m_sizes.find(worldKey(world));
+			return found == m_sizes.end() ? tr("Calculating...") : formatSize(*found);
+		}
+
+		default:
+			return QVariant();
+		}
+
+	case SortRole:
+		switch (column)
+		{
+		case NameColumn:
+			return world.name();
+
+		case LastPlayedColumn:
+			return world.lastPlayed();
+
+		case SizeColumn:
+			return m_sizes.value(worldKey(world), -1);
+
 		default:
 			return QVariant();
 		}
@@ -192,6 +449,13 @@ QVariant WorldList::data(const QModelIndex &index, int role) const
 	{
 		return world.lastPlayed();
 	}
+	case SizeRole:
+	{
+		auto found = m_sizes.find(worldKey(world));
+		if (found == m_sizes.end())
+			return QVariant();
+		return qVariantFromValue<qlonglong>(*found);
+	}
 	default:
 		return QVariant();
 	}
@@ -208,6 +472,8 @@ QVariant WorldList::headerData(int section, Qt::Orientation orientation, int rol
 			return tr("Name");
 		case LastPlayedColumn:
 			return tr("Last Played");
+		case SizeColumn:
+			return tr("Size");
 		default:
 			return QVariant();
 		}
@@ -219,6 +485,8 @@ QVariant WorldList::headerData(int section, Qt::Orientation orientation, int rol
 			return tr("The name of the world.");
 		case LastPlayedColumn:
 			return tr("Date and time the world was last played.");
+		case SizeColumn:
+			return tr("How much space the world takes on disk.");
 		default:
 			return QVariant();
 		}
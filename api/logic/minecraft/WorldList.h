@@ -20,6 +20,9 @@
 #include <QDir>
 #include <QAbstractListModel>
 #include <QMimeData>
+#include <QHash>
+#include <QFuture>
+#include <QFutureWatcher>
 #include "minecraft/World.h"
 
 #include "multimc_logic_export.h"
@@ -33,7 +36,8 @@ public:
 	enum Columns
 	{
 		NameColumn,
-		LastPlayedColumn
+		LastPlayedColumn,
+		SizeColumn
 	};
 
 	enum Roles
@@ -42,7 +46,9 @@ public:
 		FolderRole,
 		SeedRole,
 		NameRole,
-		LastPlayedRole
+		LastPlayedRole,
+		SizeRole,
+		SortRole
 	};
 
 	WorldList(const QString &dir);
@@ -70,9 +76,12 @@ public:
 		return worlds[index];
 	}
 
-	/// Reloads the mod list and returns true if the list changed.
+	/// Starts reloading the world list in the background. Returns false if the folder isn't usable.
 	virtual bool update();
 
+	/// Also work out how much space each world takes on disk, in the background. Adds a size column.
+	void setComputeSizes(bool compute);
+
 	/// Install a world from location
 	void installWorld(QFileInfo filename);
 
@@ -113,13 +122,46 @@ public:
 
 private slots:
 	void directoryChanged(QString path);
+	void scanFinished();
+	void sizeScanFinished();
 
 signals:
 	void changed();
 
+private: /* types */
+	// a parsed world, valid as long as the stamp (level.dat or zip mtime) is the same
+	struct CachedWorld
+	{
+		qint64 stamp;
+		World world;
+	};
+	typedef QHash<QString, CachedWorld> WorldCache;
+	struct ScanResult
+	{
+		QList<World> worlds;
+		WorldCache cache;
+	};
+
+private:
+	static ScanResult scan(QDir dir, WorldCache cache);
+	void applyScan(const QList<World> &newWorlds);
+	void startSizeScan();
+
 protected:
 	QFileSystemWatcher *m_watcher;
 	bool is_watching;
 	QDir m_dir;
 	QList<World> worlds;
+
+private:
+	WorldCache m_cache;
+	QFuture<ScanResult> m_scanFuture;
+	QFutureWatcher<ScanResult> m_scanWatcher;
+	bool m_scanPending = false;
+
+	bool m_computeSizes = false;
+	QHash<QString, qint64> m_sizes;
+	QFuture<QHash<QString, qint64>> m_sizeFuture;
+	QFutureWatcher<QHash<QString, qint64>> m_sizeWatcher;
+	bool m_sizeScanPending = false;
 };
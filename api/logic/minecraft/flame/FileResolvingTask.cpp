@@ -1,73 +1,224 @@
 #include "FileResolvingTask.h"
 #include "Json.h"
+#include "Env.h"
+#include "FileSystem.h"
+
+#include <QFile>
 
 const char * metabase = "https://cursemeta.dries007.net";
 
-Flame::FileResolvingTask::FileResolvingTask(Flame::Manifest& toProcess)
-	: m_toProcess(toProcess)
+// how many mod files are fetched at the same time
+static const int maxConcurrentDownloads = 6;
+
+Flame::FileResolvingTask::FileResolvingTask(Flame::Manifest& toProcess, const QString &targetFolder)
+	: m_toProcess(toProcess), m_targetFolder(targetFolder), m_resolverBase(metabase)
+{
+}
+
+void Flame::FileResolvingTask::setResolverBase(const QString& base)
 {
+	m_resolverBase = base;
 }
 
 void Flame::FileResolvingTask::executeTask()
 {
-	setStatus(tr("Resolving mod IDs..."));
-	setProgress(0, m_toProcess.files.size());
+	setStatus(m_targetFolder.isEmpty() ? tr("Resolving mod IDs...") : tr("Downloading mods..."));
+	auto count = m_toProcess.files.size();
+	m_metaEntries.resize(count);
+	m_fileEntries.resize(count);
+	m_fileJobs.resize(count);
+	updateProgress();
 	m_dljob.reset(new NetJob("Mod id resolver"));
-	results.resize(m_toProcess.files.size());
 	int index = 0;
 	for(auto & file: m_toProcess.files)
 	{
 		auto projectIdStr = QString::number(file.projectId);
 		auto fileIdStr = QString::number(file.fileId);
-		QString metaurl = QString("%1/%2/%3.json").arg(metabase, projectIdStr, fileIdStr);
-		auto dl = Net::Download::makeByteArray(QUrl(metaurl), &results[index]);
+		QString metaurl = QString("%1/%2/%3.json").arg(m_resolverBase, projectIdStr, fileIdStr);
+		// file IDs are immutable, anything we have in the cache is still valid
+		auto entry = ENV.metacache()->resolveEntry("flame", QString("meta/%1/%2.json").arg(projectIdStr, fileIdStr));
+		m_metaEntries[index] = entry;
+		auto dl = Net::Download::makeCached(QUrl(metaurl), entry);
+		connect(dl.get(), &NetAction::succeeded, this, &Flame::FileResolvingTask::fileResolved);
 		m_dljob->addNetAction(dl);
 		index ++;
 	}
-	connect(m_dljob.get(), &NetJob::finished, this, &Flame::FileResolvingTask::netJobFinished);
+	connect(m_dljob.get(), &NetJob::succeeded, this, &Flame::FileResolvingTask::resolveSucceeded);
+	connect(m_dljob.get(), &NetJob::failed, this, [&](QString reason)
+	{
+		fail(tr("Some mod ID resolving tasks failed:\n%1").arg(reason));
+	});
 	m_dljob->start();
 }
 
-void Flame::FileResolvingTask::netJobFinished()
+void Flame::FileResolvingTask::fileResolved(int index)
 {
-	bool failed = false;
-	int index = 0;
-	for(auto & bytes: results)
+	if(m_done)
 	{
-		try
-		{
-			auto doc = Json::requireDocument(bytes);
-			auto obj = Json::requireObject(doc);
-			auto & out = m_toProcess.files[index];
-			// result code signifies true failure.
-			if(obj.contains("code"))
-			{
-				qCritical() << "Resolving of" << out.projectId << out.fileId << "failed because of a negative result:";
-				qCritical() << bytes;
-				failed = true;
-				continue;
-			}
-			out.fileName = Json::requireString(obj, "FileNameOnDisk");
-			out.url = Json::requireString(obj, "DownloadURL");
-			out.resolved = true;
-		}
-		catch(JSONValidationError & e)
+		return;
+	}
+	auto & out = m_toProcess.files[index];
+	auto entry = m_metaEntries[index];
+	QByteArray bytes;
+	try
+	{
+		bytes = FS::read(entry->getFullPath());
+		auto doc = Json::requireDocument(bytes);
+		auto obj = Json::requireObject(doc);
+		// result code signifies true failure.
+		if(obj.contains("code"))
 		{
-			auto & out = m_toProcess.files[index];
-			qCritical() << "Resolving of" << out.projectId << out.fileId << "failed because of a parsing error:";
-			qCritical() << e.cause();
-			qCritical() << "JSON:";
+			qCritical() << "Resolving of" << out.projectId << out.fileId << "failed because of a negative result:";
 			qCritical() << bytes;
-			failed = true;
+			ENV.metacache()->evictEntry(entry);
+			fail(tr("Mod %1 (file %2) could not be resolved.").arg(out.projectId).arg(out.fileId));
+			return;
 		}
-		index++;
+		// the name ends up in paths, do not let it escape the target folder
+		out.fileName = FS::RemoveInvalidFilenameChars(Json::requireString(obj, "FileNameOnDisk"));
+		out.url = Json::requireString(obj, "DownloadURL");
+		out.resolved = true;
+	}
+	catch(Exception & e)
+	{
+		qCritical() << "Resolving of" << out.projectId << out.fileId << "failed because of a parsing error:";
+		qCritical() << e.cause();
+		qCritical() << "JSON:";
+		qCritical() << bytes;
+		ENV.metacache()->evictEntry(entry);
+		fail(tr("Mod %1 (file %2) could not be resolved.").arg(out.projectId).arg(out.fileId));
+		return;
 	}
-	if(!failed)
+	m_resolved++;
+	if(!m_targetFolder.isEmpty())
 	{
-		emitSucceeded();
+		m_downloadQueue.enqueue(index);
+		startMoreDownloads();
+	}
+	updateProgress();
+}
+
+void Flame::FileResolvingTask::resolveSucceeded()
+{
+	m_resolveDone = true;
+	checkFinished();
+}
+
+void Flame::FileResolvingTask::startMoreDownloads()
+{
+	while(!m_done && m_downloadsRunning < maxConcurrentDownloads && !m_downloadQueue.isEmpty())
+	{
+		int index = m_downloadQueue.dequeue();
+		auto & file = m_toProcess.files[index];
+		auto entry = ENV.metacache()->resolveEntry("flame", QString("files/%1/%2/%3").arg(file.projectId).arg(file.fileId).arg(file.fileName));
+		m_fileEntries[index] = entry;
+
+		NetJobPtr job(new NetJob(tr("Mod download: %1").arg(file.fileName)));
+		job->addNetAction(Net::Download::makeCached(QUrl(file.url), entry));
+		connect(job.get(), &NetJob::succeeded, this, [this, index]()
+		{
+			downloadSucceeded(index);
+		});
+		connect(job.get(), &NetJob::failed, this, [this](QString reason)
+		{
+			fail(reason);
+		});
+		m_fileJobs[index] = job;
+		m_downloadsRunning++;
+		job->start();
+	}
+}
+
+void Flame::FileResolvingTask::downloadSucceeded(int index)
+{
+	m_downloadsRunning--;
+	if(m_done)
+	{
+		return;
+	}
+	auto & file = m_toProcess.files[index];
+	auto target = FS::PathCombine(m_targetFolder, file.fileName);
+	FS::ensureFilePathExists(target);
+	QFile::remove(target);
+	if(!QFile::copy(m_fileEntries[index]->getFullPath(), target))
+	{
+		fail(tr("Unable to copy %1 into the instance.").arg(file.fileName));
+		return;
+	}
+	m_downloaded++;
+	updateProgress();
+	startMoreDownloads();
+	checkFinished();
+}
+
+void Flame::FileResolvingTask::updateProgress()
+{
+	auto count = m_toProcess.files.size();
+	if(m_targetFolder.isEmpty())
+	{
+		setProgress(m_resolved, count);
 	}
 	else
 	{
-		emitFailed(tr("Some mod ID resolving tasks failed."));
+		setProgress(m_resolved + m_downloaded, count * 2);
+	}
+}
+
+void Flame::FileResolvingTask::checkFinished()
+{
+	if(m_done || !m_resolveDone)
+	{
+		return;
+	}
+	if(!m_targetFolder.isEmpty() && m_downloaded != m_toProcess.files.size())
+	{
+		return;
+	}
+	m_done = true;
+	emitSucceeded();
+}
+
+void Flame::FileResolvingTask::fail(const QString& reason)
+{
+	if(m_done)
+	{
+		return;
+	}
+	stop();
+	emitFailed(reason);
+}
+
+void Flame::FileResolvingTask::stop()
+{
+	m_done = true;
+	m_downloadQueue.clear();
+	if(m_dljob)
+	{
+		disconnect(m_dljob.get(), nullptr, this, nullptr);
+		m_dljob->abort();
+	}
+	for(auto job: m_fileJobs)
+	{
+		if(job)
+		{
+			disconnect(job.get(), nullptr, this, nullptr);
+			job->abort();
+		}
+	}
+}
+
+bool Flame::FileResolvingTask::canAbort() const
+{
+	return true;
+}
+
+bool Flame::FileResolvingTask::abort()
+{
+	if(m_done)
+	{
+		return false;
 	}
+	stop();
+	emitAborted();
+	return true;
 }
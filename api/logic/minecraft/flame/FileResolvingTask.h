@@ -4,29 +4,67 @@
 #include "net/NetJob.h"
 #include "PackManifest.h"
 
+#include <QQueue>
+
 #include "multimc_logic_export.h"
 
 namespace Flame
 {
+/**
+ * Resolves the project/file IDs of a manifest into file names and download URLs.
+ *
+ * Resolution results are kept in the metacache - file IDs never change, so a pack that was
+ * resolved once is resolved again without touching the network.
+ *
+ * When given a target folder, each file is downloaded as soon as its ID resolves. The files
+ * go through a content cache shared by all imports and are then copied into the target folder.
+ */
 class MULTIMC_LOGIC_EXPORT FileResolvingTask : public Task
 {
 	Q_OBJECT
 public:
-	explicit FileResolvingTask(Flame::Manifest &toProcess);
+	explicit FileResolvingTask(Flame::Manifest &toProcess, const QString &targetFolder = QString());
 	const Flame::Manifest &getResults() const
 	{
 		return m_toProcess;
 	}
 
+	/// Use a different resolver endpoint. Expects '<base>/<projectId>/<fileId>.json' to exist.
+	void setResolverBase(const QString &base);
+
+	bool canAbort() const override;
+
+public slots:
+	bool abort() override;
+
 protected:
 	virtual void executeTask() override;
 
-protected slots:
-	void netJobFinished();
+private slots:
+	void fileResolved(int index);
+	void resolveSucceeded();
+	void downloadSucceeded(int index);
+
+private:
+	void startMoreDownloads();
+	void updateProgress();
+	void checkFinished();
+	void fail(const QString &reason);
+	void stop();
 
 private: /* data */
 	Flame::Manifest m_toProcess;
-	QVector<QByteArray> results;
+	QString m_targetFolder;
+	QString m_resolverBase;
+	QVector<MetaEntryPtr> m_metaEntries;
+	QVector<MetaEntryPtr> m_fileEntries;
 	NetJobPtr m_dljob;
+	QVector<NetJobPtr> m_fileJobs;
+	QQueue<int> m_downloadQueue;
+	int m_downloadsRunning = 0;
+	int m_resolved = 0;
+	int m_downloaded = 0;
+	bool m_resolveDone = false;
+	bool m_done = false;
 };
 }
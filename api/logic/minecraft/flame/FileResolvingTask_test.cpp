@@ -0,0 +1,103 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "minecraft/flame/FileResolvingTask.h"
+#include "net/HttpMetaCache.h"
+#include "Env.h"
+#include "FileSystem.h"
+
+class FileResolvingTaskTest : public QObject
+{
+	Q_OBJECT
+private:
+	// the resolver and CDN are stood in for by the test data folder
+	QString dataUrl(const QString &path)
+	{
+		return QUrl::fromLocalFile(FS::PathCombine(QDir::currentPath(), "data", path)).toString(QUrl::FullyEncoded);
+	}
+	Flame::Manifest makeManifest(std::initializer_list<std::pair<int, int>> ids)
+	{
+		Flame::Manifest manifest;
+		for(auto &id: ids)
+		{
+			Flame::File file;
+			file.projectId = id.first;
+			file.fileId = id.second;
+			manifest.files.append(file);
+		}
+		return manifest;
+	}
+	void runTask(Flame::FileResolvingTask &task)
+	{
+		task.start();
+		QTRY_VERIFY_WITH_TIMEOUT(task.isFinished(), 10000);
+	}
+private
+slots:
+	void initTestCase()
+	{
+		QDir("cache/flame").removeRecursively();
+		ENV.initHttpMetaCache();
+	}
+	void cleanupTestCase()
+	{
+		QDir("test_mods").removeRecursively();
+		QDir("test_mods_cached").removeRecursively();
+		QDir("cache/flame").removeRecursively();
+	}
+
+	void test_ResolveAndDownload()
+	{
+		auto manifest = makeManifest({{1, 10}, {2, 20}});
+		Flame::FileResolvingTask task(manifest, "test_mods");
+		task.setResolverBase(dataUrl("flame/resolver"));
+		runTask(task);
+		QVERIFY(task.wasSuccessful());
+
+		auto results = task.getResults();
+		QCOMPARE(results.files[0].fileName, QString("first-mod-1.0.jar"));
+		QCOMPARE(results.files[1].fileName, QString("second-mod-2.3.jar"));
+		QVERIFY(results.files[0].resolved);
+		QVERIFY(results.files[1].resolved);
+		QCOMPARE(FS::read("test_mods/first-mod-1.0.jar"), QByteArray("first mod\n"));
+		QCOMPARE(FS::read("test_mods/second-mod-2.3.jar"), QByteArray("second mod\n"));
+	}
+
+	void test_CacheHit()
+	{
+		// the endpoints are gone, everything has to come from the caches
+		auto manifest = makeManifest({{1, 10}, {2, 20}});
+		Flame::FileResolvingTask task(manifest, "test_mods_cached");
+		task.setResolverBase(dataUrl("flame/nonexistent"));
+		runTask(task);
+		QVERIFY(task.wasSuccessful());
+		QCOMPARE(FS::read("test_mods_cached/first-mod-1.0.jar"), QByteArray("first mod\n"));
+		QCOMPARE(FS::read("test_mods_cached/second-mod-2.3.jar"), QByteArray("second mod\n"));
+	}
+
+	void test_ResolveOnly()
+	{
+		auto manifest = makeManifest({{2, 20}});
+		Flame::FileResolvingTask task(manifest);
+		task.setResolverBase(dataUrl("flame/resolver"));
+		runTask(task);
+		QVERIFY(task.wasSuccessful());
+		QCOMPARE(task.getResults().files[0].url, dataUrl("flame/cdn/second-mod-2.3.jar"));
+	}
+
+	void test_NegativeResult()
+	{
+		auto manifest = makeManifest({{1, 10}, {3, 30}});
+		Flame::FileResolvingTask task(manifest, "test_mods");
+		task.setResolverBase(dataUrl("flame/resolver"));
+		runTask(task);
+		QVERIFY(task.isFinished());
+		QVERIFY(!task.wasSuccessful());
+		// negative results are not remembered
+		QVERIFY(!ENV.metacache()->getEntry("flame", "meta/3/30.json"));
+	}
+};
+
+QTEST_GUILESS_MAIN(FileResolvingTaskTest)
+
+#include "FileResolvingTask_test.moc"
@@ -161,8 +161,8 @@ void ForgeXzDownload::downloadReadyRead()
 
 #include "xz.h"
 #include "unpack200.h"
+#include <QSaveFile>
 #include <stdexcept>
-#include <unistd.h>
 
 const size_t buffer_size = 8196;
 
@@ -171,203 +171,139 @@ void ForgeXzDownload::decompressAndInstall()
 {
 	// rewind the downloaded temp file
 	m_pack200_xz_file.seek(0);
-	// de-xz'd file
-	QTemporaryFile pack200_file("./dl_temp.XXXXXX");
-	pack200_file.open();
 
-	bool xz_success = false;
-	// first, de-xz
+	xz_crc32_init();
+	xz_crc64_init();
+	struct xz_dec *s = xz_dec_init(XZ_DYNALLOC, 1 << 26);
+	if (s == nullptr)
 	{
-		uint8_t in[buffer_size];
-		uint8_t out[buffer_size];
-		struct xz_buf b;
-		struct xz_dec *s;
-		enum xz_ret ret;
-		xz_crc32_init();
-		xz_crc64_init();
-		s = xz_dec_init(XZ_DYNALLOC, 1 << 26);
-		if (s == nullptr)
+		failAndTryNextMirror();
+		return;
+	}
+
+	// the xz decoder feeds the pack200 unpacker directly, there is no intermediate file
+	uint8_t in[buffer_size];
+	struct xz_buf b;
+	b.in = in;
+	b.in_pos = 0;
+	b.in_size = 0;
+	bool xz_finished = false;
+	QString xz_error;
+	auto reader = [&](void *buf, int64_t maxlen) -> int64_t
+	{
+		if (xz_finished || !xz_error.isEmpty())
 		{
-			xz_dec_end(s);
-			failAndTryNextMirror();
-			return;
+			return 0;
 		}
-		b.in = in;
-		b.in_pos = 0;
-		b.in_size = 0;
-		b.out = out;
+		b.out = (uint8_t *)buf;
 		b.out_pos = 0;
-		b.out_size = buffer_size;
-		while (!xz_success)
+		b.out_size = maxlen;
+		while (b.out_pos == 0)
 		{
 			if (b.in_pos == b.in_size)
 			{
-				b.in_size = m_pack200_xz_file.read((char *)in, sizeof(in));
+				auto got = m_pack200_xz_file.read((char *)in, sizeof(in));
+				b.in_size = got < 0 ? 0 : got;
 				b.in_pos = 0;
 			}
 
-			ret = xz_dec_run(s, &b);
-
-			if (b.out_pos == sizeof(out))
-			{
-				auto wresult = pack200_file.write((char *)out, b.out_pos);
-				if (wresult < 0 || size_t(wresult) != b.out_pos)
-				{
-					// msg = "Write error\n";
-					xz_dec_end(s);
-					failAndTryNextMirror();
-					return;
-				}
-
-				b.out_pos = 0;
-			}
-
-			if (ret == XZ_OK)
-				continue;
-
-			if (ret == XZ_UNSUPPORTED_CHECK)
-			{
-				// unsupported check. this is OK, but we should log this
-				continue;
-			}
-
-			auto wresult = pack200_file.write((char *)out, b.out_pos);
-			if (wresult < 0 || size_t(wresult) != b.out_pos)
-			{
-				// write error
-				pack200_file.close();
-				xz_dec_end(s);
-				return;
-			}
-
+			auto ret = xz_dec_run(s, &b);
 			switch (ret)
 			{
+			case XZ_OK:
+			// unsupported check. this is OK, but we should log this
+			case XZ_UNSUPPORTED_CHECK:
+				continue;
 			case XZ_STREAM_END:
-				xz_dec_end(s);
-				xz_success = true;
-				break;
-
+				xz_finished = true;
+				return b.out_pos;
 			case XZ_MEM_ERROR:
-				qCritical() << "Memory allocation failed\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
+				xz_error = "Memory allocation failed";
+				return 0;
 			case XZ_MEMLIMIT_ERROR:
-				qCritical() << "Memory usage limit reached\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
+				xz_error = "Memory usage limit reached";
+				return 0;
 			case XZ_FORMAT_ERROR:
-				qCritical() << "Not a .xz file\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
+				xz_error = "Not a .xz file";
+				return 0;
 			case XZ_OPTIONS_ERROR:
-				qCritical() << "Unsupported options in the .xz headers\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
+				xz_error = "Unsupported options in the .xz headers";
+				return 0;
 			case XZ_DATA_ERROR:
 			case XZ_BUF_ERROR:
-				qCritical() << "File is corrupt\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
+				xz_error = "File is corrupt";
+				return 0;
 			default:
-				qCritical() << "Bug!\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
+				xz_error = "Bug!";
+				return 0;
 			}
 		}
-	}
-	m_pack200_xz_file.remove();
+		return b.out_pos;
+	};
 
-	// revert pack200
-	pack200_file.seek(0);
-	int handle_in = pack200_file.handle();
-	// FIXME: dispose of file handles, pointers and the like. Ideally wrap in objects.
-	if(handle_in == -1)
+	// the jar is hashed while it is written, so it doesn't have to be read back
+	QSaveFile jar_file(m_target_path);
+	if (!jar_file.open(QIODevice::WriteOnly))
 	{
-		qCritical() << "Error reopening " << pack200_file.fileName();
+		qCritical() << "Error opening " << jar_file.fileName();
+		xz_dec_end(s);
 		failAndTryNextMirror();
 		return;
 	}
-	int handle_in_dup = dup (handle_in);
-	if(handle_in_dup == -1)
+	QCryptographicHash md5(QCryptographicHash::Md5);
+	auto writer = [&](const void *buf, size_t len)
 	{
-		qCritical() << "Error reopening " << pack200_file.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	FILE *file_in = fdopen (handle_in_dup, "rb");
-	if(!file_in)
-	{
-		qCritical() << "Error reopening " << pack200_file.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	QFile qfile_out(m_target_path);
-	if(!qfile_out.open(QIODevice::WriteOnly))
-	{
-		qCritical() << "Error opening " << qfile_out.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	int handle_out = qfile_out.handle();
-	if(handle_out == -1)
-	{
-		qCritical() << "Error opening " << qfile_out.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	int handle_out_dup = dup (handle_out);
-	if(handle_out_dup == -1)
+		md5.addData((const char *)buf, len);
+		return jar_file.write((const char *)buf, len) == qint64(len);
+	};
+
+	// these libraries are only ever loaded from the local disk, compressing them again is wasted time
+	unpack_200_options options;
+	options.compression = UNPACK_200_STORE;
+	try
 	{
-		qCritical() << "Error reopening " << qfile_out.fileName();
-		failAndTryNextMirror();
-		return;
+		unpack_200(reader, writer, options);
 	}
-	FILE *file_out = fdopen (handle_out_dup, "wb");
-	if(!file_out)
+	catch (std::runtime_error &err)
 	{
-		qCritical() << "Error opening " << qfile_out.fileName();
+		xz_dec_end(s);
+		m_status = Job_Failed;
+		if (!xz_error.isEmpty())
+		{
+			qCritical() << "Error decompressing " << m_pack200_xz_file.fileName() << " : " << xz_error;
+		}
+		qCritical() << "Error unpacking " << m_pack200_xz_file.fileName() << " : " << err.what();
+		jar_file.cancelWriting();
 		failAndTryNextMirror();
 		return;
 	}
-	try
+
+	// the unpacker can stop before the end of the xz stream, the rest still has to pass the xz checks
 	{
-		// NOTE: this takes ownership of both FILE pointers. That's why we duplicate them above.
-		unpack_200(file_in, file_out);
+		uint8_t rest[buffer_size];
+		while (reader(rest, sizeof(rest)) > 0)
+		{
+		}
 	}
-	catch (std::runtime_error &err)
+	xz_dec_end(s);
+	if (!xz_finished || !xz_error.isEmpty())
 	{
 		m_status = Job_Failed;
-		qCritical() << "Error unpacking " << pack200_file.fileName() << " : " << err.what();
-		QFile f(m_target_path);
-		if (f.exists())
-			f.remove();
+		qCritical() << "Error decompressing " << m_pack200_xz_file.fileName() << " : "
+					<< (xz_error.isEmpty() ? QString("Unexpected end of file") : xz_error);
+		jar_file.cancelWriting();
 		failAndTryNextMirror();
 		return;
 	}
-	pack200_file.remove();
-
-	QFile jar_file(m_target_path);
+	m_pack200_xz_file.remove();
 
-	if (!jar_file.open(QIODevice::ReadOnly))
+	if (!jar_file.commit())
 	{
-		jar_file.remove();
+		qCritical() << "Error writing " << m_target_path;
 		failAndTryNextMirror();
 		return;
 	}
-	auto hash = QCryptographicHash::hash(jar_file.readAll(), QCryptographicHash::Md5);
-	m_entry->setMD5Sum(hash.toHex().constData());
-	jar_file.close();
+	m_entry->setMD5Sum(md5.result().toHex().constData());
 
 	QFileInfo output_file_info(m_target_path);
 	m_entry->setETag(m_reply->rawHeader("ETag").constData());
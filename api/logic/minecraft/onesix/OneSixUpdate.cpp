@@ -37,14 +37,14 @@
 #include <meta/Index.h>
 #include <meta/Version.h>
 
-OneSixUpdate::OneSixUpdate(OneSixInstance *inst, QObject *parent) : Task(parent), m_inst(inst)
+OneSixUpdate::OneSixUpdate(OneSixInstance *inst, QObject *parent) : TaskGraph(parent), m_inst(inst)
 {
 	// create folders
-	{
-		m_tasks.append(std::make_shared<FoldersTask>(m_inst));
-	}
+	auto folders = std::make_shared<FoldersTask>(m_inst);
+	addTask(folders);
 
-	// add metadata update tasks, if necessary
+	// add metadata update tasks, if necessary. They do not depend on each other.
+	QList<std::shared_ptr<Task>> metaTasks;
 	{
 		/*
 		 * FIXME: there are some corner cases here that remain unhandled:
@@ -66,7 +66,11 @@ OneSixUpdate::OneSixUpdate(OneSixInstance *inst, QObject *parent) : Task(parent)
 				if(task)
 				{
 					qDebug() << "Loading remote meta patch" << id;
-					m_tasks.append(task.unwrap());
+					auto unwrapped = task.unwrap();
+					if(addTask(unwrapped))
+					{
+						metaTasks.append(unwrapped);
+					}
 				}
 			}
 			else
@@ -76,128 +80,13 @@ OneSixUpdate::OneSixUpdate(OneSixInstance *inst, QObject *parent) : Task(parent)
 		}
 	}
 
-	// libraries download
-	{
-		m_tasks.append(std::make_shared<LibrariesTask>(m_inst));
-	}
+	// libraries download. This reloads the profile, which is why it is added before the assets.
+	auto libraries = std::make_shared<LibrariesTask>(m_inst);
+	addTask(libraries, metaTasks, 10);
 
 	// FML libraries download and copy into the instance
-	{
-		m_tasks.append(std::make_shared<FMLLibrariesTask>(m_inst));
-	}
-
-	// assets update
-	{
-		m_tasks.append(std::make_shared<AssetUpdateTask>(m_inst));
-	}
-}
+	addTask(std::make_shared<FMLLibrariesTask>(m_inst), {folders, libraries}, 2);
 
-void OneSixUpdate::executeTask()
-{
-	if(!m_preFailure.isEmpty())
-	{
-		emitFailed(m_preFailure);
-		return;
-	}
-	next();
-}
-
-void OneSixUpdate::next()
-{
-	if(m_abort)
-	{
-		emitFailed(tr("Aborted by user."));
-		return;
-	}
-	if(m_failed_out_of_order)
-	{
-		emitFailed(m_fail_reason);
-		return;
-	}
-	m_currentTask ++;
-	if(m_currentTask > 0)
-	{
-		auto task = m_tasks[m_currentTask - 1];
-		disconnect(task.get(), &Task::succeeded, this, &OneSixUpdate::subtaskSucceeded);
-		disconnect(task.get(), &Task::failed, this, &OneSixUpdate::subtaskFailed);
-		disconnect(task.get(), &Task::progress, this, &OneSixUpdate::progress);
-		disconnect(task.get(), &Task::status, this, &OneSixUpdate::setStatus);
-	}
-	if(m_currentTask == m_tasks.size())
-	{
-		emitSucceeded();
-		return;
-	}
-	auto task = m_tasks[m_currentTask];
-	// if the task is already finished by the time we look at it, skip it
-	if(task->isFinished())
-	{
-		qCritical() << "OneSixUpdate: Skipping finished subtask" << m_currentTask << ":" << task.get();
-		next();
-	}
-	connect(task.get(), &Task::succeeded, this, &OneSixUpdate::subtaskSucceeded);
-	connect(task.get(), &Task::failed, this, &OneSixUpdate::subtaskFailed);
-	connect(task.get(), &Task::progress, this, &OneSixUpdate::progress);
-	connect(task.get(), &Task::status, this, &OneSixUpdate::setStatus);
-	// if the task is already running, do not start it again
-	if(!task->isRunning())
-	{
-		task->start();
-	}
-}
-
-void OneSixUpdate::subtaskSucceeded()
-{
-	if(isFinished())
-	{
-		qCritical() << "OneSixUpdate: Subtask" << sender() << "succeeded, but work was already done!";
-		return;
-	}
-	auto senderTask = QObject::sender();
-	auto currentTask = m_tasks[m_currentTask].get();
-	if(senderTask != currentTask)
-	{
-		qDebug() << "OneSixUpdate: Subtask" << sender() << "succeeded out of order.";
-		return;
-	}
-	next();
-}
-
-void OneSixUpdate::subtaskFailed(QString error)
-{
-	if(isFinished())
-	{
-		qCritical() << "OneSixUpdate: Subtask" << sender() << "failed, but work was already done!";
-		return;
-	}
-	auto senderTask = QObject::sender();
-	auto currentTask = m_tasks[m_currentTask].get();
-	if(senderTask != currentTask)
-	{
-		qDebug() << "OneSixUpdate: Subtask" << sender() << "failed out of order.";
-		m_failed_out_of_order = true;
-		m_fail_reason = error;
-		return;
-	}
-	emitFailed(error);
-}
-
-
-bool OneSixUpdate::abort()
-{
-	if(!m_abort)
-	{
-		m_abort = true;
-		auto task = m_tasks[m_currentTask];
-		if(task->canAbort())
-		{
-			return task->abort();
-		}
-	}
-	return true;
-}
-
-bool OneSixUpdate::canAbort() const
-{
-	return true;
+	// assets update, at the same time as the libraries
+	addTask(std::make_shared<AssetUpdateTask>(m_inst), metaTasks, 10);
 }
@@ -15,41 +15,22 @@
 
 #pragma once
 
-#include <QObject>
-#include <QList>
-#include <QUrl>
+#include "tasks/TaskGraph.h"
 
-#include "net/NetJob.h"
-#include "tasks/Task.h"
-#include "minecraft/VersionFilterData.h"
-#include <quazip.h>
-
-class MinecraftVersion;
 class OneSixInstance;
 
-class OneSixUpdate : public Task
+/**
+ * Brings an instance up to date: folders, meta patches, libraries and assets.
+ *
+ * The steps run as a graph - the library and asset downloads both only need the meta patches,
+ * so they happen at the same time.
+ */
+class OneSixUpdate : public TaskGraph
 {
 	Q_OBJECT
 public:
 	explicit OneSixUpdate(OneSixInstance *inst, QObject *parent = 0);
-	void executeTask() override;
-	bool canAbort() const override;
-
-private
-slots:
-	bool abort() override;
-	void subtaskSucceeded();
-	void subtaskFailed(QString error);
-
-private:
-	void next();
 
 private:
 	OneSixInstance *m_inst = nullptr;
-	QList<std::shared_ptr<Task>> m_tasks;
-	QString m_preFailure;
-	int m_currentTask = -1;
-	bool m_abort = false;
-	bool m_failed_out_of_order = false;
-	QString m_fail_reason;
 };
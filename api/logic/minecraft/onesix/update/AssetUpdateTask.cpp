@@ -18,10 +18,10 @@ void AssetUpdateTask::executeTask()
 	auto job = new NetJob(tr("Asset index for %1").arg(m_inst->name()));
 
 	auto metacache = ENV.metacache();
-	auto entry = metacache->resolveEntry("asset_indexes", localPath);
-	entry->setStale(true);
 	auto hexSha1 = assets->sha1.toLatin1();
 	qDebug() << "Asset index SHA1:" << hexSha1;
+	// with a known SHA-1, a matching index on disk is used without asking the server
+	auto entry = metacache->resolvePinnedEntry("asset_indexes", localPath, assets->sha1);
 	auto dl = Net::Download::makeCached(indexUrl, entry);
 	auto rawSha1 = QByteArray::fromHex(assets->sha1.toLatin1());
 	dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, rawSha1));
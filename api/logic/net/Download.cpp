@@ -74,11 +74,28 @@ void Download::start()
 		emit aborted(m_index_within_job);
 		return;
 	}
+	m_attempts++;
+	if(Metrics::isEnabled())
+	{
+		if(!m_metrics.id)
+		{
+			m_metrics.id = Metrics::nextId();
+			m_metrics.url = m_url.toString();
+			m_metrics.start = Metrics::now();
+		}
+		// like the time to first byte, these are about the last attempt only
+		m_attemptStart = Metrics::now();
+		m_metrics.timeToFirstByte = -1;
+		m_metrics.bytes = 0;
+		m_metrics.sinkTime = 0;
+	}
 	QNetworkRequest request(m_url);
 	m_status = m_sink->init(request);
 	switch(m_status)
 	{
 		case Job_Finished:
+			m_metrics.cacheHit = true;
+			recordMetrics(Metrics::Result::Succeeded);
 			emit succeeded(m_index_within_job);
 			qDebug() << "Download cache hit " << m_url.toString();
 			return;
@@ -88,6 +105,7 @@ void Download::start()
 		case Job_Failed_Proceed: // this is meaningless in this context. We do need a sink.
 		case Job_NotStarted:
 		case Job_Failed:
+			recordMetrics(Metrics::Result::Failed);
 			emit failed(m_index_within_job);
 			return;
 		case Job_Aborted:
@@ -103,6 +121,8 @@ void Download::start()
 	connect(rep, SIGNAL(finished()), SLOT(downloadFinished()));
 	connect(rep, SIGNAL(error(QNetworkReply::NetworkError)), SLOT(downloadError(QNetworkReply::NetworkError)));
 	connect(rep, SIGNAL(readyRead()), SLOT(downloadReadyRead()));
+	// the headers are the first thing to arrive, a request that got no response never sends this
+	connect(rep, SIGNAL(metaDataChanged()), SLOT(markFirstByte()));
 }
 
 void Download::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
@@ -154,6 +174,7 @@ bool Download::handleRedirect()
 	}
 	if (!redirectURL.isEmpty())
 	{
+		m_metrics.redirects++;
 		m_url = QUrl(redirect.toString());
 		qDebug() << "Following redirect to " << m_url.toString();
 		start();
@@ -162,6 +183,30 @@ bool Download::handleRedirect()
 	return false;
 }
 
+void Download::markFirstByte()
+{
+	if(m_attemptStart >= 0 && m_metrics.timeToFirstByte < 0)
+	{
+		m_metrics.timeToFirstByte = Metrics::now() - m_attemptStart;
+	}
+}
+
+void Download::recordMetrics(Metrics::Result result)
+{
+	// not started while metrics were being recorded
+	if(!m_metrics.id)
+	{
+		return;
+	}
+	if(m_reply)
+	{
+		m_metrics.httpStatus = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+	}
+	m_metrics.retries = m_attempts - 1 - m_metrics.redirects;
+	m_metrics.duration = Metrics::now() - m_metrics.start;
+	m_metrics.result = result;
+	Metrics::record(m_metrics);
+}
 
 void Download::downloadFinished()
 {
@@ -177,6 +222,7 @@ void Download::downloadFinished()
 	{
 		qDebug() << "Download failed but we are allowed to proceed:" << m_url.toString();
 		m_sink->abort();
+		recordMetrics(Metrics::Result::Succeeded);
 		m_reply.reset();
 		emit succeeded(m_index_within_job);
 		return;
@@ -185,6 +231,7 @@ void Download::downloadFinished()
 	{
 		qDebug() << "Download failed in previous step:" << m_url.toString();
 		m_sink->abort();
+		recordMetrics(Metrics::Result::Failed);
 		m_reply.reset();
 		emit failed(m_index_within_job);
 		return;
@@ -193,29 +240,37 @@ void Download::downloadFinished()
 	{
 		qDebug() << "Download aborted in previous step:" << m_url.toString();
 		m_sink->abort();
+		recordMetrics(Metrics::Result::Aborted);
 		m_reply.reset();
 		emit aborted(m_index_within_job);
 		return;
 	}
 
+	// time spent in the sinks is disk access and checksums, not network
+	auto sinkStart = Metrics::now();
+
 	// make sure we got all the remaining data, if any
 	auto data = m_reply->readAll();
 	if(data.size())
 	{
 		qDebug() << "Writing extra" << data.size() << "bytes to" << m_target_path;
+		m_metrics.bytes += data.size();
 		m_status = m_sink->write(data);
 	}
 
 	// otherwise, finalize the whole graph
 	m_status = m_sink->finalize(*m_reply.get());
+	m_metrics.sinkTime += Metrics::now() - sinkStart;
 	if (m_status != Job_Finished)
 	{
 		qDebug() << "Download failed to finalize:" << m_url.toString();
 		m_sink->abort();
+		recordMetrics(Metrics::Result::Failed);
 		m_reply.reset();
 		emit failed(m_index_within_job);
 		return;
 	}
+	recordMetrics(Metrics::Result::Succeeded);
 	m_reply.reset();
 	qDebug() << "Download succeeded:" << m_url.toString();
 	emit succeeded(m_index_within_job);
@@ -225,8 +280,12 @@ void Download::downloadReadyRead()
 {
 	if(m_status == Job_InProgress)
 	{
+		markFirstByte();
 		auto data = m_reply->readAll();
+		m_metrics.bytes += data.size();
+		auto sinkStart = Metrics::now();
 		m_status = m_sink->write(data);
+		m_metrics.sinkTime += Metrics::now() - sinkStart;
 		if(m_status == Job_Failed)
 		{
 			qCritical() << "Failed to process response chunk for " << m_target_path;
@@ -19,6 +19,7 @@
 #include "HttpMetaCache.h"
 #include "Validator.h"
 #include "Sink.h"
+#include "Metrics.h"
 
 #include "multimc_logic_export.h"
 namespace Net {
@@ -54,6 +55,10 @@ public: /* methods */
 
 private: /* methods */
 	bool handleRedirect();
+	void recordMetrics(Metrics::Result result);
+
+private slots:
+	void markFirstByte();
 
 protected slots:
 	void downloadProgress(qint64 bytesReceived, qint64 bytesTotal) override;
@@ -69,6 +74,10 @@ private: /* data */
 	QString m_target_path;
 	std::unique_ptr<Sink> m_sink;
 	Options m_options;
+	Metrics::DownloadRecord m_metrics;
+	// when the current attempt started, for the time to first byte
+	qint64 m_attemptStart = -1;
+	int m_attempts = 0;
 };
 }
 
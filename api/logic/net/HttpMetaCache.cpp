@@ -16,11 +16,13 @@
 #include "Env.h"
 #include "HttpMetaCache.h"
 #include "FileSystem.h"
+#include "Trace.h"
 
 #include <QFileInfo>
 #include <QFile>
 #include <QDateTime>
 #include <QCryptographicHash>
+#include <QtConcurrentRun>
 
 #include <QDebug>
 
@@ -36,10 +38,12 @@ QString MetaEntry::getFullPath()
 
 HttpMetaCache::HttpMetaCache(QString path) : QObject()
 {
-	m_index_file = path;
+	// saving can happen after the working directory changed
+	m_index_file = path.isEmpty() ? path : QFileInfo(path).absoluteFilePath();
 	saveBatchingTimer.setSingleShot(true);
 	saveBatchingTimer.setTimerType(Qt::VeryCoarseTimer);
 	connect(&saveBatchingTimer, SIGNAL(timeout()), SLOT(SaveNow()));
+	connect(&m_loadingWatcher, &QFutureWatcher<QList<MetaEntryPtr>>::finished, this, &HttpMetaCache::waitForLoad);
 }
 
 HttpMetaCache::~HttpMetaCache()
@@ -50,6 +54,7 @@ HttpMetaCache::~HttpMetaCache()
 
 MetaEntryPtr HttpMetaCache::getEntry(QString base, QString resource_path)
 {
+	waitForLoad();
 	// no base. no base path. can't store
 	if (!m_entries.contains(base))
 	{
@@ -116,8 +121,63 @@ MetaEntryPtr HttpMetaCache::resolveEntry(QString base, QString resource_path, QS
 	return entry;
 }
 
+MetaEntryPtr HttpMetaCache::resolvePinnedEntry(QString base, QString resource_path, QString expected_sha1)
+{
+	auto entry = resolveEntry(base, resource_path);
+	if (entry->stale)
+	{
+		return entry;
+	}
+	// nothing to pin to, ask the server every time
+	if (expected_sha1.isEmpty())
+	{
+		entry->stale = true;
+		return entry;
+	}
+	// entries from before SHA-1 sums were kept get theirs now, once
+	if (entry->sha1sum.isEmpty())
+	{
+		QFile input(entry->getFullPath());
+		if (input.open(QIODevice::ReadOnly))
+		{
+			entry->sha1sum = QCryptographicHash::hash(input.readAll(), QCryptographicHash::Sha1)
+								 .toHex()
+								 .constData();
+			SaveEventually();
+		}
+	}
+	if (entry->sha1sum == expected_sha1.toLower())
+	{
+		return entry;
+	}
+	// the file is not what we want. don't revalidate it, download the right one.
+	m_entries[base].entry_list.remove(resource_path);
+	return staleEntry(base, resource_path);
+}
+
+MetaEntryPtr HttpMetaCache::resolveFreshEntry(QString base, QString resource_path, qint64 max_age)
+{
+	auto entry = resolveEntry(base, resource_path);
+	if (entry->stale)
+	{
+		return entry;
+	}
+	if (entry->max_age >= 0)
+	{
+		max_age = entry->max_age;
+	}
+	auto age = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch() - entry->last_checked_timestamp;
+	// never checked, checked in the future (clock went back), or too long ago
+	if (entry->last_checked_timestamp == 0 || age < 0 || age >= max_age * 1000)
+	{
+		entry->stale = true;
+	}
+	return entry;
+}
+
 bool HttpMetaCache::updateEntry(MetaEntryPtr stale_entry)
 {
+	waitForLoad();
 	if (!m_entries.contains(stale_entry->baseId))
 	{
 		qCritical() << "Cannot add entry with unknown base: "
@@ -177,50 +237,80 @@ QString HttpMetaCache::getBasePath(QString base)
 
 void HttpMetaCache::Load()
 {
-	if(m_index_file.isNull())
+	LoadInBackground();
+	waitForLoad();
+}
+
+void HttpMetaCache::LoadInBackground()
+{
+	if(m_index_file.isNull() || m_loadPending)
 		return;
+	m_loadPending = true;
+	m_loading = QtConcurrent::run(&HttpMetaCache::readIndex, m_index_file);
+	m_loadingWatcher.setFuture(m_loading);
+}
 
-	QFile index(m_index_file);
-	if (!index.open(QIODevice::ReadOnly))
+void HttpMetaCache::waitForLoad()
+{
+	if (!m_loadPending)
 		return;
+	m_loadPending = false;
+	// shows up in the startup trace when something needed the cache before it was read
+	Trace::Span span("Wait for cache index", m_loading.isFinished() ? "ready" : "blocked");
+	// the entries of bases that are not known are dropped
+	for (auto &entry : m_loading.result())
+	{
+		if (!m_entries.contains(entry->baseId))
+			continue;
+		m_entries[entry->baseId].entry_list[entry->relativePath] = entry;
+	}
+}
+
+QList<MetaEntryPtr> HttpMetaCache::readIndex(const QString &index_file)
+{
+	Trace::Span span("Read cache index");
+	QList<MetaEntryPtr> out;
+	QFile index(index_file);
+	if (!index.open(QIODevice::ReadOnly))
+		return out;
 
 	QJsonDocument json = QJsonDocument::fromJson(index.readAll());
 	if (!json.isObject())
-		return;
+		return out;
 	auto root = json.object();
 	// check file version first
 	auto version_val = root.value("version");
 	if (!version_val.isString())
-		return;
+		return out;
 	if (version_val.toString() != "1")
-		return;
+		return out;
 
 	// read the entry array
 	auto entries_val = root.value("entries");
 	if (!entries_val.isArray())
-		return;
+		return out;
 	QJsonArray array = entries_val.toArray();
 	for (auto element : array)
 	{
 		if (!element.isObject())
-			return;
+			return out;
 		auto element_obj = element.toObject();
-		QString base = element_obj.value("base").toString();
-		if (!m_entries.contains(base))
-			continue;
-		auto &entrymap = m_entries[base];
 		auto foo = new MetaEntry();
-		foo->baseId = base;
-		QString path = foo->relativePath = element_obj.value("path").toString();
+		foo->baseId = element_obj.value("base").toString();
+		foo->relativePath = element_obj.value("path").toString();
 		foo->md5sum = element_obj.value("md5sum").toString();
+		foo->sha1sum = element_obj.value("sha1sum").toString();
 		foo->etag = element_obj.value("etag").toString();
 		foo->local_changed_timestamp = element_obj.value("last_changed_timestamp").toDouble();
 		foo->remote_changed_timestamp =
 			element_obj.value("remote_changed_timestamp").toString();
+		foo->last_checked_timestamp = element_obj.value("last_checked_timestamp").toDouble();
+		foo->max_age = element_obj.value("max_age").toDouble(-1);
 		// presumed innocent until closer examination
 		foo->stale = false;
-		entrymap.entry_list[path] = MetaEntryPtr(foo);
+		out.append(MetaEntryPtr(foo));
 	}
+	return out;
 }
 
 void HttpMetaCache::SaveEventually()
@@ -234,6 +324,8 @@ void HttpMetaCache::SaveNow()
 {
 	if(m_index_file.isNull())
 		return;
+	// do not overwrite the index with only what was added since the start
+	waitForLoad();
 	QJsonObject toplevel;
 	toplevel.insert("version", QJsonValue(QString("1")));
 	QJsonArray entriesArr;
@@ -256,6 +348,13 @@ void HttpMetaCache::SaveNow()
 			if (!entry->remote_changed_timestamp.isEmpty())
 				entryObj.insert("remote_changed_timestamp",
 								QJsonValue(entry->remote_changed_timestamp));
+			if (!entry->sha1sum.isEmpty())
+				entryObj.insert("sha1sum", QJsonValue(entry->sha1sum));
+			if (entry->last_checked_timestamp)
+				entryObj.insert("last_checked_timestamp",
+								QJsonValue(double(entry->last_checked_timestamp)));
+			if (entry->max_age >= 0)
+				entryObj.insert("max_age", QJsonValue(double(entry->max_age)));
 			entriesArr.append(entryObj);
 		}
 	}
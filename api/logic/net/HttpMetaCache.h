@@ -17,6 +17,8 @@
 #include <QString>
 #include <QMap>
 #include <qtimer.h>
+#include <QFuture>
+#include <QFutureWatcher>
 #include <memory>
 
 #include "multimc_logic_export.h"
@@ -66,14 +68,41 @@ public:
 	{
 		this->md5sum = md5sum;
 	}
+	QString getSha1Sum()
+	{
+		return sha1sum;
+	}
+	void setSha1Sum(QString sha1sum)
+	{
+		this->sha1sum = sha1sum;
+	}
+	qint64 getLastCheckedTimestamp()
+	{
+		return last_checked_timestamp;
+	}
+	void setLastCheckedTimestamp(qint64 timestamp)
+	{
+		last_checked_timestamp = timestamp;
+	}
+	qint64 getMaxAge()
+	{
+		return max_age;
+	}
+	void setMaxAge(qint64 max_age)
+	{
+		this->max_age = max_age;
+	}
 protected:
 	QString baseId;
 	QString basePath;
 	QString relativePath;
 	QString md5sum;
+	QString sha1sum;
 	QString etag;
 	qint64 local_changed_timestamp = 0;
 	QString remote_changed_timestamp; // QString for now, RFC 2822 encoded time
+	qint64 last_checked_timestamp = 0; // when the server last confirmed the file, msecs since epoch (UTC)
+	qint64 max_age = -1; // how long the server said the file stays fresh, in seconds. -1 if it didn't say
 	bool stale = true;
 };
 
@@ -95,6 +124,14 @@ public:
 	MetaEntryPtr resolveEntry(QString base, QString resource_path,
 							  QString expected_etag = QString());
 
+	// get the entry from cache, stale unless its content has the expected SHA-1
+	// a matching entry is never revalidated, the hash already says everything about it
+	MetaEntryPtr resolvePinnedEntry(QString base, QString resource_path, QString expected_sha1);
+
+	// get the entry from cache, stale if the server last confirmed it longer than max_age seconds ago
+	// a max-age sent by the server takes precedence over the one given here
+	MetaEntryPtr resolveFreshEntry(QString base, QString resource_path, qint64 max_age);
+
 	// add a previously resolved stale entry
 	bool updateEntry(MetaEntryPtr stale_entry);
 
@@ -106,11 +143,17 @@ public:
 	// (re)start a timer that calls SaveNow later.
 	void SaveEventually();
 	void Load();
+	// read the index on a worker thread, anything that needs the entries before it is done waits for it
+	void LoadInBackground();
 	QString getBasePath(QString base);
 public
 slots:
 	void SaveNow();
 
+private
+slots:
+	void waitForLoad();
+
 private:
 	// create a new stale entry, given the parameters
 	MetaEntryPtr staleEntry(QString base, QString resource_path);
@@ -119,7 +162,12 @@ private:
 		QString base_path;
 		QMap<QString, MetaEntryPtr> entry_list;
 	};
+	static QList<MetaEntryPtr> readIndex(const QString &index_file);
+
 	QMap<QString, EntryMap> m_entries;
 	QString m_index_file;
 	QTimer saveBatchingTimer;
+	QFuture<QList<MetaEntryPtr>> m_loading;
+	QFutureWatcher<QList<MetaEntryPtr>> m_loadingWatcher;
+	bool m_loadPending = false;
 };
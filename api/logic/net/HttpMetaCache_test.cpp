@@ -0,0 +1,273 @@
+#include <QTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include "TestUtil.h"
+
+#include "net/HttpMetaCache.h"
+#include "net/NetJob.h"
+#include "net/ChecksumValidator.h"
+#include "Env.h"
+#include "FileSystem.h"
+
+// stands in for the real servers and counts what gets asked of it
+class HttpStandIn : public QObject
+{
+	Q_OBJECT
+public:
+	HttpStandIn()
+	{
+		connect(&m_server, &QTcpServer::newConnection, this, &HttpStandIn::newConnection);
+		m_server.listen(QHostAddress::LocalHost);
+	}
+	QUrl url(const QString &path) const
+	{
+		return QUrl(QString("http://127.0.0.1:%1/%2").arg(m_server.serverPort()).arg(path));
+	}
+
+	QByteArray body;
+	QByteArray cacheControl;
+	int requests = 0;
+	int conditionalRequests = 0;
+
+private slots:
+	void newConnection()
+	{
+		while(auto socket = m_server.nextPendingConnection())
+		{
+			connect(socket, &QTcpSocket::readyRead, this, [this, socket]()
+			{
+				auto &buffer = m_buffers[socket];
+				buffer.append(socket->readAll());
+				if(!buffer.contains("\r\n\r\n"))
+				{
+					return;
+				}
+				respond(socket, buffer);
+				m_buffers.remove(socket);
+			});
+			connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+		}
+	}
+
+private:
+	QByteArray etag() const
+	{
+		return "\"" + QCryptographicHash::hash(body, QCryptographicHash::Md5).toHex() + "\"";
+	}
+	void respond(QTcpSocket *socket, const QByteArray &request)
+	{
+		requests++;
+		QByteArray ifNoneMatch;
+		for(auto line: request.split('\n'))
+		{
+			line = line.trimmed();
+			if(line.toLower().startsWith("if-none-match:"))
+			{
+				ifNoneMatch = line.mid(14).trimmed();
+			}
+		}
+		QByteArray response;
+		if(!ifNoneMatch.isEmpty())
+		{
+			conditionalRequests++;
+		}
+		if(!ifNoneMatch.isEmpty() && ifNoneMatch == etag())
+		{
+			response = "HTTP/1.1 304 Not Modified\r\n";
+		}
+		else
+		{
+			response = "HTTP/1.1 200 OK\r\nContent-Length: " + QByteArray::number(body.size()) + "\r\n";
+		}
+		response += "ETag: " + etag() + "\r\n";
+		if(!cacheControl.isEmpty())
+		{
+			response += "Cache-Control: " + cacheControl + "\r\n";
+		}
+		response += "Connection: close\r\n\r\n";
+		if(!response.startsWith("HTTP/1.1 304"))
+		{
+			response += body;
+		}
+		socket->write(response);
+		socket->disconnectFromHost();
+	}
+
+	QTcpServer m_server;
+	QHash<QTcpSocket *, QByteArray> m_buffers;
+};
+
+class HttpMetaCacheTest : public QObject
+{
+	Q_OBJECT
+private:
+	QString sha1(const QByteArray &data)
+	{
+		return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+	}
+	bool download(const QString &path, MetaEntryPtr entry, const QString &expectedSha1 = QString())
+	{
+		NetJob job("Stand-in download");
+		auto dl = Net::Download::makeCached(m_standIn->url(path), entry);
+		if(!expectedSha1.isEmpty())
+		{
+			dl->addValidator(new Net::ChecksumValidator(QCryptographicHash::Sha1, QByteArray::fromHex(expectedSha1.toLatin1())));
+		}
+		job.addNetAction(dl);
+		job.start();
+		QElapsedTimer timer;
+		timer.start();
+		while(!job.isFinished() && timer.elapsed() < 10000)
+		{
+			QTest::qWait(10);
+		}
+		return job.wasSuccessful();
+	}
+
+private
+slots:
+	void initTestCase()
+	{
+		m_originalDir = QDir::currentPath();
+		m_standIn.reset(new HttpStandIn());
+	}
+	void cleanupTestCase()
+	{
+		m_standIn.reset();
+		QDir::setCurrent(m_originalDir);
+		Env::dispose();
+		QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+		m_dir.reset();
+	}
+	void init()
+	{
+		// every test starts from an empty cache in a folder of its own
+		std::unique_ptr<QTemporaryDir> dir(new QTemporaryDir());
+		QVERIFY(dir->isValid());
+		QDir::setCurrent(dir->path());
+		ENV.initHttpMetaCache();
+		// the old cache saves its index when it goes, that has to land in its own folder before it is removed
+		QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+		m_dir = std::move(dir);
+
+		m_standIn->requests = 0;
+		m_standIn->conditionalRequests = 0;
+		m_standIn->cacheControl.clear();
+		m_standIn->body.clear();
+	}
+
+	void test_PinnedHit()
+	{
+		m_standIn->body = "{\"objects\": {}}";
+		auto hash = sha1(m_standIn->body);
+
+		auto entry = ENV.metacache()->resolvePinnedEntry("general", "standin/index.json", hash);
+		QVERIFY(entry->isStale());
+		QVERIFY(download("index.json", entry, hash));
+		QCOMPARE(m_standIn->requests, 1);
+
+		// a warm launch does not go to the network at all
+		entry = ENV.metacache()->resolvePinnedEntry("general", "standin/index.json", hash);
+		QVERIFY(!entry->isStale());
+		QVERIFY(download("index.json", entry, hash));
+		QCOMPARE(m_standIn->requests, 1);
+	}
+
+	void test_PinnedChanged()
+	{
+		m_standIn->body = "{\"objects\": {}}";
+		auto oldHash = sha1(m_standIn->body);
+		auto entry = ENV.metacache()->resolvePinnedEntry("general", "standin/index.json", oldHash);
+		QVERIFY(download("index.json", entry, oldHash));
+
+		m_standIn->body = "{\"objects\": {\"a\": {}}}";
+		m_standIn->requests = 0;
+		auto hash = sha1(m_standIn->body);
+
+		// the file on disk has the old hash, so it is downloaded again without asking if it changed
+		entry = ENV.metacache()->resolvePinnedEntry("general", "standin/index.json", hash);
+		QVERIFY(entry->isStale());
+		QVERIFY(download("index.json", entry, hash));
+		QCOMPARE(m_standIn->requests, 1);
+		QCOMPARE(m_standIn->conditionalRequests, 0);
+		QCOMPARE(FS::read("cache/standin/index.json"), m_standIn->body);
+		QCOMPARE(entry->getSha1Sum(), hash);
+	}
+
+	void test_Unpinned()
+	{
+		m_standIn->body = "{\"objects\": {}}";
+		auto entry = ENV.metacache()->resolvePinnedEntry("general", "standin/index.json", QString());
+		QVERIFY(download("index.json", entry));
+		QCOMPARE(m_standIn->conditionalRequests, 0);
+
+		// without a hash, every resolve asks the server
+		entry = ENV.metacache()->resolvePinnedEntry("general", "standin/index.json", QString());
+		QVERIFY(entry->isStale());
+		QVERIFY(download("index.json", entry));
+		QCOMPARE(m_standIn->requests, 2);
+		QCOMPARE(m_standIn->conditionalRequests, 1);
+	}
+
+	void test_FreshByServer()
+	{
+		m_standIn->body = "{\"versions\": []}";
+		m_standIn->cacheControl = "public, max-age=3600";
+
+		auto entry = ENV.metacache()->resolveFreshEntry("general", "standin/fresh.json", 0);
+		QVERIFY(entry->isStale());
+		QVERIFY(download("fresh.json", entry));
+		QCOMPARE(m_standIn->requests, 1);
+		QCOMPARE(entry->getMaxAge(), qint64(3600));
+
+		// the server said an hour, that beats the zero we ask for
+		entry = ENV.metacache()->resolveFreshEntry("general", "standin/fresh.json", 0);
+		QVERIFY(!entry->isStale());
+		QVERIFY(download("fresh.json", entry));
+		QCOMPARE(m_standIn->requests, 1);
+	}
+
+	void test_Revalidate()
+	{
+		m_standIn->body = "{\"versions\": [1]}";
+		m_standIn->cacheControl = "no-cache";
+
+		auto entry = ENV.metacache()->resolveFreshEntry("general", "standin/revalidated.json", 3600);
+		QVERIFY(entry->isStale());
+		QVERIFY(download("revalidated.json", entry));
+		QCOMPARE(m_standIn->requests, 1);
+
+		// no-cache from the server means it is asked every time, but the answer is a 304
+		entry = ENV.metacache()->resolveFreshEntry("general", "standin/revalidated.json", 3600);
+		QVERIFY(entry->isStale());
+		QVERIFY(download("revalidated.json", entry));
+		QCOMPARE(m_standIn->requests, 2);
+		QCOMPARE(m_standIn->conditionalRequests, 1);
+		QCOMPARE(FS::read("cache/standin/revalidated.json"), m_standIn->body);
+	}
+
+	void test_FreshByPolicy()
+	{
+		m_standIn->body = "{\"versions\": [2]}";
+
+		auto entry = ENV.metacache()->resolveFreshEntry("general", "standin/policy.json", 3600);
+		QVERIFY(download("policy.json", entry));
+		QCOMPARE(m_standIn->requests, 1);
+
+		entry = ENV.metacache()->resolveFreshEntry("general", "standin/policy.json", 3600);
+		QVERIFY(!entry->isStale());
+		entry = ENV.metacache()->resolveFreshEntry("general", "standin/policy.json", 0);
+		QVERIFY(entry->isStale());
+	}
+
+private:
+	std::unique_ptr<HttpStandIn> m_standIn;
+	std::unique_ptr<QTemporaryDir> m_dir;
+	QString m_originalDir;
+};
+
+QTEST_GUILESS_MAIN(HttpMetaCacheTest)
+
+#include "HttpMetaCache_test.moc"
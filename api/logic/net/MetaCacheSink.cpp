@@ -4,12 +4,40 @@
 #include "Env.h"
 #include "FileSystem.h"
 
+#include <QDateTime>
+
 namespace Net {
 
+// max-age from a Cache-Control header, -1 if there is none
+static qint64 parseMaxAge(const QByteArray &cacheControl)
+{
+	qint64 maxAge = -1;
+	for(auto directive: cacheControl.split(','))
+	{
+		directive = directive.trimmed().toLower();
+		if(directive == "no-cache" || directive == "no-store")
+		{
+			return 0;
+		}
+		if(directive.startsWith("max-age="))
+		{
+			bool ok = false;
+			auto value = directive.mid(8).toLongLong(&ok);
+			if(ok && value >= 0)
+			{
+				maxAge = value;
+			}
+		}
+	}
+	return maxAge;
+}
+
 MetaCacheSink::MetaCacheSink(MetaEntryPtr entry, ChecksumValidator * md5sum)
 	:Net::FileSink(entry->getFullPath()), m_entry(entry), m_md5Node(md5sum)
 {
 	addValidator(md5sum);
+	m_sha1Node = new ChecksumValidator(QCryptographicHash::Sha1);
+	addValidator(m_sha1Node);
 };
 
 MetaCacheSink::~MetaCacheSink()
@@ -45,6 +73,7 @@ JobStatus MetaCacheSink::finalizeCache(QNetworkReply & reply)
 	if(wroteAnyData)
 	{
 		m_entry->setMD5Sum(m_md5Node->hash().toHex().constData());
+		m_entry->setSha1Sum(m_sha1Node->hash().toHex().constData());
 	}
 	m_entry->setETag(reply.rawHeader("ETag").constData());
 	if (reply.hasRawHeader("Last-Modified"))
@@ -52,6 +81,9 @@ JobStatus MetaCacheSink::finalizeCache(QNetworkReply & reply)
 		m_entry->setRemoteChangedTimestamp(reply.rawHeader("Last-Modified").constData());
 	}
 	m_entry->setLocalChangedTimestamp(output_file_info.lastModified().toUTC().toMSecsSinceEpoch());
+	// a 304 counts too, the server just confirmed what we have
+	m_entry->setLastCheckedTimestamp(QDateTime::currentDateTimeUtc().toMSecsSinceEpoch());
+	m_entry->setMaxAge(parseMaxAge(reply.rawHeader("Cache-Control")));
 	m_entry->setStale(false);
 	ENV.metacache()->updateEntry(m_entry);
 	return Job_Finished;
@@ -18,5 +18,6 @@ protected: /* methods */
 private: /* data */
 	MetaEntryPtr m_entry;
 	ChecksumValidator * m_md5Node;
+	ChecksumValidator * m_sha1Node;
 };
 }
@@ -17,11 +17,13 @@
 #include <FileSystem.h>
 
 #include <QFile>
-#include <QTextStream>
-#include <QStringList>
+#include <QHash>
+#include <QMutex>
 #include <QSaveFile>
 #include <QDebug>
 
+#include <cstring>
+
 INIFile::INIFile()
 {
 }
@@ -73,10 +75,10 @@ QString INIFile::escape(QString orig)
 	return out;
 }
 
-bool INIFile::saveFile(QString fileName)
+QByteArray INIFile::serialize() const
 {
 	QByteArray outArray;
-	for (Iterator iter = begin(); iter != end(); iter++)
+	for (ConstIterator iter = begin(); iter != end(); iter++)
 	{
 		QString value = iter.value().toString();
 		value = escape(value);
@@ -85,10 +87,14 @@ bool INIFile::saveFile(QString fileName)
 		outArray.append(value.toUtf8());
 		outArray.append('\n');
 	}
+	return outArray;
+}
 
+bool INIFile::saveFile(QString fileName)
+{
 	try
 	{
-		FS::write(fileName, outArray);
+		FS::write(fileName, serialize());
 	}
 	catch (Exception & e)
 	{
@@ -110,28 +116,82 @@ bool INIFile::loadFile(QString fileName)
 	return success;
 }
 
+static inline bool isAsciiSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// Trim ASCII whitespace from both ends of [begin, end)
+static inline void trimSpan(const char *&begin, const char *&end)
+{
+	while (begin < end && isAsciiSpace(*begin))
+		begin++;
+	while (end > begin && isAsciiSpace(*(end - 1)))
+		end--;
+}
+
+// Decode a trimmed span, finishing the trim for non-ASCII whitespace like QString::trimmed does
+static inline QString decodeSpan(const char *begin, const char *end)
+{
+	QString out = QString::fromUtf8(begin, int(end - begin));
+	if (!out.isEmpty() && (out.at(0).isSpace() || out.at(out.size() - 1).isSpace()))
+		out = out.trimmed();
+	return out;
+}
+
+// Keys repeat across every instance.cfg, so share one string per distinct key
+static QString internKey(const char *begin, const char *end)
+{
+	static QMutex mutex;
+	static QHash<QByteArray, QString> pool;
+
+	const QByteArray raw = QByteArray::fromRawData(begin, int(end - begin));
+	QMutexLocker locker(&mutex);
+	auto iter = pool.constFind(raw);
+	if (iter != pool.constEnd())
+		return *iter;
+	QString key = decodeSpan(begin, end);
+	pool.insert(QByteArray(begin, int(end - begin)), key);
+	return key;
+}
+
 bool INIFile::loadFile(QByteArray file)
 {
-	QTextStream in(file);
-	in.setCodec("UTF-8");
+	const char *data = file.constData();
+	const char *fileEnd = data + file.size();
+
+	// skip the UTF-8 byte order mark, if any
+	if (file.startsWith("\xEF\xBB\xBF"))
+		data += 3;
 
-	QStringList lines = in.readAll().split('\n');
-	for (int i = 0; i < lines.count(); i++)
+	while (data < fileEnd)
 	{
-		QString &lineRaw = lines[i];
+		const char *lineEnd = static_cast<const char *>(memchr(data, '\n', fileEnd - data));
+		if (!lineEnd)
+			lineEnd = fileEnd;
+		const char *lineBegin = data;
+		data = lineEnd + 1;
+
 		// Ignore comments.
-		QString line = lineRaw.left(lineRaw.indexOf('#')).trimmed();
+		const char *comment = static_cast<const char *>(memchr(lineBegin, '#', lineEnd - lineBegin));
+		if (comment)
+			lineEnd = comment;
 
-		int eqPos = line.indexOf('=');
-		if (eqPos == -1)
+		const char *eq = static_cast<const char *>(memchr(lineBegin, '=', lineEnd - lineBegin));
+		if (!eq)
 			continue;
-		QString key = line.left(eqPos).trimmed();
-		QString valueStr = line.right(line.length() - eqPos - 1).trimmed();
 
-		valueStr = unescape(valueStr);
+		const char *keyBegin = lineBegin, *keyEnd = eq;
+		trimSpan(keyBegin, keyEnd);
+		const char *valueBegin = eq + 1, *valueEnd = lineEnd;
+		trimSpan(valueBegin, valueEnd);
+
+		// only values that contain escapes need a second pass
+		QString value = decodeSpan(valueBegin, valueEnd);
+		if (memchr(valueBegin, '\\', valueEnd - valueBegin))
+			value = unescape(value);
 
-		QVariant value(valueStr);
-		this->operator[](key) = value;
+		this->operator[](internKey(keyBegin, keyEnd)) = QVariant(value);
 	}
 
 	return true;
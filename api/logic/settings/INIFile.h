@@ -30,6 +30,8 @@ public:
 	bool loadFile(QByteArray file);
 	bool loadFile(QString fileName);
 	bool saveFile(QString fileName);
+	/// The exact bytes saveFile() would write
+	QByteArray serialize() const;
 
 	QVariant get(QString key, QVariant def) const;
 	void set(QString key, QVariant val);
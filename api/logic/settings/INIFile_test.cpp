@@ -55,6 +55,74 @@ slots:
 		QCOMPARE(a, f2.get("a","NOT SET").toString());
 		QCOMPARE(b, f2.get("b","NOT SET").toString());
 	}
+
+	void test_Parse_data()
+	{
+		QTest::addColumn<QByteArray>("input");
+		QTest::addColumn<QString>("key");
+		QTest::addColumn<QString>("value");
+
+		QTest::newRow("plain") << QByteArray("a=b\n") << "a" << "b";
+		QTest::newRow("no newline") << QByteArray("a=b") << "a" << "b";
+		QTest::newRow("spaces") << QByteArray("  a \t=  b c  \n") << "a" << "b c";
+		QTest::newRow("CRLF") << QByteArray("x=1\r\na=b\r\n") << "a" << "b";
+		QTest::newRow("BOM") << QByteArray("\xEF\xBB\xBF" "a=b\n") << "a" << "b";
+		QTest::newRow("comment") << QByteArray("# a=c\na=b # c\n") << "a" << "b";
+		QTest::newRow("empty value") << QByteArray("a=\n") << "a" << "";
+		QTest::newRow("equals in value") << QByteArray("a=b=c\n") << "a" << "b=c";
+		QTest::newRow("escapes") << QByteArray("a=b\\nc\\t\\\\\n") << "a" << "b\nc\t\\";
+		QTest::newRow("unicode") << QByteArray("a=\xC5\xBElu\xC5\xA5ou\xC4\x8Dk\xC3\xBD\n") << "a" << QString::fromUtf8("\xC5\xBElu\xC5\xA5ou\xC4\x8Dk\xC3\xBD");
+		QTest::newRow("unicode space") << QByteArray("a=\xC2\xA0" "b\xC2\xA0\n") << "a" << "b";
+		QTest::newRow("last wins") << QByteArray("a=c\na=b\n") << "a" << "b";
+	}
+	void test_Parse()
+	{
+		QFETCH(QByteArray, input);
+		QFETCH(QString, key);
+		QFETCH(QString, value);
+
+		INIFile f;
+		QVERIFY(f.loadFile(input));
+		QCOMPARE(f.get(key, "NOT SET").toString(), value);
+	}
+
+	void test_SkipsInvalidLines()
+	{
+		INIFile f;
+		QVERIFY(f.loadFile(QByteArray("garbage\n\n=value\nkey\n")));
+		QCOMPARE(f.size(), 1);
+		QCOMPARE(f.get("", "NOT SET").toString(), QString("value"));
+	}
+
+	void test_RoundTrip()
+	{
+		INIFile f;
+		f.set("name", "Instance with\ttabs\nand newlines\\");
+		f.set("notes", QString::fromUtf8("\xC5\xBElu\xC5\xA5ou\xC4\x8Dk\xC3\xBD k\xC5\xAF\xC5\x88"));
+		f.set("iconKey", "default");
+		f.set("totalTimePlayed", 12345);
+		QByteArray saved = f.serialize();
+
+		INIFile f2;
+		QVERIFY(f2.loadFile(saved));
+		QCOMPARE(f2.serialize(), saved);
+	}
+
+	void test_Load_benchmark()
+	{
+		INIFile source;
+		for(int i = 0; i < 50; i++)
+		{
+			source.set(QString("setting%1").arg(i), QString("some value number %1").arg(i));
+		}
+		source.set("escaped", "C:\\Program files\\java\n");
+		QByteArray data = source.serialize();
+		QBENCHMARK
+		{
+			INIFile f;
+			f.loadFile(data);
+		}
+	}
 };
 
 QTEST_GUILESS_MAIN(IniFileTest)
@@ -15,6 +15,7 @@
 
 #include "INISettingsObject.h"
 #include "Setting.h"
+#include "SaveScheduler.h"
 
 INISettingsObject::INISettingsObject(const QString &path, QObject *parent)
 	: SettingsObject(parent)
@@ -23,6 +24,13 @@ INISettingsObject::INISettingsObject(const QString &path, QObject *parent)
 	m_ini.loadFile(path);
 }
 
+INISettingsObject::INISettingsObject(const QString &path, const INIFile &contents, QObject *parent)
+	: SettingsObject(parent)
+{
+	m_filePath = path;
+	m_ini = contents;
+}
+
 void INISettingsObject::setFilePath(const QString &filePath)
 {
 	m_filePath = filePath;
@@ -30,6 +38,8 @@ void INISettingsObject::setFilePath(const QString &filePath)
 
 bool INISettingsObject::reload()
 {
+	// make sure we read back what we last saved
+	SaveScheduler::instance().flush(m_filePath);
 	return m_ini.loadFile(m_filePath) && SettingsObject::reload();
 }
 
@@ -43,7 +53,8 @@ void INISettingsObject::resumeSave()
 	m_suspendSave = false;
 	if(m_doSave)
 	{
-		m_ini.saveFile(m_filePath);
+		m_doSave = false;
+		doSave();
 	}
 }
 
@@ -77,7 +88,7 @@ void INISettingsObject::doSave()
 	}
 	else
 	{
-		m_ini.saveFile(m_filePath);
+		SaveScheduler::instance().schedule(m_filePath, m_ini.serialize());
 	}
 }
 
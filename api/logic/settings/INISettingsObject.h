@@ -31,6 +31,11 @@ class MULTIMC_LOGIC_EXPORT INISettingsObject : public SettingsObject
 	Q_OBJECT
 public:
 	explicit INISettingsObject(const QString &path, QObject *parent = 0);
+	/*!
+	 * \brief Uses contents that were already read from the file at path.
+	 * Lets callers read many files in parallel and only create the settings objects on their thread.
+	 */
+	INISettingsObject(const QString &path, const INIFile &contents, QObject *parent = 0);
 
 	/*!
 	 * \brief Gets the path to the INI file.
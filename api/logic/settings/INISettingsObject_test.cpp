@@ -0,0 +1,108 @@
+#include <QTest>
+#include "TestUtil.h"
+#include <QtConcurrentRun>
+
+#include "settings/INISettingsObject.h"
+#include "settings/INIFile.h"
+#include "settings/SaveScheduler.h"
+
+class INISettingsObjectTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void initTestCase()
+	{
+		// mod list scans can be the first to use the scheduler, from a worker thread
+		QtConcurrent::run([]() { SaveScheduler::instance(); }).waitForFinished();
+		QCOMPARE(SaveScheduler::instance().thread(), qApp->thread());
+		SaveScheduler::instance().setDelay(50, 200);
+	}
+	void cleanupTestCase()
+	{
+		QFile::remove("test_Coalesce.cfg");
+		QFile::remove("test_Reload.cfg");
+	}
+
+	void test_Coalesce()
+	{
+		auto &scheduler = SaveScheduler::instance();
+		QString filename = "test_Coalesce.cfg";
+		INISettingsObject settings(filename);
+		for(int i = 0; i < 200; i++)
+		{
+			settings.registerSetting(QString("setting%1").arg(i), 0);
+		}
+
+		int before = scheduler.writeCount();
+		for(int i = 0; i < 200; i++)
+		{
+			settings.set(QString("setting%1").arg(i), i);
+		}
+		// nothing is written until the file goes quiet
+		QCOMPARE(scheduler.writeCount(), before);
+
+		// and then it is written once
+		QTRY_COMPARE(scheduler.writeCount(), before + 1);
+
+		INIFile f;
+		QVERIFY(f.loadFile(filename));
+		QCOMPARE(f.get("setting199", -1).toInt(), 199);
+	}
+
+	void test_Reload()
+	{
+		QString filename = "test_Reload.cfg";
+		INISettingsObject settings(filename);
+		settings.registerSetting("a", "default");
+		settings.set("a", "changed");
+
+		// reload reads back the pending value instead of the stale file
+		QVERIFY(settings.reload());
+		QCOMPARE(settings.get("a").toString(), QString("changed"));
+	}
+
+	void test_Discard()
+	{
+		auto &scheduler = SaveScheduler::instance();
+		QDir().mkpath("test_Discard");
+		QString filename = "test_Discard/instance.cfg";
+		{
+			INISettingsObject settings(filename);
+			settings.registerSetting("a", "default");
+			settings.set("a", "changed");
+		}
+		scheduler.discard("test_Discard");
+		QVERIFY(QDir("test_Discard").removeRecursively());
+		scheduler.flush();
+		QVERIFY(!QFile::exists(filename));
+	}
+
+	void test_WriteCount_benchmark()
+	{
+		auto &scheduler = SaveScheduler::instance();
+		QString filename = "test_Coalesce.cfg";
+		INISettingsObject settings(filename);
+		for(int i = 0; i < 100; i++)
+		{
+			settings.registerSetting(QString("setting%1").arg(i), 0);
+		}
+		int before = scheduler.writeCount();
+		int value = 0;
+		QBENCHMARK
+		{
+			value++;
+			for(int i = 0; i < 100; i++)
+			{
+				settings.set(QString("setting%1").arg(i), value);
+			}
+			scheduler.flush();
+		}
+		// one write per flush, no matter how many settings changed
+		QCOMPARE(scheduler.writeCount() - before, value);
+	}
+};
+
+QTEST_GUILESS_MAIN(INISettingsObjectTest)
+
+#include "INISettingsObject_test.moc"
@@ -0,0 +1,210 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SaveScheduler.h"
+#include <FileSystem.h>
+
+#include <QFileInfo>
+#include <QDir>
+#include <QThread>
+#include <QCoreApplication>
+#include <QRunnable>
+#include <QMutexLocker>
+#include <QDebug>
+
+#include <limits>
+
+// Writes one snapshot of a file on the writer thread
+class WriteRunnable : public QRunnable
+{
+public:
+	WriteRunnable(const QString &fileName, const QByteArray &data, QAtomicInt &counter)
+		: m_fileName(fileName), m_data(data), m_counter(counter)
+	{
+	}
+	void run() override
+	{
+		try
+		{
+			FS::write(m_fileName, m_data);
+			m_counter.ref();
+		}
+		catch (Exception &e)
+		{
+			qCritical() << e.what();
+		}
+	}
+private:
+	QString m_fileName;
+	QByteArray m_data;
+	QAtomicInt &m_counter;
+};
+
+SaveScheduler &SaveScheduler::instance()
+{
+	static SaveScheduler scheduler;
+	return scheduler;
+}
+
+SaveScheduler::SaveScheduler(QObject *parent) : QObject(parent)
+{
+	// one writer thread keeps the writes of any single file in order
+	m_writer.setMaxThreadCount(1);
+	m_timer.setSingleShot(true);
+	connect(&m_timer, &QTimer::timeout, this, &SaveScheduler::timeout);
+	m_clock.start();
+	// the first user can be a worker thread without an event loop, the timer would never fire there
+	if (auto app = QCoreApplication::instance())
+	{
+		moveToThread(app->thread());
+		m_timer.moveToThread(app->thread());
+	}
+}
+
+SaveScheduler::~SaveScheduler()
+{
+	flush();
+}
+
+static QString normalizedPath(const QString &path)
+{
+	return QDir::cleanPath(QFileInfo(path).absoluteFilePath());
+}
+
+static bool isUnder(const QString &path, const QString &prefix)
+{
+	if (prefix.isEmpty() || path == prefix)
+	{
+		return true;
+	}
+	return path.startsWith(prefix + '/');
+}
+
+void SaveScheduler::schedule(const QString &fileName, const QByteArray &data)
+{
+	{
+		QMutexLocker locker(&m_mutex);
+		const auto key = normalizedPath(fileName);
+		const auto now = m_clock.elapsed();
+		auto iter = m_pending.find(key);
+		if (iter == m_pending.end())
+		{
+			m_pending.insert(key, {data, now + m_delay, now + m_maxDelay});
+		}
+		else
+		{
+			iter->data = data;
+			iter->due = qMin(now + m_delay, iter->deadline);
+		}
+	}
+	if (QThread::currentThread() == thread())
+	{
+		arm();
+	}
+	else
+	{
+		QMetaObject::invokeMethod(this, "arm", Qt::QueuedConnection);
+	}
+}
+
+void SaveScheduler::arm()
+{
+	QMutexLocker locker(&m_mutex);
+	if (m_pending.isEmpty())
+	{
+		m_timer.stop();
+		return;
+	}
+	qint64 next = std::numeric_limits<qint64>::max();
+	for (auto &pending : m_pending)
+	{
+		next = qMin(next, pending.due);
+	}
+	m_timer.start(int(qMax<qint64>(0, next - m_clock.elapsed())));
+}
+
+void SaveScheduler::timeout()
+{
+	{
+		QMutexLocker locker(&m_mutex);
+		const auto now = m_clock.elapsed();
+		auto iter = m_pending.begin();
+		while (iter != m_pending.end())
+		{
+			if (iter->due <= now)
+			{
+				submit(iter.key(), iter->data);
+				iter = m_pending.erase(iter);
+			}
+			else
+			{
+				iter++;
+			}
+		}
+	}
+	arm();
+}
+
+void SaveScheduler::submit(const QString &fileName, const QByteArray &data)
+{
+	m_writer.start(new WriteRunnable(fileName, data, m_writeCount));
+}
+
+void SaveScheduler::takePending(const QString &pathPrefix, bool write)
+{
+	const auto prefix = pathPrefix.isEmpty() ? QString() : normalizedPath(pathPrefix);
+	{
+		QMutexLocker locker(&m_mutex);
+		auto iter = m_pending.begin();
+		while (iter != m_pending.end())
+		{
+			if (isUnder(iter.key(), prefix))
+			{
+				if (write)
+				{
+					submit(iter.key(), iter->data);
+				}
+				iter = m_pending.erase(iter);
+			}
+			else
+			{
+				iter++;
+			}
+		}
+	}
+	m_writer.waitForDone();
+}
+
+void SaveScheduler::flush(const QString &pathPrefix)
+{
+	takePending(pathPrefix, true);
+}
+
+void SaveScheduler::discard(const QString &pathPrefix)
+{
+	takePending(pathPrefix, false);
+}
+
+void SaveScheduler::setDelay(int delay, int maxDelay)
+{
+	QMutexLocker locker(&m_mutex);
+	m_delay = delay;
+	m_maxDelay = qMax(delay, maxDelay);
+}
+
+int SaveScheduler::writeCount() const
+{
+	return m_writeCount.load();
+}
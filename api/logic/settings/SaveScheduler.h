@@ -0,0 +1,85 @@
+/* Copyright 2013-2017 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QMutex>
+#include <QHash>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+
+#include "multimc_logic_export.h"
+
+/*!
+ * \brief Write-behind queue for small configuration files.
+ *
+ * Settings objects hand their serialized contents over instead of writing the file themselves.
+ * Saves of the same file are coalesced until the file has been quiet for a while and then
+ * written, in order, on a single background thread.
+ *
+ * Anything that reads, moves or deletes a settings file behind the settings object's back
+ * has to flush() or discard() it first.
+ */
+class MULTIMC_LOGIC_EXPORT SaveScheduler : public QObject
+{
+	Q_OBJECT
+public:
+	static SaveScheduler &instance();
+
+	/// Queue data to be written to fileName, replacing whatever is pending for that file
+	void schedule(const QString &fileName, const QByteArray &data);
+
+	/// Write pending files under pathPrefix (all files if empty) and wait until they are written
+	void flush(const QString &pathPrefix = QString());
+
+	/// Drop pending files under pathPrefix without writing them and wait for writes in progress
+	void discard(const QString &pathPrefix);
+
+	/// Set how long a file has to be quiet before it is written, and the longest a write can be held back
+	void setDelay(int delay, int maxDelay);
+
+	/// Number of files written since startup
+	int writeCount() const;
+
+private slots:
+	void arm();
+	void timeout();
+
+private:
+	explicit SaveScheduler(QObject *parent = 0);
+	~SaveScheduler();
+
+	struct PendingWrite
+	{
+		QByteArray data;
+		qint64 due;
+		qint64 deadline;
+	};
+	void submit(const QString &fileName, const QByteArray &data);
+	void takePending(const QString &pathPrefix, bool write);
+
+private:
+	QMutex m_mutex;
+	QHash<QString, PendingWrite> m_pending;
+	QElapsedTimer m_clock;
+	QTimer m_timer;
+	QThreadPool m_writer;
+	QAtomicInt m_writeCount;
+	int m_delay = 500;
+	int m_maxDelay = 3000;
+};
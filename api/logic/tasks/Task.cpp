@@ -14,9 +14,26 @@
  */
 
 #include "Task.h"
+#include "Metrics.h"
 
 #include <QDebug>
 
+static void recordMetrics(Task *task, qint64 start, Metrics::Result result)
+{
+	// not started while metrics were being recorded
+	if(start < 0)
+	{
+		return;
+	}
+	Metrics::TaskRecord record;
+	record.name = task->objectName();
+	record.type = task->metaObject()->className();
+	record.start = start;
+	record.duration = Metrics::now() - start;
+	record.result = result;
+	Metrics::record(record);
+}
+
 Task::Task(QObject *parent) : QObject(parent)
 {
 }
@@ -40,6 +57,7 @@ void Task::setProgress(qint64 current, qint64 total)
 void Task::start()
 {
 	m_running = true;
+	m_metricsStart = Metrics::now();
 	emit started();
 	qDebug() << "Task" << describe() << "started";
 	executeTask();
@@ -58,6 +76,7 @@ void Task::emitFailed(QString reason)
 	m_succeeded = false;
 	m_failReason = reason;
 	qCritical() << "Task" << describe() << "failed: " << reason;
+	recordMetrics(this, m_metricsStart, Metrics::Result::Failed);
 	emit failed(reason);
 	emit finished();
 }
@@ -75,6 +94,7 @@ void Task::emitAborted()
 	m_succeeded = false;
 	m_failReason = "Aborted.";
 	qDebug() << "Task" << describe() << "aborted.";
+	recordMetrics(this, m_metricsStart, Metrics::Result::Aborted);
 	emit failed(m_failReason);
 	emit finished();
 }
@@ -91,6 +111,7 @@ void Task::emitSucceeded()
 	m_finished = true;
 	m_succeeded = true;
 	qDebug() << "Task" << describe() << "succeeded";
+	recordMetrics(this, m_metricsStart, Metrics::Result::Succeeded);
 	emit succeeded();
 	emit finished();
 }
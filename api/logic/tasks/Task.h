@@ -87,7 +87,9 @@ private:
 	bool m_succeeded = false;
 	QString m_failReason = "";
 	QString m_status;
-	int m_progress = 0;
-	int m_progressTotal = 100;
+	qint64 m_progress = 0;
+	qint64 m_progressTotal = 100;
+	// when the task started, for Metrics
+	qint64 m_metricsStart = -1;
 };
 
@@ -0,0 +1,216 @@
+#include "TaskGraph.h"
+
+#include <QDebug>
+
+// every task is worth this many progress units per unit of weight
+static const qint64 progressScale = 1000;
+
+TaskGraph::TaskGraph(QObject *parent) : Task(parent)
+{
+}
+
+bool TaskGraph::addTask(std::shared_ptr<Task> task, QList<std::shared_ptr<Task>> dependsOn, qint64 weight)
+{
+	if(!task || m_indexes.contains(task.get()))
+	{
+		qWarning() << "TaskGraph: ignoring null or duplicate task" << task.get();
+		return false;
+	}
+	Node node;
+	node.task = task;
+	node.weight = qMax<qint64>(weight, 0);
+	for(auto dependency: dependsOn)
+	{
+		auto iter = m_indexes.constFind(dependency.get());
+		if(iter == m_indexes.constEnd())
+		{
+			qWarning() << "TaskGraph: dependency" << dependency.get() << "of" << task.get() << "was not added first";
+			return false;
+		}
+		node.dependsOn.append(*iter);
+	}
+	m_indexes.insert(task.get(), m_nodes.size());
+	m_nodes.append(node);
+	return true;
+}
+
+void TaskGraph::executeTask()
+{
+	m_done = false;
+	m_succeeded = 0;
+	for(int i = 0; i < m_nodes.size(); i++)
+	{
+		auto &node = m_nodes[i];
+		node.state = State::Waiting;
+		node.current = 0;
+		node.total = 0;
+	}
+	updateProgress();
+	startReady();
+}
+
+void TaskGraph::startReady()
+{
+	// tasks are started in the order they were added, so a task can rely on side effects of
+	// another one with the same dependencies starting before it
+	for(int i = 0; i < m_nodes.size() && !m_done; i++)
+	{
+		auto &node = m_nodes[i];
+		if(node.state != State::Waiting)
+		{
+			continue;
+		}
+		bool ready = true;
+		for(auto dependency: node.dependsOn)
+		{
+			if(m_nodes[dependency].state != State::Succeeded)
+			{
+				ready = false;
+				break;
+			}
+		}
+		if(!ready)
+		{
+			continue;
+		}
+		auto task = node.task;
+		node.state = State::Running;
+		// shared tasks may have been started, or even finished, by someone else already
+		if(task->isFinished())
+		{
+			if(task->wasSuccessful())
+			{
+				finishNode(i);
+				// finishing can make earlier tasks ready
+				i = -1;
+				continue;
+			}
+			subTaskFailed(task->failReason());
+			return;
+		}
+		connect(task.get(), &Task::succeeded, this, &TaskGraph::subTaskSucceeded);
+		connect(task.get(), &Task::failed, this, &TaskGraph::subTaskFailed);
+		connect(task.get(), &Task::status, this, &TaskGraph::subTaskStatus);
+		connect(task.get(), &Task::progress, this, &TaskGraph::subTaskProgress);
+		if(!task->isRunning())
+		{
+			task->start();
+		}
+	}
+	if(!m_done && m_succeeded == m_nodes.size())
+	{
+		m_done = true;
+		emitSucceeded();
+	}
+}
+
+void TaskGraph::finishNode(int index)
+{
+	auto &node = m_nodes[index];
+	disconnect(node.task.get(), 0, this, 0);
+	node.state = State::Succeeded;
+	m_succeeded++;
+	updateProgress();
+}
+
+int TaskGraph::indexOf(QObject *task) const
+{
+	return m_indexes.value(qobject_cast<Task *>(task), -1);
+}
+
+void TaskGraph::subTaskSucceeded()
+{
+	int index = indexOf(sender());
+	if(m_done || index < 0)
+	{
+		return;
+	}
+	finishNode(index);
+	startReady();
+}
+
+void TaskGraph::subTaskFailed(const QString &msg)
+{
+	if(m_done)
+	{
+		return;
+	}
+	stop();
+	emitFailed(msg);
+}
+
+void TaskGraph::subTaskStatus(const QString &msg)
+{
+	setStatus(msg);
+}
+
+void TaskGraph::subTaskProgress(qint64 current, qint64 total)
+{
+	int index = indexOf(sender());
+	if(m_done || index < 0)
+	{
+		return;
+	}
+	auto &node = m_nodes[index];
+	node.current = current;
+	node.total = total;
+	updateProgress();
+}
+
+void TaskGraph::updateProgress()
+{
+	qint64 current = 0;
+	qint64 total = 0;
+	for(auto &node: m_nodes)
+	{
+		auto units = node.weight * progressScale;
+		total += units;
+		if(node.state == State::Succeeded)
+		{
+			current += units;
+		}
+		else if(node.total > 0)
+		{
+			current += units * qBound<qint64>(0, node.current, node.total) / node.total;
+		}
+	}
+	if(total == 0)
+	{
+		setProgress(0, 100);
+		return;
+	}
+	setProgress(current, total);
+}
+
+void TaskGraph::stop()
+{
+	m_done = true;
+	for(auto &node: m_nodes)
+	{
+		if(node.state != State::Running)
+		{
+			continue;
+		}
+		disconnect(node.task.get(), 0, this, 0);
+		if(node.task->isRunning() && node.task->canAbort())
+		{
+			node.task->abort();
+		}
+	}
+}
+
+bool TaskGraph::canAbort() const
+{
+	return true;
+}
+
+bool TaskGraph::abort()
+{
+	if(m_done || !isRunning())
+	{
+		return false;
+	}
+	stop();
+	emitAborted();
+	return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Task.h"
+
+#include <QList>
+#include <QHash>
+#include <memory>
+
+#include "multimc_logic_export.h"
+
+/**
+ * Runs a set of tasks, each one as soon as all the tasks it depends on have succeeded.
+ *
+ * Dependencies have to be added to the graph before the tasks that depend on them, so the graph
+ * can't contain cycles. A graph where every task depends on the one added before it behaves like
+ * a SequentialTask.
+ *
+ * Progress is combined from all the tasks, each counting as much as its weight. The first failure
+ * aborts everything that is still running and fails the whole graph.
+ */
+class MULTIMC_LOGIC_EXPORT TaskGraph : public Task
+{
+	Q_OBJECT
+public:
+	explicit TaskGraph(QObject *parent = 0);
+
+	/// Adds a task that starts after all of \p dependsOn succeeded. Returns false for unknown dependencies.
+	bool addTask(std::shared_ptr<Task> task, QList<std::shared_ptr<Task>> dependsOn = {}, qint64 weight = 1);
+
+	bool canAbort() const override;
+
+public slots:
+	bool abort() override;
+
+protected:
+	void executeTask() override;
+
+private
+slots:
+	void subTaskSucceeded();
+	void subTaskFailed(const QString &msg);
+	void subTaskStatus(const QString &msg);
+	void subTaskProgress(qint64 current, qint64 total);
+
+private:
+	enum class State
+	{
+		Waiting,
+		Running,
+		Succeeded
+	};
+	struct Node
+	{
+		std::shared_ptr<Task> task;
+		QList<int> dependsOn;
+		qint64 weight = 1;
+		State state = State::Waiting;
+		qint64 current = 0;
+		qint64 total = 0;
+	};
+
+	int indexOf(QObject *task) const;
+	void startReady();
+	void finishNode(int index);
+	void updateProgress();
+	void stop();
+
+private:
+	QList<Node> m_nodes;
+	QHash<Task *, int> m_indexes;
+	int m_succeeded = 0;
+	bool m_done = false;
+};
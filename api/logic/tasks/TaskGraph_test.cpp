@@ -0,0 +1,177 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "tasks/TaskGraph.h"
+
+// finishes only when told to, so the test decides the order things complete in
+class ManualTask : public Task
+{
+	Q_OBJECT
+public:
+	bool canAbort() const override
+	{
+		return true;
+	}
+	void succeed()
+	{
+		emitSucceeded();
+	}
+	void fail(const QString &reason)
+	{
+		emitFailed(reason);
+	}
+	void report(qint64 current, qint64 total)
+	{
+		setProgress(current, total);
+	}
+	bool aborted = false;
+
+public slots:
+	bool abort() override
+	{
+		aborted = true;
+		emitAborted();
+		return true;
+	}
+
+protected:
+	void executeTask() override
+	{
+	}
+};
+
+class TaskGraphTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_Empty()
+	{
+		TaskGraph graph;
+		graph.start();
+		QVERIFY(graph.isFinished());
+		QVERIFY(graph.wasSuccessful());
+	}
+
+	void test_Dependencies()
+	{
+		auto folders = std::make_shared<ManualTask>();
+		auto meta = std::make_shared<ManualTask>();
+		auto libraries = std::make_shared<ManualTask>();
+		auto assets = std::make_shared<ManualTask>();
+		auto fml = std::make_shared<ManualTask>();
+
+		TaskGraph graph;
+		QVERIFY(graph.addTask(folders));
+		QVERIFY(graph.addTask(meta));
+		QVERIFY(graph.addTask(libraries, {meta}));
+		QVERIFY(graph.addTask(assets, {meta}));
+		QVERIFY(graph.addTask(fml, {folders, libraries}));
+		graph.start();
+
+		QVERIFY(folders->isRunning());
+		QVERIFY(meta->isRunning());
+		QVERIFY(!libraries->isRunning());
+
+		meta->succeed();
+		// both downloads run at the same time
+		QVERIFY(libraries->isRunning());
+		QVERIFY(assets->isRunning());
+
+		libraries->succeed();
+		QVERIFY(!fml->isRunning());
+		folders->succeed();
+		QVERIFY(fml->isRunning());
+
+		fml->succeed();
+		QVERIFY(!graph.isFinished());
+		assets->succeed();
+		QVERIFY(graph.isFinished());
+		QVERIFY(graph.wasSuccessful());
+	}
+
+	void test_FailureAbortsEverything()
+	{
+		auto first = std::make_shared<ManualTask>();
+		auto second = std::make_shared<ManualTask>();
+		auto dependent = std::make_shared<ManualTask>();
+
+		TaskGraph graph;
+		graph.addTask(first);
+		graph.addTask(second);
+		graph.addTask(dependent, {first});
+		graph.start();
+
+		first->fail("broken");
+		QVERIFY(graph.isFinished());
+		QVERIFY(!graph.wasSuccessful());
+		QCOMPARE(graph.failReason(), QString("broken"));
+		QVERIFY(second->aborted);
+		QVERIFY(!dependent->isRunning());
+		QVERIFY(!dependent->isFinished());
+	}
+
+	void test_Abort()
+	{
+		auto task = std::make_shared<ManualTask>();
+		TaskGraph graph;
+		graph.addTask(task);
+		graph.start();
+		QVERIFY(graph.abort());
+		QVERIFY(task->aborted);
+		QVERIFY(graph.isFinished());
+		QVERIFY(!graph.wasSuccessful());
+	}
+
+	void test_WeightedProgress()
+	{
+		auto small = std::make_shared<ManualTask>();
+		auto big = std::make_shared<ManualTask>();
+		TaskGraph graph;
+		graph.addTask(small, {}, 1);
+		graph.addTask(big, {}, 3);
+		graph.start();
+		QCOMPARE(graph.getProgress(), qint64(0));
+
+		big->report(50, 100);
+		QCOMPARE(graph.getProgress() * 8, graph.getTotalProgress() * 3);
+		small->succeed();
+		QCOMPARE(graph.getProgress() * 8, graph.getTotalProgress() * 5);
+		big->succeed();
+		QCOMPARE(graph.getProgress(), graph.getTotalProgress());
+	}
+
+	void test_SharedTasks()
+	{
+		// tasks can be shared with other users, they may be running or done already
+		auto done = std::make_shared<ManualTask>();
+		done->start();
+		done->succeed();
+		auto running = std::make_shared<ManualTask>();
+		running->start();
+		auto dependent = std::make_shared<ManualTask>();
+
+		TaskGraph graph;
+		graph.addTask(done);
+		graph.addTask(running);
+		graph.addTask(dependent, {done, running});
+		graph.start();
+		QVERIFY(!dependent->isRunning());
+		running->succeed();
+		QVERIFY(dependent->isRunning());
+	}
+
+	void test_UnknownDependency()
+	{
+		auto task = std::make_shared<ManualTask>();
+		auto other = std::make_shared<ManualTask>();
+		TaskGraph graph;
+		QVERIFY(!graph.addTask(task, {other}));
+		QVERIFY(graph.addTask(task));
+		QVERIFY(!graph.addTask(task));
+	}
+};
+
+QTEST_GUILESS_MAIN(TaskGraphTest)
+
+#include "TaskGraph_test.moc"
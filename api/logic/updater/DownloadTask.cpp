@@ -18,20 +18,26 @@
 #include "updater/UpdateChecker.h"
 #include "GoUpdate.h"
 #include "net/NetJob.h"
+#include "net/ChecksumValidator.h"
+#include "FileSystem.h"
 
 #include <QFile>
 #include <QTemporaryDir>
 #include <QCryptographicHash>
+#include <QtConcurrentRun>
+#include <QtConcurrentMap>
 
 namespace GoUpdate
 {
 
 DownloadTask::DownloadTask(Status status, QString target, QObject *parent)
-	: Task(parent), m_updateFilesDir(target)
+	: Task(parent), m_hashes("cache/updater_hashes.json"), m_updateFilesDir(target)
 {
 	m_status = status;
 
 	m_updateFilesDir.setAutoRemove(false);
+	connect(&m_hashFutureWatcher, &QFutureWatcher<void>::finished, this, &DownloadTask::processFileListsAndDownload);
+	connect(&m_patchFutureWatcher, &QFutureWatcher<PatchList>::finished, this, &DownloadTask::patchesApplied);
 }
 
 void DownloadTask::executeTask()
@@ -83,9 +89,6 @@ void DownloadTask::vinfoDownloadFailed()
 
 void DownloadTask::processDownloadedVersionInfo()
 {
-	VersionFileList m_currentVersionFileList;
-	VersionFileList m_newVersionFileList;
-
 	setStatus(tr("Reading file list for new version..."));
 	qDebug() << "Reading file list for new version...";
 	QString error;
@@ -114,17 +117,39 @@ void DownloadTask::processDownloadedVersionInfo()
 	m_newVersionFileListDownload.reset();
 	m_vinfoNetJob.reset();
 
+	// Hash the installed files in the background. Unchanged files are not read again.
+	setStatus(tr("Checking installed files..."));
+	QStringList installedFiles;
+	for (auto &entry : m_newVersionFileList)
+	{
+		auto path = FS::PathCombine(m_status.rootPath, entry.path);
+		if (QFileInfo::exists(path))
+		{
+			installedFiles.append(path);
+		}
+	}
+	m_hashFuture = QtConcurrent::run([this, installedFiles]()
+	{
+		m_hashes.load();
+		m_hashes.hashFiles(installedFiles);
+	});
+	m_hashFutureWatcher.setFuture(m_hashFuture);
+}
+
+void DownloadTask::processFileListsAndDownload()
+{
 	setStatus(tr("Processing file lists - figuring out how to install the update..."));
 
 	// make a new netjob for the actual update files
 	NetJobPtr netJob (new NetJob("Update Files"));
 
 	// fill netJob and operationList
-	if (!processFileLists(m_currentVersionFileList, m_newVersionFileList, m_status.rootPath, m_updateFilesDir.path(), netJob, m_operations))
+	if (!processFileLists(m_currentVersionFileList, m_newVersionFileList, m_status.rootPath, m_updateFilesDir.path(), netJob, m_operations, &m_hashes, &m_patches))
 	{
 		emitFailed(tr("Failed to process update lists..."));
 		return;
 	}
+	m_hashes.save();
 
 	// Now start the download.
 	QObject::connect(netJob.get(), &NetJob::succeeded, this, &DownloadTask::fileDownloadFinished);
@@ -139,7 +164,64 @@ void DownloadTask::processDownloadedVersionInfo()
 
 void DownloadTask::fileDownloadFinished()
 {
-	emitSucceeded();
+	if (m_patches.isEmpty())
+	{
+		emitSucceeded();
+		return;
+	}
+
+	setStatus(tr("Applying %1 patches.").arg(m_patches.size()));
+	auto patches = m_patches;
+	m_patches.clear();
+	m_patchFuture = QtConcurrent::run([patches]() mutable
+	{
+		PatchList failed;
+		QMutex failedMutex;
+		QtConcurrent::blockingMap(patches, [&](const Patch &patch)
+		{
+			QString error;
+			if (!applyPatch(patch, error))
+			{
+				qWarning() << "Patch failed:" << error;
+				QMutexLocker locker(&failedMutex);
+				failed.append(patch);
+			}
+		});
+		return failed;
+	});
+	m_patchFutureWatcher.setFuture(m_patchFuture);
+}
+
+void DownloadTask::patchesApplied()
+{
+	auto failed = m_patchFuture.result();
+	if (failed.isEmpty())
+	{
+		emitSucceeded();
+		return;
+	}
+
+	// Get the whole files instead.
+	NetJobPtr netJob (new NetJob("Update Files"));
+	for (auto &patch : failed)
+	{
+		if (patch.fallbackUrl.isEmpty())
+		{
+			emitFailed(tr("Failed to patch %1 and there is nothing else to download.").arg(patch.source));
+			return;
+		}
+		auto download = Net::Download::makeFile(patch.fallbackUrl, patch.destination);
+		auto rawMd5 = QByteArray::fromHex(patch.md5.toLatin1());
+		download->addValidator(new Net::ChecksumValidator(QCryptographicHash::Md5, rawMd5));
+		netJob->addNetAction(download);
+	}
+	QObject::connect(netJob.get(), &NetJob::succeeded, this, &DownloadTask::fileDownloadFinished);
+	QObject::connect(netJob.get(), &NetJob::progress, this, &DownloadTask::fileDownloadProgressChanged);
+	QObject::connect(netJob.get(), &NetJob::failed, this, &DownloadTask::fileDownloadFailed);
+
+	setStatus(tr("Downloading %1 update files.").arg(QString::number(netJob->size())));
+	m_filesNetJob = netJob;
+	m_filesNetJob->start();
 }
 
 void DownloadTask::fileDownloadFailed(QString reason)
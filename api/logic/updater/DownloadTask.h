@@ -19,6 +19,9 @@
 #include "net/NetJob.h"
 #include "GoUpdate.h"
 
+#include <QFuture>
+#include <QFutureWatcher>
+
 #include "multimc_logic_export.h"
 
 namespace GoUpdate
@@ -73,8 +76,21 @@ protected:
 
 	Status m_status;
 
+	VersionFileList m_currentVersionFileList;
+	VersionFileList m_newVersionFileList;
+
 	OperationList m_operations;
 
+	//! Hashes of the installed files, kept between update checks.
+	HashCache m_hashes;
+	QFuture<void> m_hashFuture;
+	QFutureWatcher<void> m_hashFutureWatcher;
+
+	//! Patches to apply after the download, and the ones that didn't apply.
+	PatchList m_patches;
+	QFuture<PatchList> m_patchFuture;
+	QFutureWatcher<PatchList> m_patchFutureWatcher;
+
 	/*!
 	 * Temporary directory to store update files in.
 	 * This will be set to not auto delete. Task will fail if this fails to be created.
@@ -89,7 +105,14 @@ protected slots:
 	void processDownloadedVersionInfo();
 	void vinfoDownloadFailed();
 
+	/*!
+	 * Called when the installed files have been hashed in the background.
+	 * Figures out what to download and starts the download.
+	 */
+	void processFileListsAndDownload();
+
 	void fileDownloadFinished();
+	void patchesApplied();
 	void fileDownloadFailed(QString reason);
 	void fileDownloadProgressChanged(qint64 current, qint64 total);
 };
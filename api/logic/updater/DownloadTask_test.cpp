@@ -104,6 +104,21 @@ slots:
 														encodeBaseFile("/data/fileTwo"),
 														"38f94f54fa3eb72b0ea836538c10b043"})
 			<< QString() << true;
+		QTest::newRow("three")
+			<< MULTIMC_GET_TEST_FILE("data/3.json")
+			<< (VersionFileList()
+				<< VersionFileEntry{"fileOne",
+														493,
+														FileSourceList()
+															<< FileSource("delta", encodeBaseFile("/data/fileOneB-fileOneC.delta").first().url,
+																		  QString(), "42915a71277c9016668cce7b82c6b577")
+															<< encodeBaseFile("/data/fileOneC"),
+														"ff1fe13a0941f48afe36e2f17a0bc5bf"}
+				<< VersionFileEntry{"fileTwo",
+														644,
+														encodeBaseFile("/data/fileTwo"),
+														"38f94f54fa3eb72b0ea836538c10b043"})
+			<< QString() << true;
 	}
 	void test_parseVersionInfo()
 	{
@@ -186,6 +201,103 @@ slots:
 		QCOMPARE(operations, expectedOperations);
 	}
 
+	void test_processFileLists_delta()
+	{
+		QTemporaryDir tempFolderObj;
+		QString tempFolder = tempFolderObj.path();
+		// data/fileOneB is installed, there is a delta from it to the new version
+		VersionFileList newVersion = VersionFileList()
+			<< VersionFileEntry{
+				   "data/fileOneB", 493,
+				   FileSourceList()
+					   << FileSource("delta", "http://host/path/fileOne-2-3.delta", QString(),
+									 "42915a71277c9016668cce7b82c6b577")
+					   << FileSource("http", "http://host/path/fileOne-3"),
+				   "ff1fe13a0941f48afe36e2f17a0bc5bf"}
+			<< VersionFileEntry{
+				   "data/fileTwo", 644,
+				   FileSourceList()
+					   << FileSource("delta", "http://host/path/fileTwo-1-2.delta", QString(),
+									 "00000000000000000000000000000000")
+					   << FileSource("http", "http://host/path/fileTwo-2"),
+				   "38f94f54fa3eb72b0ea836538c10b043"};
+
+		QString dlPath = FS::PathCombine(tempFolder, "data_fileOneB");
+		OperationList expectedOperations = OperationList()
+			<< Operation::CopyOp(dlPath, "data/fileOneB", 493);
+		PatchList expectedPatches = PatchList()
+			<< Patch{FS::PathCombine(QDir::currentPath(), "data/fileOneB"), dlPath + ".delta", dlPath,
+					 "ff1fe13a0941f48afe36e2f17a0bc5bf", "http://host/path/fileOne-3"};
+
+		OperationList operations;
+		PatchList patches;
+		HashCache hashes;
+		NetJobPtr job(new NetJob("Dummy"));
+		QVERIFY(processFileLists(VersionFileList(), newVersion, QDir::currentPath(), tempFolder, job, operations, &hashes, &patches));
+		QCOMPARE(operations, expectedOperations);
+		QCOMPARE(patches, expectedPatches);
+		// only the delta is downloaded
+		QCOMPARE(job->size(), 1);
+		QCOMPARE(job->first()->url(), QUrl("http://host/path/fileOne-2-3.delta"));
+
+		// without a patch list, the whole file is downloaded
+		operations.clear();
+		NetJobPtr fullJob(new NetJob("Dummy"));
+		QVERIFY(processFileLists(VersionFileList(), newVersion, QDir::currentPath(), tempFolder, fullJob, operations, &hashes));
+		QCOMPARE(operations, expectedOperations);
+		QCOMPARE(fullJob->size(), 1);
+		QCOMPARE(fullJob->first()->url(), QUrl("http://host/path/fileOne-3"));
+	}
+
+	void test_applyPatch()
+	{
+		QTemporaryDir tempFolderObj;
+		QString destination = FS::PathCombine(tempFolderObj.path(), "fileOneC");
+		Patch patch{"data/fileOneB", "data/fileOneB-fileOneC.delta", destination,
+					"ff1fe13a0941f48afe36e2f17a0bc5bf", QString()};
+		QString error;
+		QVERIFY(applyPatch(patch, error));
+		QCOMPARE(error, QString());
+		QCOMPARE(FS::read(destination), FS::read("data/fileOneC"));
+
+		// applied to the wrong file, the result doesn't match and nothing is written
+		QString wrongDestination = FS::PathCombine(tempFolderObj.path(), "wrong");
+		Patch wrongPatch{"data/fileTwo", "data/fileOneB-fileOneC.delta", wrongDestination,
+						 "ff1fe13a0941f48afe36e2f17a0bc5bf", QString()};
+		QVERIFY(!applyPatch(wrongPatch, error));
+		QVERIFY(!QFile::exists(wrongDestination));
+
+		// not a patch at all
+		Patch notAPatch{"data/fileOneB", "data/fileTwo", wrongDestination,
+						"ff1fe13a0941f48afe36e2f17a0bc5bf", QString()};
+		QVERIFY(!applyPatch(notAPatch, error));
+		QVERIFY(!QFile::exists(wrongDestination));
+	}
+
+	void test_HashCache()
+	{
+		QTemporaryDir tempFolderObj;
+		QString cacheFile = FS::PathCombine(tempFolderObj.path(), "hashes.json");
+		{
+			HashCache hashes(cacheFile);
+			hashes.load();
+			hashes.hashFiles({"data/fileOneA", "data/fileTwo"});
+			QCOMPARE(hashes.hashedCount(), 2);
+			QCOMPARE(hashes.md5("data/fileTwo"), QString("38f94f54fa3eb72b0ea836538c10b043"));
+			QCOMPARE(hashes.md5("data/nonexistent"), QString());
+			// nothing changed, nothing is read again
+			QCOMPARE(hashes.hashedCount(), 2);
+			QVERIFY(hashes.save());
+		}
+		{
+			HashCache hashes(cacheFile);
+			hashes.load();
+			QCOMPARE(hashes.md5("data/fileOneA"), QString("9eb84090956c484e32cb6c08455a667b"));
+			QCOMPARE(hashes.md5("data/fileTwo"), QString("38f94f54fa3eb72b0ea836538c10b043"));
+			QCOMPARE(hashes.hashedCount(), 0);
+		}
+	}
+
 	void test_OSXPathFixup()
 	{
 		QString path, pathOrig;
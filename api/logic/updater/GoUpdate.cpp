@@ -2,6 +2,14 @@
 #include <QDebug>
 #include <QDomDocument>
 #include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QDataStream>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QtConcurrentMap>
 #include <FileSystem.h>
 
 #include "net/Download.h"
@@ -54,6 +62,11 @@ bool parseVersionInfo(const QByteArray &data, VersionFileList &list, QString &er
 			{
 				file.sources.append(FileSource("http", sourceObj.value("Url").toString()));
 			}
+			else if (type == "delta")
+			{
+				file.sources.append(FileSource("delta", sourceObj.value("Url").toString(), QString(),
+											   sourceObj.value("From").toString()));
+			}
 			else
 			{
 				qWarning() << "Unknown source type" << type << "ignored.";
@@ -68,6 +81,130 @@ bool parseVersionInfo(const QByteArray &data, VersionFileList &list, QString &er
 	return true;
 }
 
+HashCache::HashCache(const QString &cacheFile) : m_cacheFile(cacheFile)
+{
+}
+
+void HashCache::load()
+{
+	if (m_cacheFile.isEmpty() || !QFile::exists(m_cacheFile))
+	{
+		return;
+	}
+	QByteArray data;
+	try
+	{
+		data = FS::read(m_cacheFile);
+	}
+	catch (FS::FileSystemException &e)
+	{
+		qWarning() << "Unable to read the update hash cache:" << e.cause();
+		return;
+	}
+	auto files = QJsonDocument::fromJson(data).object().value("files").toArray();
+	QMutexLocker locker(&m_mutex);
+	for (auto fileValue : files)
+	{
+		auto fileObj = fileValue.toObject();
+		auto path = fileObj.value("path").toString();
+		if (path.isEmpty())
+		{
+			continue;
+		}
+		Entry entry;
+		entry.size = fileObj.value("size").toVariant().toLongLong();
+		entry.mtime = fileObj.value("mtime").toVariant().toLongLong();
+		entry.md5 = fileObj.value("md5").toString();
+		m_entries.insert(path, entry);
+	}
+}
+
+bool HashCache::save()
+{
+	QMutexLocker locker(&m_mutex);
+	if (m_cacheFile.isEmpty() || !m_dirty)
+	{
+		return true;
+	}
+	QJsonArray files;
+	for (auto iter = m_entries.begin(); iter != m_entries.end(); iter++)
+	{
+		QJsonObject fileObj;
+		fileObj.insert("path", iter.key());
+		// as strings, JSON numbers are doubles
+		fileObj.insert("size", QString::number(iter->size));
+		fileObj.insert("mtime", QString::number(iter->mtime));
+		fileObj.insert("md5", iter->md5);
+		files.append(fileObj);
+	}
+	QJsonObject root;
+	root.insert("formatVersion", 1);
+	root.insert("files", files);
+	try
+	{
+		FS::write(m_cacheFile, QJsonDocument(root).toJson(QJsonDocument::Compact));
+	}
+	catch (FS::FileSystemException &e)
+	{
+		qWarning() << "Unable to save the update hash cache:" << e.cause();
+		return false;
+	}
+	m_dirty = false;
+	return true;
+}
+
+QString HashCache::md5(const QString &path)
+{
+	QFileInfo info(path);
+	if (!info.isFile())
+	{
+		return QString();
+	}
+	auto absolutePath = info.absoluteFilePath();
+	auto size = info.size();
+	auto mtime = info.lastModified().toMSecsSinceEpoch();
+	{
+		QMutexLocker locker(&m_mutex);
+		auto iter = m_entries.find(absolutePath);
+		if (iter != m_entries.end() && iter->size == size && iter->mtime == mtime)
+		{
+			return iter->md5;
+		}
+	}
+
+	QFile file(absolutePath);
+	if (!file.open(QFile::ReadOnly))
+	{
+		return QString();
+	}
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	if (!hash.addData(&file))
+	{
+		return QString();
+	}
+	QString result = hash.result().toHex();
+
+	QMutexLocker locker(&m_mutex);
+	m_entries.insert(absolutePath, Entry{size, mtime, result});
+	m_dirty = true;
+	m_hashedCount++;
+	return result;
+}
+
+void HashCache::hashFiles(QStringList paths)
+{
+	QtConcurrent::blockingMap(paths, [this](const QString &path)
+	{
+		md5(path);
+	});
+}
+
+int HashCache::hashedCount() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_hashedCount;
+}
+
 bool processFileLists
 (
 	const VersionFileList &currentVersion,
@@ -75,12 +212,19 @@ bool processFileLists
 	const QString &rootPath,
 	const QString &tempPath,
 	NetJobPtr job,
-	OperationList &ops
+	OperationList &ops,
+	HashCache *hashes,
+	PatchList *patches
 )
 {
 	// First, if we've loaded the current version's file list, we need to iterate through it and
 	// delete anything in the current one version's list that isn't in the new version's list.
-	for (VersionFileEntry entry : currentVersion)
+	QSet<QString> newPaths;
+	for (const VersionFileEntry &newEntry : newVersion)
+	{
+		newPaths.insert(newEntry.path);
+	}
+	for (const VersionFileEntry &entry : currentVersion)
 	{
 		QFileInfo toDelete(FS::PathCombine(rootPath, entry.path));
 		if (!toDelete.exists())
@@ -88,89 +232,79 @@ bool processFileLists
 			qCritical() << "Expected file " << toDelete.absoluteFilePath()
 						 << " doesn't exist!";
 		}
-		bool keep = false;
 
-		//
-		for (VersionFileEntry newEntry : newVersion)
+		if (newPaths.contains(entry.path))
 		{
-			if (newEntry.path == entry.path)
-			{
-				qDebug() << "Not deleting" << entry.path
-							 << "because it is still present in the new version.";
-				keep = true;
-				break;
-			}
+			qDebug() << "Not deleting" << entry.path
+						 << "because it is still present in the new version.";
+			continue;
 		}
 
-		// If the loop reaches the end and we didn't find a match, delete the file.
-		if (!keep)
-		{
-			if (toDelete.exists())
-				ops.append(Operation::DeleteOp(entry.path));
-		}
+		// It's not in the new version, delete the file.
+		if (toDelete.exists())
+			ops.append(Operation::DeleteOp(entry.path));
 	}
 
-	// Next, check each file in MultiMC's folder and see if we need to update them.
-	for (VersionFileEntry entry : newVersion)
+	// Next, check that the installed files we'll look at are usable.
+	QStringList installedFiles;
+	for (const VersionFileEntry &entry : newVersion)
 	{
-		// TODO: Let's not MD5sum a ton of files on the GUI thread. We should probably find a
-		// way to do this in the background.
-		QString fileMD5;
 		QString realEntryPath = FS::PathCombine(rootPath, entry.path);
-		QFile entryFile(realEntryPath);
 		QFileInfo entryInfo(realEntryPath);
-
-		bool needs_upgrade = false;
-		if (!entryFile.exists())
+		if (!entryInfo.exists())
 		{
-			needs_upgrade = true;
+			continue;
 		}
-		else
+		bool pass = true;
+		if (!entryInfo.isReadable())
 		{
-			bool pass = true;
-			if (!entryInfo.isReadable())
-			{
-				qCritical() << "File " << realEntryPath << " is not readable.";
-				pass = false;
-			}
-			if (!entryInfo.isWritable())
-			{
-				qCritical() << "File " << realEntryPath << " is not writable.";
-				pass = false;
-			}
-			if (!entryFile.open(QFile::ReadOnly))
+			qCritical() << "File " << realEntryPath << " is not readable.";
+			pass = false;
+		}
+		if (!entryInfo.isWritable())
+		{
+			qCritical() << "File " << realEntryPath << " is not writable.";
+			pass = false;
+		}
+		if (!pass)
+		{
+			ops.clear();
+			return false;
+		}
+		installedFiles.append(realEntryPath);
+	}
+
+	// Hash them all at once, skipping the ones that didn't change since the last time.
+	HashCache localHashes;
+	if (!hashes)
+	{
+		hashes = &localHashes;
+	}
+	hashes->hashFiles(installedFiles);
+
+	// And see which of them need an update.
+	for (const VersionFileEntry &entry : newVersion)
+	{
+		QString realEntryPath = FS::PathCombine(rootPath, entry.path);
+		QString fileMD5;
+		if (QFileInfo::exists(realEntryPath))
+		{
+			fileMD5 = hashes->md5(realEntryPath);
+			if (fileMD5.isEmpty())
 			{
 				qCritical() << "File " << realEntryPath << " cannot be opened for reading.";
-				pass = false;
-			}
-			if (!pass)
-			{
 				ops.clear();
 				return false;
 			}
-		}
-
-		if(!needs_upgrade)
-		{
-			QCryptographicHash hash(QCryptographicHash::Md5);
-			auto foo = entryFile.readAll();
-
-			hash.addData(foo);
-			fileMD5 = hash.result().toHex();
-			if ((fileMD5 != entry.md5))
+			if (fileMD5 == entry.md5)
 			{
-				qDebug() << "MD5Sum does not match!";
-				qDebug() << "Expected:'" << entry.md5 << "'";
-				qDebug() << "Got:     '" << fileMD5 << "'";
-				needs_upgrade = true;
+				// skip file. it doesn't need an upgrade.
+				qDebug() << "File" << realEntryPath << " does not need updating.";
+				continue;
 			}
-		}
-
-		// skip file. it doesn't need an upgrade.
-		if (!needs_upgrade)
-		{
-			qDebug() << "File" << realEntryPath << " does not need updating.";
-			continue;
+			qDebug() << "MD5Sum does not match!";
+			qDebug() << "Expected:'" << entry.md5 << "'";
+			qDebug() << "Got:     '" << fileMD5 << "'";
 		}
 
 		// yep. this file actually needs an upgrade. PROCEED.
@@ -178,21 +312,41 @@ bool processFileLists
 
 		// Go through the sources list and find one to use.
 		// TODO: Make a NetAction that takes a source list and tries each of them until one
-		// works. For now, we'll just use the first http one.
-		for (FileSource source : entry.sources)
+		// works. For now, we'll just use the first http one, or a delta for the installed file.
+		const FileSource *full = nullptr;
+		const FileSource *delta = nullptr;
+		for (const FileSource &source : entry.sources)
 		{
-			if (source.type != "http")
-				continue;
-
-			qDebug() << "Will download" << entry.path << "from" << source.url;
+			if (source.type == "http" && !full)
+			{
+				full = &source;
+			}
+			else if (source.type == "delta" && !delta && patches && !fileMD5.isEmpty() &&
+					 source.fromMD5 == fileMD5)
+			{
+				delta = &source;
+			}
+		}
 
-			// Download it to updatedir/<filepath>-<md5> where filepath is the file's
-			// path with slashes replaced by underscores.
-			QString dlPath = FS::PathCombine(tempPath, QString(entry.path).replace("/", "_"));
+		// Download it to updatedir/<filepath> where filepath is the file's
+		// path with slashes replaced by underscores.
+		QString dlPath = FS::PathCombine(tempPath, QString(entry.path).replace("/", "_"));
+		if (delta)
+		{
+			// The patch is applied to the installed file once everything is downloaded.
+			qDebug() << "Will patch" << entry.path << "from" << delta->url;
+			QString deltaPath = dlPath + ".delta";
+			job->addNetAction(Net::Download::makeFile(delta->url, deltaPath));
+			patches->append(Patch{realEntryPath, deltaPath, dlPath, entry.md5, full ? full->url : QString()});
+			ops.append(Operation::CopyOp(dlPath, entry.path, entry.mode));
+		}
+		else if (full)
+		{
+			qDebug() << "Will download" << entry.path << "from" << full->url;
 
 			// We need to download the file to the updatefiles folder and add a task
 			// to copy it to its install path.
-			auto download = Net::Download::makeFile(source.url, dlPath);
+			auto download = Net::Download::makeFile(full->url, dlPath);
 			auto rawMd5 = QByteArray::fromHex(entry.md5.toLatin1());
 			download->addValidator(new Net::ChecksumValidator(QCryptographicHash::Md5, rawMd5));
 			job->addNetAction(download);
@@ -202,6 +356,106 @@ bool processFileLists
 	return true;
 }
 
+bool applyPatch(const Patch &patch, QString &error)
+{
+	QFile source(patch.source);
+	if (!source.open(QFile::ReadOnly))
+	{
+		error = QString("Can't open %1 for reading").arg(patch.source);
+		return false;
+	}
+	QFile delta(patch.delta);
+	if (!delta.open(QFile::ReadOnly))
+	{
+		error = QString("Can't open %1 for reading").arg(patch.delta);
+		return false;
+	}
+	QSaveFile output(patch.destination);
+	if (!output.open(QFile::WriteOnly))
+	{
+		error = QString("Can't open %1 for writing").arg(patch.destination);
+		return false;
+	}
+	if (delta.read(8) != "MMCDELTA")
+	{
+		error = QString("%1 is not a patch").arg(patch.delta);
+		return false;
+	}
+
+	QDataStream in(&delta);
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	const qint64 sourceSize = source.size();
+	QByteArray buffer;
+	while (true)
+	{
+		quint8 op = 0;
+		in >> op;
+		if (in.status() != QDataStream::Ok)
+		{
+			error = QString("%1 is truncated").arg(patch.delta);
+			return false;
+		}
+		if (op == 0)
+		{
+			break;
+		}
+		if (op == 1)
+		{
+			quint64 offset = 0, length = 0;
+			in >> offset >> length;
+			if (in.status() != QDataStream::Ok || offset > quint64(sourceSize) ||
+				length > quint64(sourceSize) - offset || !source.seek(offset))
+			{
+				error = QString("%1 copies outside of %2").arg(patch.delta, patch.source);
+				return false;
+			}
+			while (length)
+			{
+				buffer = source.read(qMin<quint64>(length, 1024 * 1024));
+				if (buffer.isEmpty())
+				{
+					error = QString("Can't read %1").arg(patch.source);
+					return false;
+				}
+				length -= buffer.size();
+				hash.addData(buffer);
+				output.write(buffer);
+			}
+		}
+		else if (op == 2)
+		{
+			quint32 length = 0;
+			in >> length;
+			buffer = delta.read(length);
+			if (in.status() != QDataStream::Ok || buffer.size() != int(length))
+			{
+				error = QString("%1 is truncated").arg(patch.delta);
+				return false;
+			}
+			hash.addData(buffer);
+			output.write(buffer);
+		}
+		else
+		{
+			error = QString("%1 contains an unknown operation %2").arg(patch.delta).arg(op);
+			return false;
+		}
+	}
+
+	QString resultMD5 = hash.result().toHex();
+	if (resultMD5 != patch.md5)
+	{
+		error = QString("Patching %1 produced %2 instead of %3").arg(patch.source, resultMD5, patch.md5);
+		return false;
+	}
+	if (!output.commit())
+	{
+		error = QString("Can't write %1").arg(patch.destination);
+		return false;
+	}
+	return true;
+}
+
 bool fixPathForOSX(QString &path)
 {
 	if (path.startsWith("MultiMC.app/"))
@@ -1,5 +1,7 @@
 #pragma once
 #include <QByteArray>
+#include <QHash>
+#include <QMutex>
 #include <net/NetJob.h>
 
 #include "multimc_logic_export.h"
@@ -29,21 +31,25 @@ struct MULTIMC_LOGIC_EXPORT Status
  */
 struct MULTIMC_LOGIC_EXPORT FileSource
 {
-	FileSource(QString type, QString url, QString compression="")
+	FileSource(QString type, QString url, QString compression="", QString fromMD5="")
 	{
 		this->type = type;
 		this->url = url;
 		this->compressionType = compression;
+		this->fromMD5 = fromMD5;
 	}
 
 	bool operator==(const FileSource &f2) const
 	{
-		return type == f2.type && url == f2.url && compressionType == f2.compressionType;
+		return type == f2.type && url == f2.url && compressionType == f2.compressionType && fromMD5 == f2.fromMD5;
 	}
 
 	QString type;
 	QString url;
 	QString compressionType;
+
+	//! For 'delta' sources, the MD5 of the installed file the patch applies to.
+	QString fromMD5;
 };
 typedef QList<FileSource> FileSourceList;
 
@@ -104,6 +110,76 @@ struct MULTIMC_LOGIC_EXPORT Operation
 };
 typedef QList<Operation> OperationList;
 
+/**
+ * A binary patch to apply to an installed file once the update files are downloaded.
+ */
+struct MULTIMC_LOGIC_EXPORT Patch
+{
+	bool operator==(const Patch &p2) const
+	{
+		return source == p2.source &&
+			delta == p2.delta &&
+			destination == p2.destination &&
+			md5 == p2.md5 &&
+			fallbackUrl == p2.fallbackUrl;
+	}
+
+	//! The installed file the patch applies to.
+	QString source;
+
+	//! The downloaded patch.
+	QString delta;
+
+	//! Where the patched file goes. This is what the copy operation for the file installs.
+	QString destination;
+
+	//! The expected MD5 of the patched file.
+	QString md5;
+
+	//! The full file, downloaded when the patch does not apply.
+	QString fallbackUrl;
+};
+typedef QList<Patch> PatchList;
+
+/**
+ * Remembers the MD5 sums of files for as long as their size and modification time stay the same.
+ *
+ * Safe to use from multiple threads.
+ */
+class MULTIMC_LOGIC_EXPORT HashCache
+{
+public:
+	explicit HashCache(const QString &cacheFile = QString());
+
+	//! Loads the cache file, if there is one.
+	void load();
+
+	//! Saves the cache file, if anything changed.
+	bool save();
+
+	//! Returns the MD5 of the given file as a hex string, or an empty string if it can't be read.
+	QString md5(const QString &path);
+
+	//! Hashes the given files on the global thread pool and remembers the results.
+	void hashFiles(QStringList paths);
+
+	//! How many files were actually read since the cache was created.
+	int hashedCount() const;
+
+private:
+	struct Entry
+	{
+		qint64 size;
+		qint64 mtime;
+		QString md5;
+	};
+	QString m_cacheFile;
+	mutable QMutex m_mutex;
+	QHash<QString, Entry> m_entries;
+	bool m_dirty = false;
+	int m_hashedCount = 0;
+};
+
 /**
  * Loads the file list from the given version info JSON object into the given list.
  */
@@ -112,6 +188,10 @@ bool MULTIMC_LOGIC_EXPORT parseVersionInfo(const QByteArray &data, VersionFileLi
 /*!
  * Takes a list of file entries for the current version's files and the new version's files
  * and populates the downloadList and operationList with information about how to download and install the update.
+ *
+ * Installed files are hashed through the given cache, or a temporary one if there is none.
+ * If a patch list is given, files with a 'delta' source matching the installed file are patched
+ * instead of downloaded. The patches have to be applied before the operations are carried out.
  */
 bool MULTIMC_LOGIC_EXPORT processFileLists
 (
@@ -120,9 +200,23 @@ bool MULTIMC_LOGIC_EXPORT processFileLists
 	const QString &rootPath,
 	const QString &tempPath,
 	NetJobPtr job,
-	OperationList &ops
+	OperationList &ops,
+	HashCache *hashes = nullptr,
+	PatchList *patches = nullptr
 );
 
+/*!
+ * Applies a downloaded patch, writing the patched file to its destination.
+ *
+ * The patch format is the 'MMCDELTA' magic followed by a list of operations, all big-endian:
+ *   0x01 <quint64 offset> <quint64 length> - copy a range of the source file
+ *   0x02 <quint32 length> <data>           - insert new data
+ *   0x00                                   - end of patch
+ *
+ * @return false if the patch is malformed, or the result doesn't match the expected MD5
+ */
+bool MULTIMC_LOGIC_EXPORT applyPatch(const Patch &patch, QString &error);
+
 /*!
  * This fixes destination paths for OSX - removes 'MultiMC.app' prefix
  * The updater runs in MultiMC.app/Contents/MacOs by default
@@ -29,6 +29,6 @@ bool InstanceProxyModel::subSortLessThan(const QModelIndex &left,
 	}
 	else
 	{
-		return QString::localeAwareCompare(pdataLeft->name(), pdataRight->name()) < 0;
+		return sortKey(pdataLeft->name()) < sortKey(pdataRight->name());
 	}
 }
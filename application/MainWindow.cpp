@@ -1069,7 +1069,7 @@ void MainWindow::on_actionCopyInstance_triggered()
 		return;
 
 	std::unique_ptr<Task> task(MMC->folderProvider()->copyTask(m_selectedInstance, copyInstDlg.instName(), copyInstDlg.instGroup(),
-		copyInstDlg.iconKey(), copyInstDlg.shouldCopySaves()));
+		copyInstDlg.iconKey(), copyInstDlg.shouldCopySaves(), copyInstDlg.shouldLinkFiles()));
 	runModalTask(task.get());
 
 	// FIXME: handle instance selection after creation
@@ -32,6 +32,7 @@
 #include <QStringList>
 #include <QDebug>
 #include <QStyleFactory>
+#include <QTimer>
 
 #include "dialogs/CustomMessageBox.h"
 #include "InstanceList.h"
@@ -43,6 +44,7 @@
 #include "net/HttpMetaCache.h"
 #include "net/URLConstants.h"
 #include "Env.h"
+#include "Metrics.h"
 
 #include "java/JavaUtils.h"
 
@@ -55,6 +57,7 @@
 #include <xdgicon.h>
 #include "settings/INISettingsObject.h"
 #include "settings/Setting.h"
+#include "settings/SaveScheduler.h"
 
 #include "translations/TranslationsModel.h"
 
@@ -169,6 +172,15 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		// --alive
 		parser.addSwitch("alive");
 		parser.addDocumentation("alive", "write a small '" + liveCheckFile + "' file after MultiMC starts");
+		// --trace
+		parser.addOption("trace");
+		parser.addDocumentation("trace", "record how long the steps of starting up take and write them to the given file");
+		// --trace-format
+		parser.addOption("trace-format", "chrome");
+		parser.addDocumentation("trace-format", "format of the --trace file: 'chrome' (chrome://tracing) or 'json'");
+		// --metrics
+		parser.addOption("metrics");
+		parser.addDocumentation("metrics", "record what downloads and tasks did and write it to the given JSON file on exit");
 
 		// parse the arguments
 		try
@@ -204,6 +216,24 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 	m_instanceIdToLaunch = args["launch"].toString();
 	m_liveCheck = args["alive"].toBool();
 
+	m_traceFile = args["trace"].toString();
+	if(!m_traceFile.isEmpty())
+	{
+		// relative to where we were started, not the data folder
+		m_traceFile = QFileInfo(m_traceFile).absoluteFilePath();
+		m_traceFormat = args["trace-format"].toString() == "json" ? Trace::Format::Json : Trace::Format::Chrome;
+		Trace::enable();
+		// everything until the main window can be used
+		m_startupSpan.reset(new Trace::Span("Startup"));
+	}
+
+	m_metricsFile = args["metrics"].toString();
+	if(!m_metricsFile.isEmpty())
+	{
+		m_metricsFile = QFileInfo(m_metricsFile).absoluteFilePath();
+		Metrics::enable();
+	}
+
 	QString origcwdPath = QDir::currentPath();
 	QString binPath = applicationDirPath();
 	QString adjustedBy;
@@ -289,6 +319,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 
 	// init the logger
 	{
+		Trace::Span span("Logger");
 		static const QString logBase = "MultiMC-%0.log";
 		auto moveFile = [](const QString &oldName, const QString &newName)
 		{
@@ -385,6 +416,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 
 	// Initialize application settings
 	{
+		Trace::Span span("Settings");
 		m_settings.reset(new INISettingsObject("multimc.cfg", this));
 		// Updates
 		m_settings->registerSetting("UpdateChannel", BuildConfig.VERSION_CHANNEL);
@@ -485,6 +517,9 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		// The cat
 		m_settings->registerSetting("TheCat", false);
 
+		// Memory budget for screenshot thumbnails, in MiB
+		m_settings->registerSetting("ThumbnailCacheMB", 64);
+
 		m_settings->registerSetting("InstSortMode", "Name");
 		m_settings->registerSetting("SelectedInstance", QString());
 
@@ -532,6 +567,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 
 	// load translations
 	{
+		Trace::Span span("Translations");
 		m_translations.reset(new TranslationsModel("translations"));
 		auto bcp47Name = m_settings->get("Language").toString();
 		m_translations->selectLanguage(bcp47Name);
@@ -542,12 +578,14 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 	// initialize the updater
 	if(BuildConfig.UPDATER_ENABLED)
 	{
+		Trace::Span span("Updater");
 		m_updateChecker.reset(new UpdateChecker(BuildConfig.CHANLIST_URL, BuildConfig.VERSION_CHANNEL, BuildConfig.VERSION_BUILD));
 		qDebug() << "<> Updater started.";
 	}
 
 	// Instance icons
 	{
+		Trace::Span span("Instance icons");
 		auto setting = MMC->settings()->getSetting("IconsDir");
 		QStringList instFolders =
 		{
@@ -566,6 +604,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 
 	// Icon themes
 	{
+		Trace::Span span("Icon themes");
 		// TODO: icon themes and instance icons do not mesh well together. Rearrange and fix discrepancies!
 		// set icon theme search path!
 		auto searchPaths = QIcon::themeSearchPaths();
@@ -576,6 +615,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 
 	// Initialize widget themes
 	{
+		Trace::Span span("Widget themes");
 		auto insertTheme = [this](ITheme * theme)
 		{
 			m_themes.insert(std::make_pair(theme->id(), std::unique_ptr<ITheme>(theme)));
@@ -588,8 +628,15 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		qDebug() << "<> Widget themes initialized.";
 	}
 
-	// initialize and load all instances
+	// init the http meta cache, its index is read while the instances load
+	{
+		Trace::Span span("Metadata cache");
+		ENV.initHttpMetaCache();
+		qDebug() << "<> Cache initialized.";
+	}
+
 	{
+		Trace::Span span("Instances");
 		auto InstDirSetting = m_settings->getSetting("InstanceDir");
 		// instance path: check for problems with '!' in instance path and warn the user in the log
 		// and rememer that we have to show him a dialog when the gui starts (if it does so)
@@ -611,6 +658,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 
 	// and accounts
 	{
+		Trace::Span span("Accounts");
 		m_accounts.reset(new MojangAccountList(this));
 		qDebug() << "Loading accounts...";
 		m_accounts->setListFilePath("accounts.json", true);
@@ -618,14 +666,9 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		qDebug() << "<> Accounts loaded.";
 	}
 
-	// init the http meta cache
-	{
-		ENV.initHttpMetaCache();
-		qDebug() << "<> Cache initialized.";
-	}
-
 	// init proxy settings
 	{
+		Trace::Span span("Proxy settings");
 		QString proxyTypeStr = settings()->get("ProxyType").toString();
 		QString addr = settings()->get("ProxyAddr").toString();
 		int port = settings()->get("ProxyPort").value<qint16>();
@@ -635,9 +678,10 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		qDebug() << "<> Proxy settings done.";
 	}
 
-	// now we have network, download translation updates
-	m_translations->downloadIndex();
+	// now we have network, download translation updates once the event loop runs
+	QTimer::singleShot(0, m_translations.get(), &TranslationsModel::downloadIndex);
 
+	Trace::Span toolsSpan("Tools");
 	//FIXME: what to do with these?
 	m_profilers.insert("jprofiler", std::shared_ptr<BaseProfilerFactory>(new JProfilerFactory()));
 	m_profilers.insert("jvisualvm", std::shared_ptr<BaseProfilerFactory>(new JVisualVMFactory()));
@@ -650,6 +694,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 	{
 		m_mcedit.reset(new MCEditTool(m_settings));
 	}
+	toolsSpan.finish();
 
 	connect(this, &MultiMC::aboutToQuit, [this](){
 		if(m_instances)
@@ -664,6 +709,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 	});
 
 	{
+		Trace::Span span("Themes");
 		setIconTheme(settings()->get("IconTheme").toString());
 		qDebug() << "<> Icon theme set.";
 		setApplicationTheme(settings()->get("ApplicationTheme").toString(), true);
@@ -673,6 +719,7 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 	// Initialize analytics
 	[this]()
 	{
+		Trace::Span span("Analytics");
 		const int analyticsVersion = 2;
 		if(BuildConfig.ANALYTICS_ID.isEmpty())
 		{
@@ -709,9 +756,12 @@ MultiMC::MultiMC(int &argc, char **argv) : QApplication(argc, argv)
 		qDebug() << "<> Initialized analytics with tid" << BuildConfig.ANALYTICS_ID;
 	}();
 
-	if(createSetupWizard())
 	{
-		return;
+		Trace::Span span("Setup wizard check");
+		if(createSetupWizard())
+		{
+			return;
+		}
 	}
 	performMainStartupAction();
 }
@@ -796,16 +846,37 @@ void MultiMC::performMainStartupAction()
 		if(inst)
 		{
 			qDebug() << "<> Instance launching:" << m_instanceIdToLaunch;
-			launch(inst, true, nullptr);
+			{
+				Trace::Span span("Instance launch");
+				launch(inst, true, nullptr);
+			}
+			saveStartupTrace();
 			return;
 		}
 	}
 	if(!m_mainWindow)
 	{
 		// normal main window
-		showMainWindow(false);
+		{
+			Trace::Span span("Main window");
+			showMainWindow(false);
+		}
 		qDebug() << "<> Main window shown.";
 	}
+	// the window is usable once the event loop has run and painted it
+	QTimer::singleShot(0, this, &MultiMC::saveStartupTrace);
+}
+
+void MultiMC::saveStartupTrace()
+{
+	if(m_traceFile.isEmpty())
+	{
+		return;
+	}
+	m_startupSpan.reset();
+	Trace::save(m_traceFile, m_traceFormat);
+	// startup is done, there is nothing more to measure
+	m_traceFile.clear();
 }
 
 void MultiMC::showFatalErrorMessage(const QString& title, const QString& content)
@@ -817,6 +888,14 @@ void MultiMC::showFatalErrorMessage(const QString& title, const QString& content
 
 MultiMC::~MultiMC()
 {
+	// write out any settings that are still pending
+	SaveScheduler::instance().flush();
+
+	if(!m_metricsFile.isEmpty())
+	{
+		Metrics::save(m_metricsFile);
+	}
+
 	// kill the other globals.
 	Env::dispose();
 
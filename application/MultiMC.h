@@ -9,6 +9,7 @@
 #include <updater/GoUpdate.h>
 
 #include <BaseInstance.h>
+#include <Trace.h>
 
 class LaunchController;
 class LocalPeer;
@@ -164,6 +165,7 @@ private slots:
 private:
 	bool createSetupWizard();
 	void performMainStartupAction();
+	void saveStartupTrace();
 
 	// sets the fatal error message and m_status to Failed.
 	void showFatalErrorMessage(const QString & title, const QString & content);
@@ -219,6 +221,13 @@ private:
 
 	GAnalytics * m_analytics = nullptr;
 	SetupWizard * m_setupWizard = nullptr;
+
+	// where to write the startup trace, if anywhere
+	QString m_traceFile;
+	Trace::Format m_traceFormat = Trace::Format::Chrome;
+	std::unique_ptr<Trace::Span> m_startupSpan;
+	// where to write the download and task metrics on exit, if anywhere
+	QString m_metricsFile;
 public:
 	QString m_instanceIdToLaunch;
 	bool m_liveCheck = false;
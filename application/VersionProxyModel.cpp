@@ -2,7 +2,9 @@
 #include "MultiMC.h"
 #include <QSortFilterProxyModel>
 #include <QPixmapCache>
+#include <QBitArray>
 #include <Version.h>
+#include <StringIndex.h>
 
 class VersionFilterModel : public QSortFilterProxyModel
 {
@@ -15,41 +17,131 @@ public:
 		sort(0, Qt::DescendingOrder);
 	}
 
-	bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+	void setSourceModel(QAbstractItemModel *sourceModel) override
 	{
-		const auto &filters = m_parent->filters();
-		for (auto it = filters.begin(); it != filters.end(); ++it)
+		if(this->sourceModel())
+		{
+			disconnect(this->sourceModel(), nullptr, this, nullptr);
+		}
+		// connected before the base class, so the matches are marked stale before it filters again
+		if(sourceModel)
 		{
-			auto role = it.key();
-			auto idx = sourceModel()->index(source_row, 0, source_parent);
-			auto data = sourceModel()->data(idx, role);
+			connect(sourceModel, &QAbstractItemModel::dataChanged, this, &VersionFilterModel::sourceChanged);
+			connect(sourceModel, &QAbstractItemModel::modelReset, this, &VersionFilterModel::sourceChanged);
+			connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &VersionFilterModel::sourceChanged);
+			connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &VersionFilterModel::sourceChanged);
+			connect(sourceModel, &QAbstractItemModel::rowsMoved, this, &VersionFilterModel::sourceChanged);
+			connect(sourceModel, &QAbstractItemModel::layoutChanged, this, &VersionFilterModel::sourceChanged);
+		}
+		sourceChanged();
+		QSortFilterProxyModel::setSourceModel(sourceModel);
+	}
 
-			switch(role)
+	/**
+	 * The filter for a role changed. When narrowing, the new filter only matches rows the old
+	 * one did, so only those are looked at again.
+	 */
+	void filterChanged(BaseVersionList::ModelRoles role, bool narrowing)
+	{
+		if(!m_stale)
+		{
+			QBitArray candidates;
+			if(narrowing)
 			{
-				case BaseVersionList::ParentVersionRole:
-				case BaseVersionList::VersionIdRole:
-					// TODO: work with metadata here. Previous implementation based on the Version class is not sufficient
-				default:
-				{
-					auto match = data.toString();
-					if(it.value().exact)
-					{
-						if (match != it.value().string)
-						{
-							return false;
-						}
-					}
-					else if (match.contains(it.value().string))
-					{
-						return false;
-					}
-				}
+				candidates = m_matches.value(role);
 			}
+			m_matches[role] = match(role, candidates);
+			combineMatches();
 		}
-		return true;
+		invalidateFilter();
+	}
+
+	void filtersCleared()
+	{
+		m_matches.clear();
+		m_accepted = QBitArray();
+		invalidateFilter();
 	}
+
+	bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override
+	{
+		if(source_parent.isValid())
+		{
+			return false;
+		}
+		if(m_parent->filters().isEmpty())
+		{
+			return true;
+		}
+		if(m_stale)
+		{
+			rematch();
+		}
+		return source_row < m_accepted.size() && m_accepted.testBit(source_row);
+	}
+
+private slots:
+	void sourceChanged()
+	{
+		m_stale = true;
+	}
+
+private:
+	QBitArray match(BaseVersionList::ModelRoles role, const QBitArray &candidates) const
+	{
+		const auto &filter = m_parent->filters()[role];
+		auto list = dynamic_cast<BaseVersionList *>(sourceModel());
+		auto index = list ? list->filterIndex(role) : nullptr;
+		if(index && index->size() == sourceModel()->rowCount())
+		{
+			return index->find(filter.string, filter.exact, candidates);
+		}
+		// no index, ask the model for every row
+		int rows = sourceModel() ? sourceModel()->rowCount() : 0;
+		QBitArray out(rows);
+		for(int row = 0; row < rows; row++)
+		{
+			if(!candidates.isEmpty() && (row >= candidates.size() || !candidates.testBit(row)))
+			{
+				continue;
+			}
+			auto data = sourceModel()->data(sourceModel()->index(row, 0), role).toString();
+			if(filter.exact ? data == filter.string : data.contains(filter.string))
+			{
+				out.setBit(row);
+			}
+		}
+		return out;
+	}
+
+	void combineMatches() const
+	{
+		int rows = sourceModel() ? sourceModel()->rowCount() : 0;
+		m_accepted = QBitArray(rows, true);
+		for(auto &matches: m_matches)
+		{
+			m_accepted &= matches;
+		}
+	}
+
+	void rematch() const
+	{
+		m_stale = false;
+		m_matches.clear();
+		const auto &filters = m_parent->filters();
+		for (auto it = filters.begin(); it != filters.end(); ++it)
+		{
+			m_matches[it.key()] = match(it.key(), QBitArray());
+		}
+		combineMatches();
+	}
+
 private:
 	VersionProxyModel *m_parent;
+	// the rows each filter lets through, and the rows all of them do
+	mutable QHash<BaseVersionList::ModelRoles, QBitArray> m_matches;
+	mutable QBitArray m_accepted;
+	mutable bool m_stale = true;
 };
 
 VersionProxyModel::VersionProxyModel(QObject *parent) : QAbstractProxyModel(parent)
@@ -372,16 +464,23 @@ QModelIndex VersionProxyModel::getRecommended() const
 void VersionProxyModel::clearFilters()
 {
 	m_filters.clear();
-	filterModel->invalidate();
+	filterModel->filtersCleared();
 }
 
 void VersionProxyModel::setFilter(const BaseVersionList::ModelRoles column, const QString &filter, const bool exact)
 {
+	// typing more into a substring filter can only drop rows
+	bool narrowing = false;
+	auto previous = m_filters.find(column);
+	if(previous != m_filters.end())
+	{
+		narrowing = !exact && !previous->exact && filter.contains(previous->string);
+	}
 	Filter f;
 	f.string = filter;
 	f.exact = exact;
 	m_filters[column] = f;
-	filterModel->invalidate();
+	filterModel->filterChanged(column, narrowing);
 }
 
 const VersionProxyModel::FilterMap &VersionProxyModel::filters() const
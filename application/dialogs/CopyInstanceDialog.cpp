@@ -102,6 +102,11 @@ bool CopyInstanceDialog::shouldCopySaves() const
 	return m_copySaves;
 }
 
+bool CopyInstanceDialog::shouldLinkFiles() const
+{
+	return ui->linkFilesCheckbox->isChecked();
+}
+
 void CopyInstanceDialog::on_copySavesCheckbox_stateChanged(int state)
 {
 	if(state == Qt::Unchecked)
@@ -40,6 +40,7 @@ public:
 	QString instGroup() const;
 	QString iconKey() const;
 	bool shouldCopySaves() const;
+	bool shouldLinkFiles() const;
 
 private
 slots:
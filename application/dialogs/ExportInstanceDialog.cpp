@@ -30,13 +30,17 @@
 #include "MultiMC.h"
 #include <icons/IconList.h>
 #include <FileSystem.h>
+#include <InstanceExportTask.h>
+#include "ProgressDialog.h"
+#include <settings/SaveScheduler.h>
 
 class PackIgnoreProxy : public QSortFilterProxyModel
 {
 	Q_OBJECT
 
 public:
-	PackIgnoreProxy(InstancePtr instance, QObject *parent) : QSortFilterProxyModel(parent)
+	PackIgnoreProxy(InstancePtr instance, QObject *parent)
+		: QSortFilterProxyModel(parent), m_nameKeys(&makeNameKey)
 	{
 		m_instance = instance;
 	}
@@ -65,8 +69,7 @@ public:
 		// sort and proxy model breaks the original model...
 		if (sortColumn() == 0)
 		{
-			return Strings::naturalCompare(leftFileInfo.fileName(), rightFileInfo.fileName(),
-										   Qt::CaseInsensitive) < 0;
+			return nameKey(leftFileInfo.fileName()) < nameKey(rightFileInfo.fileName());
 		}
 		if (sortColumn() == 1)
 		{
@@ -74,9 +77,7 @@ public:
 			auto rightSize = rightFileInfo.size();
 			if ((leftSize == rightSize) || (leftFileInfo.isDir() && rightFileInfo.isDir()))
 			{
-				return Strings::naturalCompare(leftFileInfo.fileName(),
-											   rightFileInfo.fileName(),
-											   Qt::CaseInsensitive) < 0
+				return nameKey(leftFileInfo.fileName()) < nameKey(rightFileInfo.fileName())
 						   ? asc
 						   : !asc;
 			}
@@ -305,9 +306,21 @@ protected:
 		return true;
 	}
 
+private:
+	// file names get their sort key computed once, not on every comparison
+	static Strings::SortKey makeNameKey(const QString &name)
+	{
+		return Strings::naturalSortKey(name, Qt::CaseInsensitive);
+	}
+	Strings::SortKey nameKey(const QString &name) const
+	{
+		return m_nameKeys.key(name);
+	}
+
 private:
 	InstancePtr m_instance;
 	SeparatorPrefixTree<'/'> blocked;
+	mutable Strings::SortKeyCache m_nameKeys;
 };
 
 ExportInstanceDialog::ExportInstanceDialog(InstancePtr instance, QWidget *parent)
@@ -354,8 +367,7 @@ void SaveIcon(InstancePtr m_instance)
 		}
 		if(saveIcon)
 		{
-			auto & image = mmcIcon->m_images[mmcIcon->type()];
-			auto & icon = image.icon;
+			auto icon = mmcIcon->icon();
 			auto sizes = icon.availableSizes();
 			if(sizes.size() == 0)
 			{
@@ -404,12 +416,15 @@ bool ExportInstanceDialog::doExport()
 	}
 
 	SaveIcon(m_instance);
+	SaveScheduler::instance().flush(m_instance->instanceRoot());
 
-	auto & blocked = proxyModel->blockedPaths();
-	using std::placeholders::_1;
-	if (!JlCompress::compressDir(output, m_instance->instanceRoot(), name, std::bind(&SeparatorPrefixTree<'/'>::covers, blocked, _1)))
+	InstanceExportTask task(output, m_instance->instanceRoot(), name, proxyModel->blockedPaths());
+	ProgressDialog progress(this);
+	progress.setSkipButton(true, tr("Abort"));
+	progress.execWithTask(&task);
+	if (!task.wasSuccessful())
 	{
-		QMessageBox::warning(this, tr("Error"), tr("Unable to export instance"));
+		QMessageBox::warning(this, tr("Error"), tr("Unable to export instance:\n%1").arg(task.failReason()));
 		return false;
 	}
 	return true;
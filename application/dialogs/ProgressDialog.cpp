@@ -21,6 +21,8 @@
 
 #include "tasks/Task.h"
 
+#include <limits>
+
 ProgressDialog::ProgressDialog(QWidget *parent) : QDialog(parent), ui(new Ui::ProgressDialog)
 {
 	ui->setupUi(this);
@@ -156,6 +158,12 @@ void ProgressDialog::changeStatus(const QString &status)
 
 void ProgressDialog::changeProgress(qint64 current, qint64 total)
 {
+	// the progress bar only takes ints, so large byte counts are shown in per mille
+	if (total > std::numeric_limits<int>::max())
+	{
+		current = current * 1000 / total;
+		total = 1000;
+	}
 	ui->taskProgressBar->setMaximum(total);
 	ui->taskProgressBar->setValue(current);
 }
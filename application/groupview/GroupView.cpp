@@ -28,6 +28,10 @@
 
 #include "VisualGroup.h"
 #include <QDebug>
+#include <MMCStrings.h>
+
+#include <algorithm>
+#include <vector>
 
 template <typename T> bool listsIntersect(const QList<T> &l1, const QList<T> t2)
 {
@@ -88,28 +92,12 @@ void GroupView::rowsRemoved()
 	scheduleDelayedItemsLayout();
 }
 
-class LocaleString : public QString
-{
-public:
-	LocaleString(const char *s) : QString(s)
-	{
-	}
-	LocaleString(const QString &s) : QString(s)
-	{
-	}
-};
-
-inline bool operator<(const LocaleString &lhs, const LocaleString &rhs)
-{
-	return (QString::localeAwareCompare(lhs, rhs) < 0);
-}
-
 void GroupView::updateGeometries()
 {
 	geometryCache.clear();
 	int previousScroll = verticalScrollBar()->value();
 
-	QMap<LocaleString, VisualGroup *> cats;
+	QHash<QString, VisualGroup *> cats;
 
 	for (int i = 0; i < model()->rowCount(); ++i)
 	{
@@ -133,7 +121,22 @@ void GroupView::updateGeometries()
 	}
 
 	qDeleteAll(m_groups);
-	m_groups = cats.values();
+	// groups are ordered by name, using one collation key per group
+	std::vector<std::pair<Strings::SortKey, VisualGroup *>> sorted;
+	sorted.reserve(cats.size());
+	for (auto iter = cats.begin(); iter != cats.end(); ++iter)
+	{
+		sorted.emplace_back(Strings::localeSortKey(iter.key()), iter.value());
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const std::pair<Strings::SortKey, VisualGroup *> &a, const std::pair<Strings::SortKey, VisualGroup *> &b)
+	{
+		return a.first < b.first;
+	});
+	m_groups.clear();
+	for (auto &group : sorted)
+	{
+		m_groups.append(group.second);
+	}
 
 	if (m_groups.isEmpty())
 	{
@@ -18,8 +18,14 @@
 #include "GroupView.h"
 #include <QDebug>
 
-GroupedProxyModel::GroupedProxyModel(QObject *parent) : QSortFilterProxyModel(parent)
+GroupedProxyModel::GroupedProxyModel(QObject *parent)
+	: QSortFilterProxyModel(parent), m_sortKeys(&Strings::localeSortKey)
 {
+	// do not keep the keys of strings that may be gone now
+	connect(this, &QAbstractItemModel::modelReset, this, [this]()
+	{
+		m_sortKeys.clear();
+	});
 }
 
 bool GroupedProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
@@ -32,8 +38,8 @@ bool GroupedProxyModel::lessThan(const QModelIndex &left, const QModelIndex &rig
 	}
 	else
 	{
-		// FIXME: real group sorting happens in GroupView::updateGeometries(), see LocaleString
-		auto result = leftCategory.localeAwareCompare(rightCategory);
+		// FIXME: real group sorting happens in GroupView::updateGeometries()
+		auto result = sortKey(leftCategory).compare(sortKey(rightCategory));
 		if(result == 0)
 		{
 			return subSortLessThan(left, right);
@@ -46,3 +52,8 @@ bool GroupedProxyModel::subSortLessThan(const QModelIndex &left, const QModelInd
 {
 	return left.row() < right.row();
 }
+
+Strings::SortKey GroupedProxyModel::sortKey(const QString &string) const
+{
+	return m_sortKeys.key(string);
+}
@@ -16,6 +16,8 @@
 #pragma once
 
 #include <QSortFilterProxyModel>
+#include <QHash>
+#include <MMCStrings.h>
 
 class GroupedProxyModel : public QSortFilterProxyModel
 {
@@ -27,4 +29,10 @@ public:
 protected:
 	virtual bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
 	virtual bool subSortLessThan(const QModelIndex &left, const QModelIndex &right) const;
+
+	/// The locale sort key of a string, computed once per distinct string.
+	Strings::SortKey sortKey(const QString &string) const;
+
+private:
+	mutable Strings::SortKeyCache m_sortKeys;
 };
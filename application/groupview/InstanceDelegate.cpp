@@ -18,11 +18,14 @@
 #include <QTextOption>
 #include <QTextLayout>
 #include <QApplication>
+#include <QPixmapCache>
 #include <QtMath>
 
 #include "GroupView.h"
 #include "BaseInstance.h"
 #include "InstanceList.h"
+#include "MultiMC.h"
+#include <icons/IconList.h>
 #include <xdgicon.h>
 
 // Origin: Qt
@@ -50,6 +53,8 @@ static void viewItemTextLayout(QTextLayout &textLayout, int lineWidth, qreal &he
 
 ListViewDelegate::ListViewDelegate(QObject *parent) : QStyledItemDelegate(parent)
 {
+	// one entry per visible item, so make room for large instance lists
+	m_textCache.setMaxCost(4096);
 }
 
 void drawSelectionRect(QPainter *painter, const QStyleOptionViewItem &option,
@@ -109,6 +114,38 @@ void drawProgressOverlay(QPainter *painter, const QStyleOptionViewItem &option,
 	painter->restore();
 }
 
+static QPixmap badgePixmap(const QString &name, int side, QIcon::Mode mode, QIcon::State state)
+{
+	const QString key = QString("MultiMC-badge-%1-%2-%3-%4-%5")
+		.arg(QIcon::themeName(), name)
+		.arg(side)
+		.arg(int(mode))
+		.arg(int(state));
+	QPixmap pixmap;
+	if (!QPixmapCache::find(key, &pixmap))
+	{
+		// FIXME: inject this.
+		pixmap = XdgIcon::fromTheme(name).pixmap(side, side, mode, state);
+		QPixmapCache::insert(key, pixmap);
+	}
+	return pixmap;
+}
+
+// the key of the item's icon, if it is one from the icon list
+static QString iconKeyOf(const QModelIndex &index)
+{
+	auto instance = (BaseInstance*)index.data(InstanceList::InstancePointerRole).value<void *>();
+	if (instance)
+	{
+		return instance->iconKey();
+	}
+	if (qobject_cast<const IconList *>(index.model()))
+	{
+		return index.data(Qt::UserRole).toString();
+	}
+	return QString();
+}
+
 void drawBadges(QPainter *painter, const QStyleOptionViewItem &option, BaseInstance *instance, QIcon::Mode mode, QIcon::State state)
 {
 	QList<QString> pixmaps;
@@ -139,10 +176,7 @@ void drawBadges(QPainter *painter, const QStyleOptionViewItem &option, BaseInsta
 			{
 				return;
 			}
-			// FIXME: inject this.
-			auto icon = XdgIcon::fromTheme(it.next());
-			// opt.icon.paint(painter, iconbox, Qt::AlignCenter, mode, state);
-			const QPixmap pixmap;
+			auto pixmap = badgePixmap(it.next(), itemSide, mode, state);
 			// itemSide
 			QRect badgeRect(
 				option.rect.width() - x * itemSide + qMax(x - 1, 0) * spacing - itemSide,
@@ -150,28 +184,47 @@ void drawBadges(QPainter *painter, const QStyleOptionViewItem &option, BaseInsta
 				itemSide,
 				itemSide
 			);
-			icon.paint(painter, badgeRect, Qt::AlignCenter, mode, state);
+			const QSize pixmapSize = pixmap.size() / pixmap.devicePixelRatio();
+			painter->drawPixmap(QStyle::alignedRect(Qt::LeftToRight, Qt::AlignCenter, pixmapSize, badgeRect), pixmap);
 		}
 	}
 	painter->translate(-option.rect.topLeft());
 }
 
-static QSize viewItemTextSize(const QStyleOptionViewItem *option)
+const ListViewDelegate::CachedText *ListViewDelegate::cachedText(const QModelIndex &index,
+																  const QStyleOptionViewItem &opt,
+																  int lineWidth) const
 {
-	QStyle *style = option->widget ? option->widget->style() : QApplication::style();
+	// instances are keyed by ID so renames replace their entry, everything else by text
+	QString key = index.data(InstanceList::InstanceIDRole).toString();
+	if (key.isEmpty())
+	{
+		key = opt.text;
+	}
+	auto entry = m_textCache.object(key);
+	if (entry && entry->text == opt.text && entry->font == opt.font &&
+		entry->lineWidth == lineWidth && entry->direction == opt.direction)
+	{
+		return entry;
+	}
+
+	entry = new CachedText;
+	entry->text = opt.text;
+	entry->font = opt.font;
+	entry->lineWidth = lineWidth;
+	entry->direction = opt.direction;
+
 	QTextOption textOption;
 	textOption.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
-	QTextLayout textLayout;
-	textLayout.setTextOption(textOption);
-	textLayout.setFont(option->font);
-	textLayout.setText(option->text);
-	const int textMargin =
-		style->pixelMetric(QStyle::PM_FocusFrameHMargin, option, option->widget) + 1;
-	QRect bounds(0, 0, 100 - 2 * textMargin, 600);
-	qreal height = 0, widthUsed = 0;
-	viewItemTextLayout(textLayout, bounds.width(), height, widthUsed);
-	const QSize size(qCeil(widthUsed), qCeil(height));
-	return QSize(size.width() + 2 * textMargin, size.height());
+	textOption.setTextDirection(opt.direction);
+	textOption.setAlignment(QStyle::visualAlignment(opt.direction, opt.displayAlignment));
+	entry->layout.setTextOption(textOption);
+	entry->layout.setFont(opt.font);
+	entry->layout.setText(opt.text);
+	viewItemTextLayout(entry->layout, lineWidth, entry->height, entry->widthUsed);
+
+	m_textCache.insert(key, entry);
+	return entry;
 }
 
 void ListViewDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
@@ -202,8 +255,6 @@ void ListViewDelegate::paint(QPainter *painter, const QStyleOptionViewItem &opti
 
 	// draw background
 	{
-		// FIXME: unused
-		// QSize textSize = viewItemTextSize ( &opt );
 		QPalette::ColorGroup cg;
 		QStyleOptionViewItem opt2(opt);
 
@@ -266,7 +317,18 @@ void ListViewDelegate::paint(QPainter *painter, const QStyleOptionViewItem &opti
 	// draw the icon
 	{
 		iconbox.setHeight(iconSize);
-		opt.icon.paint(painter, iconbox, Qt::AlignCenter, mode, state);
+		auto iconKey = iconKeyOf(index);
+		if (iconKey.isEmpty())
+		{
+			opt.icon.paint(painter, iconbox, Qt::AlignCenter, mode, state);
+		}
+		else
+		{
+			// decoded and scaled once, shared with every other view of the icon list
+			auto pixmap = MMC->icons()->getPixmap(iconKey, iconSize, mode);
+			const QSize pixmapSize = (pixmap.size() / pixmap.devicePixelRatio()).boundedTo(iconbox.size());
+			painter->drawPixmap(QStyle::alignedRect(opt.direction, Qt::AlignCenter, pixmapSize, iconbox), pixmap);
+		}
 	}
 	// set the text colors
 	QPalette::ColorGroup cg =
@@ -283,26 +345,15 @@ void ListViewDelegate::paint(QPainter *painter, const QStyleOptionViewItem &opti
 	}
 
 	// draw the text
-	QTextOption textOption;
-	textOption.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
-	textOption.setTextDirection(opt.direction);
-	textOption.setAlignment(QStyle::visualAlignment(opt.direction, opt.displayAlignment));
-	QTextLayout textLayout;
-	textLayout.setTextOption(textOption);
-	textLayout.setFont(opt.font);
-	textLayout.setText(opt.text);
-
-	qreal width, height;
-	viewItemTextLayout(textLayout, textRect.width(), height, width);
-
-	const int lineCount = textLayout.lineCount();
+	auto text = cachedText(index, opt, textRect.width());
+	const int lineCount = text->layout.lineCount();
 
 	const QRect layoutRect = QStyle::alignedRect(
-		opt.direction, opt.displayAlignment, QSize(textRect.width(), int(height)), textRect);
+		opt.direction, opt.displayAlignment, QSize(textRect.width(), int(text->height)), textRect);
 	const QPointF position = layoutRect.topLeft();
 	for (int i = 0; i < lineCount; ++i)
 	{
-		const QTextLine line = textLayout.lineAt(i);
+		const QTextLine line = text->layout.lineAt(i);
 		line.draw(painter, position);
 	}
 
@@ -334,8 +385,9 @@ QSize ListViewDelegate::sizeHint(const QStyleOptionViewItem &option,
 	const int textMargin =
 		style->pixelMetric(QStyle::PM_FocusFrameHMargin, &option, opt.widget) + 1;
 	int height = 48 + textMargin * 2 + 5; // TODO: turn constants into variables
-	QSize szz = viewItemTextSize(&opt);
-	height += szz.height();
+	// same layout width as paint() uses for the default item width
+	auto text = cachedText(index, opt, 100 - 2 * textMargin);
+	height += qCeil(text->height);
 	// FIXME: maybe the icon items could scale and keep proportions?
 	QSize sz(100, height);
 	return sz;
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <QStyledItemDelegate>
+#include <QTextLayout>
 #include <QCache>
 
 class ListViewDelegate : public QStyledItemDelegate
@@ -27,4 +28,21 @@ protected:
 	void paint(QPainter *painter, const QStyleOptionViewItem &option,
 			   const QModelIndex &index) const;
 	QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+
+private:
+	/// Shaped and laid out item text, reused until the text, font or width changes
+	struct CachedText
+	{
+		QString text;
+		QFont font;
+		int lineWidth = 0;
+		Qt::LayoutDirection direction = Qt::LeftToRight;
+		QTextLayout layout;
+		qreal height = 0;
+		qreal widthUsed = 0;
+	};
+	const CachedText *cachedText(const QModelIndex &index, const QStyleOptionViewItem &opt,
+								 int lineWidth) const;
+
+	mutable QCache<QString, CachedText> m_textCache;
 };
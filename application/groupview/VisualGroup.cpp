@@ -36,6 +36,8 @@ void VisualGroup::update()
 {
 	auto temp_items = items();
 	auto itemsPerRow = view->itemsPerRow();
+	auto viewOptions = view->viewOptions();
+	auto delegate = view->itemDelegate();
 
 	int numRows = qMax(1, qCeil((qreal)temp_items.size() / (qreal)itemsPerRow));
 	rows = QVector<VisualRow>(numRows);
@@ -55,7 +57,7 @@ void VisualGroup::update()
 			positionInRow = 0;
 			maxRowHeight = 0;
 		}
-		auto itemHeight = view->itemDelegate()->sizeHint(view->viewOptions(), item).height();
+		auto itemHeight = delegate->sizeHint(viewOptions, item).height();
 		if(itemHeight > maxRowHeight)
 		{
 			maxRowHeight = itemHeight;
@@ -7,12 +7,21 @@
 #include <QSet>
 #include <QFileIconProvider>
 #include <QFileSystemModel>
+#include <QIdentityProxyModel>
 #include <QStyledItemDelegate>
 #include <QLineEdit>
 #include <QEvent>
 #include <QPainter>
 #include <QClipboard>
 #include <QKeyEvent>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QScrollBar>
+#include <QTimer>
+#include <QCache>
+
+#include <algorithm>
 
 #include <MultiMC.h>
 
@@ -23,31 +32,107 @@
 #include "screenshots/ImgurAlbumCreation.h"
 #include "tasks/SequentialTask.h"
 
-#include "RWStorage.h"
 #include <FileSystem.h>
 #include <DesktopServices.h>
 
-typedef RWStorage<QString, QIcon> SharedIconCache;
-typedef std::shared_ptr<SharedIconCache> SharedIconCachePtr;
+/**
+ * Thumbnails kept in memory, least recently used ones are dropped once over the byte budget.
+ */
+class ThumbnailCache
+{
+public:
+	explicit ThumbnailCache(qint64 maxBytes)
+	{
+		// QCache costs are ints, so they are counted in KiB
+		m_cache.setMaxCost(int(qMax<qint64>(maxBytes / 1024, 1)));
+	}
+	bool get(const QString &path, QIcon &icon)
+	{
+		auto cached = m_cache.object(path);
+		if (!cached)
+		{
+			m_misses++;
+			return false;
+		}
+		m_hits++;
+		icon = *cached;
+		return true;
+	}
+	bool contains(const QString &path) const
+	{
+		return m_cache.contains(path);
+	}
+	void add(const QString &path, const QImage &image)
+	{
+		int cost = qMax(1, image.bytesPerLine() * image.height() / 1024);
+		m_cache.insert(path, new QIcon(QPixmap::fromImage(image)), cost);
+	}
+	void remove(const QString &path)
+	{
+		m_cache.remove(path);
+	}
+	qint64 hits() const
+	{
+		return m_hits;
+	}
+	qint64 misses() const
+	{
+		return m_misses;
+	}
+	/// memory used by the thumbnails in the cache, in KiB
+	int residentKiB() const
+	{
+		return m_cache.totalCost();
+	}
+	QString stats() const
+	{
+		return QString("%1 hits, %2 misses, %3 thumbnails using %4 KiB of %5 KiB")
+			.arg(m_hits).arg(m_misses).arg(m_cache.count()).arg(m_cache.totalCost()).arg(m_cache.maxCost());
+	}
+
+private:
+	QCache<QString, QIcon> m_cache;
+	qint64 m_hits = 0;
+	qint64 m_misses = 0;
+};
+
+// how much the thumbnails on disk may take before the oldest ones are removed
+static const qint64 maxThumbnailFolderBytes = 128 * 1024 * 1024;
+
+/// Where the thumbnail of a screenshot with this path, size and modification time is kept
+static QString cachedThumbnailPath(const QString &cachePath, const QString &path, qint64 size, qint64 modified)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(path.toUtf8());
+	hash.addData(QByteArray::number(size));
+	hash.addData(QByteArray::number(modified));
+	return FS::PathCombine(cachePath, QString::fromLatin1(hash.result().toHex()) + ".png");
+}
 
 class ThumbnailingResult : public QObject
 {
 	Q_OBJECT
 public slots:
-	inline void emitResultsReady(const QString &path) { emit resultsReady(path); }
+	inline void emitResultsReady(const QString &path, const QImage &image) { emit resultsReady(path, image); }
 	inline void emitResultsFailed(const QString &path) { emit resultsFailed(path); }
 signals:
-	void resultsReady(const QString &path);
+	void resultsReady(const QString &path, const QImage &image);
 	void resultsFailed(const QString &path);
 };
 
+/**
+ * Makes a 256x256 thumbnail for a screenshot.
+ *
+ * Thumbnails are kept on disk, keyed by the path, size and modification time of the screenshot,
+ * so a screenshot is only decoded once. The decoder is asked for the reduced size directly.
+ */
 class ThumbnailRunnable : public QRunnable
 {
 public:
-	ThumbnailRunnable(QString path, SharedIconCachePtr cache)
+	ThumbnailRunnable(QString path, QString cachePath)
 	{
 		m_path = path;
-		m_cache = cache;
+		m_cachePath = cachePath;
 	}
 	void run()
 	{
@@ -59,55 +144,145 @@ public:
 		int tries = 5;
 		while (tries)
 		{
-			if (!m_cache->stale(m_path))
+			info.refresh();
+			auto cachedFile = cachedThumbnailPath(m_cachePath, info.absoluteFilePath(), info.size(),
+												  info.lastModified().toMSecsSinceEpoch());
+			QImage square(cachedFile);
+			if (!square.isNull())
+			{
+				m_resultEmitter.emitResultsReady(m_path, square);
 				return;
-			QImage image(m_path);
-			if (image.isNull())
+			}
+
+			QImageReader reader(m_path);
+			QSize size = reader.size();
+			if (size.isValid())
+			{
+				size.scale(256, 256, Qt::KeepAspectRatio);
+				reader.setScaledSize(size);
+			}
+			QImage small = reader.read();
+			if (small.isNull())
 			{
 				QThread::msleep(500);
 				tries--;
 				continue;
 			}
-			QImage small;
-			if (image.width() > image.height())
-				small = image.scaledToWidth(512).scaledToWidth(256, Qt::SmoothTransformation);
-			else
-				small = image.scaledToHeight(512).scaledToHeight(256, Qt::SmoothTransformation);
+			if (small.width() > 256 || small.height() > 256)
+			{
+				small = small.scaled(256, 256, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+			}
 			QPoint offset((256 - small.width()) / 2, (256 - small.height()) / 2);
-			QImage square(QSize(256, 256), QImage::Format_ARGB32);
+			square = QImage(QSize(256, 256), QImage::Format_ARGB32);
 			square.fill(Qt::transparent);
 
 			QPainter painter(&square);
 			painter.drawImage(offset, small);
 			painter.end();
 
-			QIcon icon(QPixmap::fromImage(square));
-			m_cache->add(m_path, icon);
-			m_resultEmitter.emitResultsReady(m_path);
+			if (FS::ensureFilePathExists(cachedFile))
+			{
+				QSaveFile out(cachedFile);
+				if (out.open(QIODevice::WriteOnly) && square.save(&out, "PNG"))
+				{
+					out.commit();
+				}
+			}
+			m_resultEmitter.emitResultsReady(m_path, square);
 			return;
 		}
 		m_resultEmitter.emitResultsFailed(m_path);
 	}
 	QString m_path;
-	SharedIconCachePtr m_cache;
+	QString m_cachePath;
 	ThumbnailingResult m_resultEmitter;
 };
 
+/**
+ * Keeps the thumbnail folder under its size limit by removing the oldest thumbnails.
+ *
+ * Thumbnails of screenshots that changed while the page was open are removed right away, this
+ * catches the ones left behind by screenshots changed or deleted while it was not.
+ */
+class ThumbnailPruneRunnable : public QRunnable
+{
+public:
+	ThumbnailPruneRunnable(QString cachePath, qint64 maxBytes)
+	{
+		m_cachePath = cachePath;
+		m_maxBytes = maxBytes;
+	}
+	void run()
+	{
+		auto entries = QDir(m_cachePath).entryInfoList({"*.png"}, QDir::Files, QDir::Time | QDir::Reversed);
+		qint64 total = 0;
+		for (auto &entry : entries)
+		{
+			total += entry.size();
+		}
+		for (auto &entry : entries)
+		{
+			if (total <= m_maxBytes)
+				break;
+			if (QFile::remove(entry.absoluteFilePath()))
+			{
+				total -= entry.size();
+			}
+		}
+	}
+	QString m_cachePath;
+	qint64 m_maxBytes;
+};
+
 // this is about as elegant and well written as a bag of bricks with scribbles done by insane
 // asylum patients.
 class FilterModel : public QIdentityProxyModel
 {
 	Q_OBJECT
 public:
-	explicit FilterModel(QObject *parent = 0) : QIdentityProxyModel(parent)
+	explicit FilterModel(QObject *parent = 0)
+		: QIdentityProxyModel(parent),
+		  m_thumbnailCache(MMC->settings()->get("ThumbnailCacheMB").toLongLong() * 1024 * 1024)
 	{
 		m_thumbnailingPool.setMaxThreadCount(4);
-		m_thumbnailCache = std::make_shared<SharedIconCache>();
-		m_thumbnailCache->add("placeholder", MMC->getThemedIcon("screenshot-placeholder"));
-		connect(&watcher, SIGNAL(fileChanged(QString)), SLOT(fileChanged(QString)));
-		// FIXME: the watched file set is not updated when files are removed
+		m_thumbnailCachePath = QDir("cache/thumbnails").absolutePath();
+		m_thumbnailingPool.start(new ThumbnailPruneRunnable(m_thumbnailCachePath, maxThumbnailFolderBytes));
+		m_placeholder = MMC->getThemedIcon("screenshot-placeholder");
+
+		// one watch for the whole folder, changed files are found by comparing snapshots
+		connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() { m_rescanTimer.start(); });
+		m_rescanTimer.setSingleShot(true);
+		m_rescanTimer.setInterval(250);
+		connect(&m_rescanTimer, &QTimer::timeout, this, &FilterModel::rescanDirectory);
+
+		// finished thumbnails are announced together
+		m_changedTimer.setSingleShot(true);
+		m_changedTimer.setInterval(50);
+		connect(&m_changedTimer, &QTimer::timeout, this, &FilterModel::emitThumbnailsChanged);
+
+		// how the cache does while the page is open
+		m_statsTimer.setInterval(30000);
+		connect(&m_statsTimer, &QTimer::timeout, this, &FilterModel::logCacheStats);
+		m_statsTimer.start();
+	}
+	virtual ~FilterModel()
+	{
+		logCacheStats();
+		m_queue.clear();
+		m_thumbnailingPool.waitForDone(500);
+	}
+
+	/// Watch the folder with the screenshots for changes to the files in it.
+	void watchDirectory(const QString &path)
+	{
+		if (!m_directory.isEmpty())
+		{
+			m_watcher.removePath(m_directory);
+		}
+		m_directory = path;
+		m_watcher.addPath(m_directory);
+		m_snapshot = takeSnapshot();
 	}
-	virtual ~FilterModel() { m_thumbnailingPool.waitForDone(500); }
 	virtual QVariant data(const QModelIndex &proxyIndex, int role = Qt::DisplayRole) const
 	{
 		auto model = sourceModel();
@@ -124,20 +299,15 @@ public:
 				sourceModel()->data(mapToSource(proxyIndex), QFileSystemModel::FilePathRole);
 			QString filePath = result.toString();
 			QIcon temp;
-			if (!watched.contains(filePath))
-			{
-				((QFileSystemWatcher &)watcher).addPath(filePath);
-				((QSet<QString> &)watched).insert(filePath);
-			}
-			if (m_thumbnailCache->get(filePath, temp))
+			if (m_thumbnailCache.get(filePath, temp))
 			{
 				return temp;
 			}
 			if (!m_failed.contains(filePath))
 			{
-				((FilterModel *)this)->thumbnailImage(filePath);
+				((FilterModel *)this)->thumbnailImage(filePath, false);
 			}
-			return (m_thumbnailCache->get("placeholder"));
+			return m_placeholder;
 		}
 		return sourceModel()->data(mapToSource(proxyIndex), role);
 	}
@@ -158,34 +328,211 @@ public:
 		return model->setData(mapToSource(index), value.toString() + ".png", role);
 	}
 
+	const ThumbnailCache &thumbnailCache() const
+	{
+		return m_thumbnailCache;
+	}
+
+	/// Thumbnail these files before anything else. Used for the items that are on screen.
+	void prioritize(const QStringList &paths)
+	{
+		for (auto iter = paths.crbegin(); iter != paths.crend(); iter++)
+		{
+			const auto &path = *iter;
+			if (m_queued.contains(path))
+			{
+				m_queue.removeOne(path);
+				m_queue.prepend(path);
+			}
+			else if (!m_running.contains(path) && !m_failed.contains(path) && !m_thumbnailCache.contains(path))
+			{
+				thumbnailImage(path, true);
+			}
+		}
+		startMoreThumbnails();
+	}
+
 private:
-	void thumbnailImage(QString path)
+	void thumbnailImage(QString path, bool urgent)
 	{
-		auto runnable = new ThumbnailRunnable(path, m_thumbnailCache);
-		connect(&(runnable->m_resultEmitter), SIGNAL(resultsReady(QString)),
-				SLOT(thumbnailReady(QString)));
-		connect(&(runnable->m_resultEmitter), SIGNAL(resultsFailed(QString)),
-				SLOT(thumbnailFailed(QString)));
-		((QThreadPool &)m_thumbnailingPool).start(runnable);
+		if (m_queued.contains(path) || m_running.contains(path))
+		{
+			return;
+		}
+		m_queued.insert(path);
+		if (urgent)
+		{
+			m_queue.prepend(path);
+		}
+		else
+		{
+			m_queue.append(path);
+		}
+		startMoreThumbnails();
+	}
+	void startMoreThumbnails()
+	{
+		// only a few are handed to the pool, so the queue can still be reordered
+		while (m_running.size() < m_thumbnailingPool.maxThreadCount() && !m_queue.isEmpty())
+		{
+			auto path = m_queue.takeFirst();
+			m_queued.remove(path);
+			m_running.insert(path);
+			auto runnable = new ThumbnailRunnable(path, m_thumbnailCachePath);
+			connect(&(runnable->m_resultEmitter), &ThumbnailingResult::resultsReady,
+					this, &FilterModel::thumbnailReady);
+			connect(&(runnable->m_resultEmitter), &ThumbnailingResult::resultsFailed,
+					this, &FilterModel::thumbnailFailed);
+			m_thumbnailingPool.start(runnable);
+		}
 	}
 private slots:
-	void thumbnailReady(QString path) { emit layoutChanged(); }
-	void thumbnailFailed(QString path) { m_failed.insert(path); }
-	void fileChanged(QString filepath)
+	void thumbnailReady(QString path, QImage image)
+	{
+		m_running.remove(path);
+		if (m_outdated.remove(path))
+		{
+			if (QFileInfo::exists(path))
+				thumbnailImage(path, true);
+			return;
+		}
+		m_thumbnailCache.add(path, image);
+		m_changed.insert(path);
+		if (!m_changedTimer.isActive())
+		{
+			m_changedTimer.start();
+		}
+		startMoreThumbnails();
+	}
+	void thumbnailFailed(QString path)
+	{
+		m_running.remove(path);
+		if (m_outdated.remove(path))
+		{
+			if (QFileInfo::exists(path))
+				thumbnailImage(path, true);
+			return;
+		}
+		m_failed.insert(path);
+		startMoreThumbnails();
+	}
+	void emitThumbnailsChanged()
+	{
+		auto model = qobject_cast<QFileSystemModel *>(sourceModel());
+		if (!model)
+		{
+			m_changed.clear();
+			return;
+		}
+		// group the rows into contiguous ranges, one dataChanged per range
+		QMap<QModelIndex, QList<int>> rowsByParent;
+		for (auto &path : m_changed)
+		{
+			auto index = mapFromSource(model->index(path));
+			if (index.isValid())
+			{
+				rowsByParent[index.parent()].append(index.row());
+			}
+		}
+		m_changed.clear();
+		for (auto iter = rowsByParent.begin(); iter != rowsByParent.end(); iter++)
+		{
+			auto rows = iter.value();
+			std::sort(rows.begin(), rows.end());
+			int first = rows.first();
+			int last = first;
+			for (int i = 1; i <= rows.size(); i++)
+			{
+				if (i < rows.size() && rows[i] == last + 1)
+				{
+					last = rows[i];
+					continue;
+				}
+				emit dataChanged(index(first, 0, iter.key()), index(last, 0, iter.key()), {Qt::DecorationRole});
+				if (i < rows.size())
+				{
+					first = last = rows[i];
+				}
+			}
+		}
+	}
+	void logCacheStats()
 	{
-		m_thumbnailCache->setStale(filepath);
-		thumbnailImage(filepath);
-		// reinsert the path...
-		watcher.removePath(filepath);
-		watcher.addPath(filepath);
+		// nothing new to tell
+		auto lookups = m_thumbnailCache.hits() + m_thumbnailCache.misses();
+		if (lookups == m_loggedLookups)
+			return;
+		m_loggedLookups = lookups;
+		qDebug() << "Screenshot thumbnail cache:" << m_thumbnailCache.stats();
+	}
+	void rescanDirectory()
+	{
+		auto snapshot = takeSnapshot();
+		for (auto iter = m_snapshot.begin(); iter != m_snapshot.end(); iter++)
+		{
+			auto current = snapshot.find(iter.key());
+			if (current == snapshot.end() || current.value() != iter.value())
+			{
+				// the thumbnail of the old file will never be asked for again
+				QFile::remove(cachedThumbnailPath(m_thumbnailCachePath, iter.key(), iter.value().first, iter.value().second));
+				fileChanged(iter.key(), current != snapshot.end());
+			}
+		}
+		m_snapshot = snapshot;
+	}
+	void fileChanged(const QString &path, bool exists)
+	{
+		m_thumbnailCache.remove(path);
+		m_failed.remove(path);
+		if (m_running.contains(path))
+		{
+			// the result would be outdated, do it again afterwards
+			m_outdated.insert(path);
+		}
+		else if (exists)
+		{
+			thumbnailImage(path, true);
+		}
+		else if (m_queued.remove(path))
+		{
+			m_queue.removeOne(path);
+		}
+	}
+
+private:
+	typedef QHash<QString, QPair<qint64, qint64>> Snapshot;
+	// size and modification time of every screenshot in the folder
+	Snapshot takeSnapshot() const
+	{
+		Snapshot snapshot;
+		if (m_directory.isEmpty())
+			return snapshot;
+		auto entries = QDir(m_directory).entryInfoList({"*.png"}, QDir::Files);
+		for (auto &entry : entries)
+		{
+			snapshot.insert(entry.absoluteFilePath(), qMakePair(entry.size(), entry.lastModified().toMSecsSinceEpoch()));
+		}
+		return snapshot;
 	}
 
 private:
-	SharedIconCachePtr m_thumbnailCache;
+	mutable ThumbnailCache m_thumbnailCache;
+	QIcon m_placeholder;
+	QString m_thumbnailCachePath;
 	QThreadPool m_thumbnailingPool;
+	QList<QString> m_queue;
+	QSet<QString> m_queued;
+	QSet<QString> m_running;
+	QSet<QString> m_outdated;
 	QSet<QString> m_failed;
-	QSet<QString> watched;
-	QFileSystemWatcher watcher;
+	QSet<QString> m_changed;
+	QTimer m_changedTimer;
+	QTimer m_statsTimer;
+	qint64 m_loggedLookups = 0;
+	QString m_directory;
+	Snapshot m_snapshot;
+	QTimer m_rescanTimer;
+	QFileSystemWatcher m_watcher;
 };
 
 class CenteredEditingDelegate : public QStyledItemDelegate
@@ -234,6 +581,35 @@ ScreenshotsPage::ScreenshotsPage(QString path, QWidget *parent)
 	ui->listView->setEditTriggers(0);
 	ui->listView->setItemDelegate(new CenteredEditingDelegate(this));
 	connect(ui->listView, SIGNAL(activated(QModelIndex)), SLOT(onItemActivated(QModelIndex)));
+
+	// whatever is on screen gets its thumbnail first
+	m_visibleTimer.setSingleShot(true);
+	m_visibleTimer.setInterval(50);
+	connect(&m_visibleTimer, &QTimer::timeout, this, &ScreenshotsPage::updateVisibleThumbnails);
+	auto scheduleUpdate = [this]() { m_visibleTimer.start(); };
+	connect(ui->listView->verticalScrollBar(), &QScrollBar::valueChanged, this, scheduleUpdate);
+	connect(ui->listView->verticalScrollBar(), &QScrollBar::rangeChanged, this, scheduleUpdate);
+	connect(m_filterModel.get(), &QAbstractItemModel::rowsInserted, this, scheduleUpdate);
+	connect(m_filterModel.get(), &QAbstractItemModel::layoutChanged, this, scheduleUpdate);
+}
+
+void ScreenshotsPage::updateVisibleThumbnails()
+{
+	if (!ui->listView->model())
+		return;
+	auto root = ui->listView->rootIndex();
+	auto viewportRect = ui->listView->viewport()->rect();
+	QStringList visible;
+	int rows = m_filterModel->rowCount(root);
+	for (int i = 0; i < rows; i++)
+	{
+		auto index = m_filterModel->index(i, 0, root);
+		if (ui->listView->visualRect(index).intersects(viewportRect))
+		{
+			visible.append(m_model->filePath(m_filterModel->mapToSource(index)));
+		}
+	}
+	m_filterModel->prioritize(visible);
 }
 
 bool ScreenshotsPage::eventFilter(QObject *obj, QEvent *evt)
@@ -361,6 +737,8 @@ void ScreenshotsPage::opened()
 		{
 			ui->listView->setModel(m_filterModel.get());
 			ui->listView->setRootIndex(m_filterModel->mapFromSource(idx));
+			m_filterModel->watchDirectory(path);
+			m_visibleTimer.start();
 		}
 		else
 		{
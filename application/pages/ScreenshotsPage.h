@@ -16,12 +16,13 @@
 #pragma once
 
 #include <QWidget>
+#include <QTimer>
 
 #include "BasePage.h"
 #include <MultiMC.h>
 
 class QFileSystemModel;
-class QIdentityProxyModel;
+class FilterModel;
 namespace Ui
 {
 class ScreenshotsPage;
@@ -73,11 +74,13 @@ private slots:
 	void on_renameBtn_clicked();
 	void on_viewFolderBtn_clicked();
 	void onItemActivated(QModelIndex);
+	void updateVisibleThumbnails();
 
 private:
 	Ui::ScreenshotsPage *ui;
 	std::shared_ptr<QFileSystemModel> m_model;
-	std::shared_ptr<QIdentityProxyModel> m_filterModel;
+	std::shared_ptr<FilterModel> m_filterModel;
+	QTimer m_visibleTimer;
 	QString m_folder;
 	bool m_valid = false;
 	bool m_uploadActive = false;
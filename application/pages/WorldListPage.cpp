@@ -38,8 +38,10 @@ WorldListPage::WorldListPage(BaseInstance *inst, std::shared_ptr<WorldList> worl
 {
 	ui->setupUi(this);
 	ui->tabWidget->tabBar()->hide();
+	m_worlds->setComputeSizes(true);
 	QSortFilterProxyModel * proxy = new QSortFilterProxyModel(this);
 	proxy->setSortCaseSensitivity(Qt::CaseInsensitive);
+	proxy->setSortRole(WorldList::SortRole);
 	proxy->setSourceModel(m_worlds.get());
 	ui->worldTreeView->setSortingEnabled(true);
 	ui->worldTreeView->setModel(proxy);
@@ -49,6 +51,7 @@ WorldListPage::WorldListPage(BaseInstance *inst, std::shared_ptr<WorldList> worl
 
 	head->setSectionResizeMode(0, QHeaderView::Stretch);
 	head->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+	head->setSectionResizeMode(2, QHeaderView::ResizeToContents);
 	connect(ui->worldTreeView->selectionModel(),
 			SIGNAL(currentChanged(const QModelIndex &, const QModelIndex &)), this,
 			SLOT(worldChanged(const QModelIndex &, const QModelIndex &)));
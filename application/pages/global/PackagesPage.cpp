@@ -95,7 +95,7 @@ QIcon PackagesPage::icon() const
 
 void PackagesPage::on_refreshIndexBtn_clicked()
 {
-	ENV.metadataIndex()->load();
+	ENV.metadataIndex()->load(true);
 }
 void PackagesPage::on_refreshFileBtn_clicked()
 {
@@ -104,7 +104,7 @@ void PackagesPage::on_refreshFileBtn_clicked()
 	{
 		return;
 	}
-	list->load();
+	list->load(true);
 }
 void PackagesPage::on_refreshVersionBtn_clicked()
 {
@@ -113,7 +113,7 @@ void PackagesPage::on_refreshVersionBtn_clicked()
 	{
 		return;
 	}
-	version->load();
+	version->load(true);
 }
 
 void PackagesPage::on_fileSearchEdit_textChanged(const QString &search)
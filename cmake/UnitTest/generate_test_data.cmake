@@ -7,15 +7,22 @@ function(configure_files srcDir destDir)
 	file(GLOB templateFiles RELATIVE ${srcDir} ${srcDir}/*)
 	foreach(templateFile ${templateFiles})
 		set(srcTemplatePath ${srcDir}/${templateFile})
-		if(NOT IS_DIRECTORY ${srcTemplatePath})
+		if(IS_DIRECTORY ${srcTemplatePath})
+			configure_files("${srcTemplatePath}" "${destDir}/${templateFile}")
+		elseif(templateFile MATCHES "\\.(delta|jar|zip)$")
+			# binary files are copied as they are
+			configure_file(
+					${srcTemplatePath}
+					${destDir}/${templateFile}
+					COPYONLY
+			)
+		else()
 			configure_file(
 					${srcTemplatePath}
 					${destDir}/${templateFile}
 					@ONLY
 					NEWLINE_STYLE LF
 			)
-		else()
-			configure_files("${srcTemplatePath}" "${destDir}/${templateFile}")
 		endif()
 	endforeach()
 endfunction()
@@ -0,0 +1,161 @@
+#pragma once
+#include "membuffer.h"
+#include <cstring>
+
+namespace java
+{
+/**
+ * Walks the constant pool of a class file and stops at each UTF-8 constant.
+ *
+ * Nothing is copied or allocated - the constants point into the class file data, so this is
+ * the cheap way to sniff a class for a string. Use java::classfile if you need the whole thing.
+ */
+class constant_scanner
+{
+public:
+	enum tag_t : uint8_t
+	{
+		t_utf8 = 1,
+		t_int = 3,
+		t_float = 4,
+		t_long = 5,
+		t_double = 6,
+		t_class = 7,
+		t_string = 8,
+		t_fieldref = 9,
+		t_methodref = 10,
+		t_interface_methodref = 11,
+		t_nameandtype = 12,
+		t_methodhandle = 15,
+		t_methodtype = 16,
+		t_dynamic = 17,
+		t_invokedynamic = 18,
+		t_module = 19,
+		t_package = 20
+	};
+
+	constant_scanner(char *data, std::size_t size) : buf(data, size)
+	{
+		uint32_t magic = 0;
+		if (!can_read(10))
+			return;
+		buf.read_be(magic);
+		if (magic != 0xCAFEBABE)
+			return;
+		// minor and major version
+		buf.skip(4);
+		buf.read_be(count);
+		good = true;
+	}
+
+	/**
+	 * Move to the next UTF-8 constant.
+	 * Returns false at the end of the pool, or if the class file is broken (see valid()).
+	 */
+	bool next()
+	{
+		while (good && ++current_index < count)
+		{
+			uint8_t tag = 0;
+			if (!can_read(1))
+				return fail();
+			buf.read(tag);
+			std::size_t skip = 0;
+			switch (tag)
+			{
+			case t_utf8:
+			{
+				if (!can_read(2))
+					return fail();
+				buf.read_be(str_length);
+				if (!can_read(str_length))
+					return fail();
+				str = buf.position();
+				buf.skip(str_length);
+				return true;
+			}
+			case t_class:
+			case t_string:
+			case t_methodtype:
+			case t_module:
+			case t_package:
+				skip = 2;
+				break;
+			case t_methodhandle:
+				skip = 3;
+				break;
+			case t_int:
+			case t_float:
+			case t_fieldref:
+			case t_methodref:
+			case t_interface_methodref:
+			case t_nameandtype:
+			case t_dynamic:
+			case t_invokedynamic:
+				skip = 4;
+				break;
+			case t_long:
+			case t_double:
+				skip = 8;
+				// these take up two slots in the pool
+				current_index++;
+				break;
+			default:
+				return fail();
+			}
+			if (!can_read(skip))
+				return fail();
+			buf.skip(skip);
+		}
+		return false;
+	}
+
+	/// false if the data isn't a class file or it ended in the middle of the constant pool
+	bool valid() const
+	{
+		return good;
+	}
+
+	/// index of the current constant in the pool
+	uint16_t index() const
+	{
+		return current_index;
+	}
+
+	/// the current constant, in 'modified UTF-8'. Not zero terminated.
+	const char *data() const
+	{
+		return str;
+	}
+
+	uint16_t length() const
+	{
+		return str_length;
+	}
+
+	bool starts_with(const char *prefix) const
+	{
+		std::size_t prefix_length = std::strlen(prefix);
+		return str_length >= prefix_length && std::memcmp(str, prefix, prefix_length) == 0;
+	}
+
+private:
+	bool can_read(std::size_t size) const
+	{
+		return buf.remaining() >= size;
+	}
+	bool fail()
+	{
+		good = false;
+		return false;
+	}
+
+private:
+	util::membuffer buf;
+	bool good = false;
+	uint16_t count = 0;
+	uint16_t current_index = 0;
+	const char *str = nullptr;
+	uint16_t str_length = 0;
+};
+}
@@ -14,7 +14,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
-#include "classfile.h"
+#include "constantscanner.h"
 #include "javautils.h"
 
 #include <QFile>
@@ -44,36 +44,23 @@ QString GetMinecraftJarVersion(QString jarName)
 		return version;
 
 	// read Minecraft.class
-	qint64 size = Minecraft.size();
-	char *classfile = new char[size];
-	Minecraft.read(classfile, size);
+	QByteArray classfile = Minecraft.readAll();
 
-	// parse Minecraft.class
-	try
+	// look for the version string in the constant pool, without parsing the whole class
+	static const char *prefix = "Minecraft Minecraft ";
+	java::constant_scanner constants(classfile.data(), classfile.size());
+	while (constants.next())
 	{
-		char *temp = classfile;
-		java::classfile MinecraftClass(temp, size);
-		java::constant_pool constants = MinecraftClass.constants;
-		for (java::constant_pool::container_type::const_iterator iter = constants.begin();
-			 iter != constants.end(); iter++)
+		if (constants.starts_with(prefix))
 		{
-			const java::constant &constant = *iter;
-			if (constant.type != java::constant::j_string_data)
-				continue;
-			const std::string &str = constant.str_data;
-			if (str.compare(0, 20, "Minecraft Minecraft ") == 0)
-			{
-				version = str.substr(20).data();
-				break;
-			}
+			auto prefixLength = strlen(prefix);
+			version = QString::fromUtf8(constants.data() + prefixLength,
+										constants.length() - prefixLength);
+			break;
 		}
 	}
-	catch (java::classfile_exception &)
-	{
-	}
 
 	// clean up
-	delete[] classfile;
 	Minecraft.close();
 	zip.close();
 	jar.close();
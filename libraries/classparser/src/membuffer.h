@@ -56,6 +56,20 @@ public:
 	{
 		current += N;
 	}
+	/**
+		* How many bytes are left to read
+		*/
+	std::size_t remaining() const
+	{
+		return end - current;
+	}
+	/**
+		* The current position, for looking at data in place
+		*/
+	const char *position() const
+	{
+		return current;
+	}
 
 private:
 	char *start, *end, *current;
@@ -0,0 +1,136 @@
+/*
+ * This is trivial. Do what thou wilt with it. Public domain.
+ */
+
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include "unpack200.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// peak resident set size of this process in KiB, -1 if unknown
+static long peak_rss_kib()
+{
+#if defined(_WIN32)
+	return -1;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return -1;
+#if defined(__APPLE__)
+	// bytes on macOS
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		std::cerr << "Pack200 unpacker benchmark!" << std::endl << "Run like this:" << std::endl
+				  << "  " << argv[0] << " [-n iterations] [-t threads] [-c store|fast|best] file.pack [file.pack ...]"
+				  << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int iterations = 5;
+	unpack_200_options options;
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "-n" && i + 1 < argc)
+		{
+			iterations = std::atoi(argv[++i]);
+			continue;
+		}
+		if (arg == "-t" && i + 1 < argc)
+		{
+			options.threads = std::atoi(argv[++i]);
+			continue;
+		}
+		if (arg == "-c" && i + 1 < argc)
+		{
+			std::string mode = argv[++i];
+			if (mode == "store")
+				options.compression = UNPACK_200_STORE;
+			else if (mode == "fast")
+				options.compression = UNPACK_200_FAST;
+			else
+				options.compression = UNPACK_200_BEST;
+			continue;
+		}
+		files.push_back(arg);
+	}
+	if (iterations < 1)
+		iterations = 1;
+
+	double total_in = 0;
+	double total_out = 0;
+	double total_seconds = 0;
+	for (auto &file : files)
+	{
+		std::ifstream in(file, std::ios::binary);
+		if (!in)
+		{
+			std::cerr << "Can't open input file " << file << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+		// the jar only gets counted, so the numbers are about the unpacker and not the disk
+		size_t written = 0;
+		auto sink = [&](const void *, size_t len)
+		{
+			written += len;
+			return true;
+		};
+
+		auto start = std::chrono::steady_clock::now();
+		try
+		{
+			for (int i = 0; i < iterations; i++)
+			{
+				written = 0;
+				unpack_200(data.data(), data.size(), sink, options);
+			}
+		}
+		catch (std::runtime_error &e)
+		{
+			std::cerr << file << ": " << e.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		double seconds = elapsed.count() / iterations;
+		double in_mb = data.size() / (1024.0 * 1024.0);
+		double out_mb = written / (1024.0 * 1024.0);
+		std::cout << file << ": " << in_mb << " MB -> " << out_mb << " MB in " << seconds * 1000.0
+				  << " ms, " << in_mb / seconds << " MB/s in, " << out_mb / seconds << " MB/s out"
+				  << std::endl;
+		total_in += in_mb;
+		total_out += out_mb;
+		total_seconds += seconds;
+	}
+	if (total_seconds > 0)
+	{
+		std::cout << "total: " << total_in / total_seconds << " MB/s in, "
+				  << total_out / total_seconds << " MB/s out" << std::endl;
+	}
+	long rss = peak_rss_kib();
+	if (rss >= 0)
+	{
+		std::cout << "peak RSS: " << rss / 1024.0 << " MB" << std::endl;
+	}
+	return EXIT_SUCCESS;
+}
@@ -25,13 +25,76 @@
 
 #pragma once
 
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+
 #include "multimc_unpack200_export.h"
 
+/// How the entries of the output JAR are compressed
+enum unpack_200_compression
+{
+	/// everything is stored, for JARs that are only ever read locally
+	UNPACK_200_STORE,
+	/// deflate at the fastest level
+	UNPACK_200_FAST,
+	/// deflate at the best level, like the original unpacker
+	UNPACK_200_BEST
+};
+
+struct unpack_200_options
+{
+	unpack_200_compression compression = UNPACK_200_BEST;
+	/// number of threads deflating entries, 0 means one per core. The output is the same for any value.
+	int threads = 0;
+};
+
+/**
+ * Fills buf with up to maxlen bytes of PACK200 input.
+ * Returns the number of bytes read, 0 at the end of the input.
+ */
+typedef std::function<int64_t(void *buf, int64_t maxlen)> unpack_200_reader;
+
+/**
+ * Receives the next len bytes of the output JAR.
+ * Returning false aborts the unpacking.
+ */
+typedef std::function<bool(const void *buf, size_t len)> unpack_200_writer;
+
 /**
  * @brief Unpack a PACK200 file
  *
  * @param input_path Path to the input file in PACK200 format. System native string encoding.
  * @param output_path Path to the output file in PACK200 format. System native string encoding.
+ * @param options How the output JAR is compressed.
+ * @throw std::runtime_error for any error encountered
+ */
+MULTIMC_UNPACK200_EXPORT void unpack_200(FILE * input_path, FILE * output_path,
+										 const unpack_200_options &options = unpack_200_options());
+
+/**
+ * @brief Unpack a PACK200 stream without going through files
+ *
+ * The input is pulled from the reader as the unpacker needs it, and the JAR is pushed to the
+ * writer as it is produced, so this can sit in the middle of a download or decompression pipeline.
+ *
+ * @param input Source of the PACK200 data (optionally gzipped).
+ * @param output Sink for the JAR file.
+ * @param options How the output JAR is compressed.
+ * @throw std::runtime_error for any error encountered
+ */
+MULTIMC_UNPACK200_EXPORT void unpack_200(const unpack_200_reader &input, const unpack_200_writer &output,
+										 const unpack_200_options &options = unpack_200_options());
+
+/**
+ * @brief Unpack PACK200 data that is already in memory
+ *
+ * @param data The PACK200 data (optionally gzipped).
+ * @param size Size of the data in bytes.
+ * @param output Sink for the JAR file.
+ * @param options How the output JAR is compressed.
  * @throw std::runtime_error for any error encountered
  */
-MULTIMC_UNPACK200_EXPORT void unpack_200(FILE * input_path, FILE * output_path);
+MULTIMC_UNPACK200_EXPORT void unpack_200(const void *data, size_t size, const unpack_200_writer &output,
+										 const unpack_200_options &options = unpack_200_options());
@@ -3473,7 +3473,7 @@ void constant_pool::computeOutputIndexes()
 // Unpacker Start
 // Deallocate all internal storage and reset to a clean state.
 // Do not disturb any input or output connections, including
-// infileptr, inbytes, read_input_fn, jarout, or errstrm.
+// infileptr, input_cookie, inbytes, read_input_fn, jarout, or errstrm.
 // Do not reset any unpack options.
 void unpacker::reset()
 {
@@ -3509,6 +3509,7 @@ void unpacker::reset()
 
 	// restore selected interface state:
 	infileptr = save_u.infileptr;
+	input_cookie = save_u.input_cookie;
 	inbytes = save_u.inbytes;
 	jarout = save_u.jarout;
 	gzin = save_u.gzin;
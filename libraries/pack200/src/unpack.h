@@ -159,6 +159,7 @@ struct unpacker
 
 	// if running Unix-style, here are the inputs and outputs
 	FILE *infileptr; // buffered
+	void *input_cookie; // for read_input_fn implementations that aren't stdio
 	bytes inbytes;   // direct
 	gunzip *gzin;	// gunzip filter, if any
 	jar *jarout;	 // output JAR file
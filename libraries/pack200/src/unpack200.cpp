@@ -32,6 +32,7 @@
 #include <limits.h>
 #include <time.h>
 #include <stdint.h>
+#include <thread>
 
 #include "constants.h"
 #include "utils.h"
@@ -71,6 +72,33 @@ static int64_t read_input_via_stdio(unpacker *u, void *buf, int64_t minlen, int6
 	return numread;
 }
 
+// Callback for fetching data through a user supplied function.
+static int64_t read_input_via_callback(unpacker *u, void *buf, int64_t minlen, int64_t maxlen)
+{
+	assert(u->input_cookie != nullptr);
+	assert(minlen <= maxlen);
+	auto &reader = *(const unpack_200_reader *)u->input_cookie;
+	int64_t numread = 0;
+	char *bufptr = (char *)buf;
+	while (numread < minlen)
+	{
+		int64_t nr = reader(bufptr, maxlen - numread);
+		if (nr <= 0)
+			break;
+		numread += nr;
+		bufptr += nr;
+		assert(numread <= maxlen);
+	}
+	return numread;
+}
+
+// Callback for storing the jar through a user supplied function.
+static bool write_output_via_callback(void *cookie, const void *buf, size_t len)
+{
+	auto &writer = *(const unpack_200_writer *)cookie;
+	return writer(buf, len);
+}
+
 enum
 {
 	EOF_MAGIC = 0,
@@ -94,7 +122,80 @@ static int read_magic(unpacker *u, char peek[], int peeklen)
 	return magic;
 }
 
-void unpack_200(FILE *input, FILE *output)
+static void apply_options(jar &jarout, const unpack_200_options &options)
+{
+	jarout.compression = options.compression;
+	int threads = options.threads;
+	if (threads <= 0)
+		threads = (int)std::thread::hardware_concurrency();
+	jarout.threads = threads < 1 ? 1 : threads;
+}
+
+// Unpacks all the segments the unpacker's input has into its jar.
+static void run_unpacker(unpacker &u)
+{
+	try
+	{
+		// read the magic!
+		char peek[4];
+		int magic;
+		magic = read_magic(&u, peek, (int)sizeof(peek));
+
+		// if it is a gzip encoded file, we need an extra gzip input filter
+		if ((magic & GZIP_MAGIC_MASK) == GZIP_MAGIC)
+		{
+			gunzip *gzin = NEW(gunzip, 1);
+			gzin->init(&u);
+			// FIXME: why the side effects? WHY?
+			u.gzin->start(magic);
+			u.start();
+		}
+		else
+		{
+			// otherwise, feed the bytes to the unpacker directly
+			u.start(peek, sizeof(peek));
+		}
+
+		// Note:  The checks to u.aborting() are necessary to gracefully
+		// terminate processing when the first segment throws an error.
+		for (;;)
+		{
+			// Each trip through this loop unpacks one segment
+			// and then resets the unpacker.
+			for (unpacker::file *filep; (filep = u.get_next_file()) != nullptr;)
+			{
+				u.write_file_to_jar(filep);
+			}
+
+			// Peek ahead for more data.
+			magic = read_magic(&u, peek, (int)sizeof(peek));
+			if (magic != (int)JAVA_PACKAGE_MAGIC)
+			{
+				// we do not feel strongly about this kind of thing...
+				/*
+				if (magic != EOF_MAGIC)
+					unpack_abort("garbage after end of pack archive");
+				*/
+				break; // all done
+			}
+
+			// Release all storage from parsing the old segment.
+			u.reset();
+			// Restart, beginning with the peek-ahead.
+			u.start(peek, sizeof(peek));
+		}
+		u.finish();
+	}
+	catch (...)
+	{
+		// the in-memory variants are used in a long running process, don't leak the segment
+		u.free();
+		throw;
+	}
+	u.free(); // tidy up malloc blocks
+}
+
+void unpack_200(FILE *input, FILE *output, const unpack_200_options &options)
 {
 	unpacker u;
 	u.init(read_input_via_stdio);
@@ -104,59 +205,47 @@ void unpack_200(FILE *input, FILE *output)
 	jar jarout;
 	jarout.init(&u);
 	jarout.jarfp = output;
+	apply_options(jarout, options);
 
 	// the input doesn't
 	u.infileptr = input;
 
-	// read the magic!
-	char peek[4];
-	int magic;
-	magic = read_magic(&u, peek, (int)sizeof(peek));
+	run_unpacker(u);
+	fclose(input);
+}
 
-	// if it is a gzip encoded file, we need an extra gzip input filter
-	if ((magic & GZIP_MAGIC_MASK) == GZIP_MAGIC)
-	{
-		gunzip *gzin = NEW(gunzip, 1);
-		gzin->init(&u);
-		// FIXME: why the side effects? WHY?
-		u.gzin->start(magic);
-		u.start();
-	}
-	else
-	{
-		// otherwise, feed the bytes to the unpacker directly
-		u.start(peek, sizeof(peek));
-	}
+void unpack_200(const unpack_200_reader &input, const unpack_200_writer &output,
+				const unpack_200_options &options)
+{
+	unpacker u;
+	u.init(read_input_via_callback);
+	u.input_cookie = (void *)&input;
 
-	// Note:  The checks to u.aborting() are necessary to gracefully
-	// terminate processing when the first segment throws an error.
-	for (;;)
-	{
-		// Each trip through this loop unpacks one segment
-		// and then resets the unpacker.
-		for (unpacker::file *filep; (filep = u.get_next_file()) != nullptr;)
-		{
-			u.write_file_to_jar(filep);
-		}
+	jar jarout;
+	jarout.init(&u);
+	jarout.write_output_fn = write_output_via_callback;
+	jarout.write_output_cookie = (void *)&output;
+	apply_options(jarout, options);
 
-		// Peek ahead for more data.
-		magic = read_magic(&u, peek, (int)sizeof(peek));
-		if (magic != (int)JAVA_PACKAGE_MAGIC)
-		{
-			// we do not feel strongly about this kind of thing...
-			/*
-			if (magic != EOF_MAGIC)
-				unpack_abort("garbage after end of pack archive");
-			*/
-			break; // all done
-		}
+	run_unpacker(u);
+}
 
-		// Release all storage from parsing the old segment.
-		u.reset();
-		// Restart, beginning with the peek-ahead.
-		u.start(peek, sizeof(peek));
-	}
-	u.finish();
-	u.free(); // tidy up malloc blocks
-	fclose(input);
+void unpack_200(const void *data, size_t size, const unpack_200_writer &output,
+				const unpack_200_options &options)
+{
+	// the unpacker wants to own its input buffer for multi-segment and gzipped archives,
+	// so the memory is handed to it through the same callback as any other stream
+	const char *position = (const char *)data;
+	size_t remaining = size;
+	auto reader = [&](void *buf, int64_t maxlen) -> int64_t
+	{
+		size_t count = remaining;
+		if ((int64_t)count > maxlen)
+			count = (size_t)maxlen;
+		memcpy(buf, position, count);
+		position += count;
+		remaining -= count;
+		return (int64_t)count;
+	};
+	unpack_200(reader, output, options);
 }
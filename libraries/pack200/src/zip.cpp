@@ -50,6 +50,14 @@
 
 #include "zlib.h"
 
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 inline uint32_t jar::get_crc32(uint32_t c, uchar *ptr, uint32_t len)
 {
 	return crc32(c, ptr, len);
@@ -66,23 +74,215 @@ inline uint32_t jar::get_crc32(uint32_t c, uchar *ptr, uint32_t len)
 
 #define GET_INT_HI(a) SWAP_BYTES((a >> 16) & 0xFFFF);
 
+// Deflates the concatenation of two buffers into out, at the given zlib level.
+// Returns the compressed size, or 0 if that failed or the data didn't get any smaller.
+static size_t deflate_parts(int level, const uchar *first, size_t first_len, const uchar *second,
+							size_t second_len, uchar *out, size_t out_len)
+{
+	size_t len = first_len + second_len;
+	z_stream zs;
+	BYTES_OF(zs).clear();
+
+	// NOTE: the window size should always be -MAX_WBITS normally -15.
+	// unzip/zipup.c and java/Deflater.c
+	int error = deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+	if (error != Z_OK)
+	{
+		return 0;
+	}
+	zs.next_out = out;
+	zs.avail_out = (uInt)out_len;
+
+	if (first_len != 0 && second_len != 0)
+	{
+		zs.next_in = (uchar *)first;
+		zs.avail_in = (uInt)first_len;
+		error = deflate(&zs, Z_NO_FLUSH);
+	}
+	else if (second_len == 0)
+	{
+		second = first;
+		second_len = first_len;
+	}
+	if (error == Z_OK)
+	{
+		zs.next_in = (uchar *)second;
+		zs.avail_in = (uInt)second_len;
+		error = deflate(&zs, Z_FINISH);
+	}
+	size_t clen = 0;
+	if (error == Z_STREAM_END && len > zs.total_out)
+	{
+		clen = zs.total_out;
+	}
+	deflateEnd(&zs);
+	return clen;
+}
+
+static int zlib_level(unpack_200_compression compression)
+{
+	return compression == UNPACK_200_FAST ? Z_BEST_SPEED : Z_BEST_COMPRESSION;
+}
+
+// One entry waiting for its data to be deflated by the pool.
+struct jar_deflate_job
+{
+	std::string name;
+	int modtime;
+	int len;
+	uint32_t crc;
+	std::vector<uchar> data;
+	std::vector<uchar> deflated;
+	size_t clen = 0;
+	bool done = false;
+};
+
+// Deflates entries on worker threads. Jobs finish in any order, but they are handed back in
+// the order they were queued, so the JAR comes out the same as if it was written serially.
+struct jar_deflater
+{
+	jar_deflater(int thread_count, int level) : level(level)
+	{
+		for (int i = 0; i < thread_count; i++)
+		{
+			workers.emplace_back([this]() { run(); });
+		}
+	}
+	~jar_deflater()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		work_available.notify_all();
+		for (auto &worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+	void queue(std::shared_ptr<jar_deflate_job> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			todo.push_back(job);
+			in_order.push_back(job);
+			queued_bytes += job->data.size();
+		}
+		work_available.notify_one();
+	}
+
+	// too much is waiting, the caller should stop feeding new entries until the oldest is done
+	bool saturated()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return in_order.size() > workers.size() * 4 || queued_bytes > max_queued_bytes;
+	}
+
+	// takes the oldest job if it is done, or waits for it
+	std::shared_ptr<jar_deflate_job> take(bool wait)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (in_order.empty())
+			return nullptr;
+		auto job = in_order.front();
+		if (!job->done)
+		{
+			if (!wait)
+				return nullptr;
+			job_done.wait(lock, [&job]() { return job->done; });
+		}
+		in_order.pop_front();
+		queued_bytes -= job->data.size();
+		return job;
+	}
+
+	void run()
+	{
+		while (true)
+		{
+			std::shared_ptr<jar_deflate_job> job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				work_available.wait(lock, [this]() { return stopping || !todo.empty(); });
+				if (stopping)
+					return;
+				job = todo.front();
+				todo.pop_front();
+			}
+			try
+			{
+				job->deflated.resize(job->data.size() + job->data.size() / 2);
+				job->clen = deflate_parts(level, job->data.data(), job->data.size(), nullptr, 0,
+										  job->deflated.data(), job->deflated.size());
+			}
+			catch (...)
+			{
+				// out of memory, store it
+				job->clen = 0;
+			}
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				job->done = true;
+			}
+			job_done.notify_all();
+		}
+	}
+
+	static const size_t max_queued_bytes = 64 * 1024 * 1024;
+
+	int level;
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable work_available;
+	std::condition_variable job_done;
+	std::deque<std::shared_ptr<jar_deflate_job>> todo;
+	std::deque<std::shared_ptr<jar_deflate_job>> in_order;
+	size_t queued_bytes = 0;
+	bool stopping = false;
+};
+
 void jar::init(unpacker *u_)
 {
 	BYTES_OF(*this).clear();
 	u = u_;
 	u->jarout = this;
+	compression = UNPACK_200_BEST;
+	threads = 1;
+}
+
+void jar::free()
+{
+	delete deflater;
+	deflater = nullptr;
+	central_directory.free();
+	deflated.free();
+}
+
+ushort jar::deflate_flags()
+{
+	// 04 = fast, 02 = maximum sub-compression flag
+	return compression == UNPACK_200_FAST ? 0x4 : 0x2;
 }
 
 // Write data to the ZIP output stream.
 void jar::write_data(void *buff, int len)
 {
+	if (write_output_fn != nullptr)
+	{
+		if (len > 0 && !write_output_fn(write_output_cookie, buff, len))
+		{
+			unpack_abort("write on output failed");
+		}
+		output_file_offset += len;
+		return;
+	}
 	while (len > 0)
 	{
 		int rc = (int)fwrite(buff, 1, len, jarfp);
 		if (rc <= 0)
 		{
-			fprintf(stderr, "Error: write on output file failed err=%d\n", errno);
-			exit(1); // Called only from the native standalone unpacker
+			unpack_abort("write on output file failed");
 		}
 		output_file_offset += rc;
 		buff = ((char *)buff) + rc;
@@ -107,7 +307,7 @@ void jar::add_to_jar_directory(const char *fname, bool store, int modtime, int l
 	header[3] = (ushort)SWAP_BYTES(0xA);
 
 	// flags 02 = maximum  sub-compression flag
-	header[4] = (store) ? 0x0 : SWAP_BYTES(0x2);
+	header[4] = (store) ? 0x0 : SWAP_BYTES(deflate_flags());
 
 	// Compression method 8=deflate.
 	header[5] = (store) ? 0x0 : SWAP_BYTES(0x08);
@@ -171,7 +371,7 @@ void jar::write_jar_header(const char *fname, bool store, int modtime, int len,
 	header[2] = (ushort)SWAP_BYTES(0xA);
 
 	// flags 02 = maximum  sub-compression flag
-	header[3] = (store) ? 0x0 : SWAP_BYTES(0x2);
+	header[3] = (store) ? 0x0 : SWAP_BYTES(deflate_flags());
 
 	// Compression method = deflate
 	header[4] = (store) ? 0x0 : SWAP_BYTES(0x08);
@@ -268,7 +468,16 @@ void jar::addJarEntry(const char *fname, bool deflate_hint, int modtime, bytes &
 	if (tail.len != 0)
 		crc = get_crc32(crc, (uchar *)tail.ptr, (uint32_t)tail.len);
 
-	bool deflate = (deflate_hint && len > 0);
+	bool deflate = (deflate_hint && len > 0 && compression != UNPACK_200_STORE);
+
+	if (deflate && threads > 1)
+	{
+		queue_deflate(fname, modtime, len, crc, head, tail);
+		return;
+	}
+
+	// entries have to stay in order, anything still being deflated goes first
+	write_deflated(true);
 
 	if (deflate)
 	{
@@ -292,9 +501,54 @@ void jar::addJarEntry(const char *fname, bool deflate_hint, int modtime, bytes &
 	}
 }
 
+// Hand a copy of the entry to the deflater pool, and write out what it has finished so far.
+void jar::queue_deflate(const char *fname, int modtime, int len, uint32_t crc, bytes &head,
+						bytes &tail)
+{
+	if (deflater == nullptr)
+	{
+		deflater = new jar_deflater(threads, zlib_level(compression));
+	}
+	auto job = std::make_shared<jar_deflate_job>();
+	job->name = fname;
+	job->modtime = modtime;
+	job->len = len;
+	job->crc = crc;
+	// the unpacker reuses head and tail for the next file
+	job->data.reserve(len);
+	job->data.insert(job->data.end(), head.ptr, head.ptr + head.len);
+	job->data.insert(job->data.end(), tail.ptr, tail.ptr + tail.len);
+	deflater->queue(job);
+	write_deflated(false);
+}
+
+// Write out the finished entries of the deflater pool, in the order they were queued.
+void jar::write_deflated(bool wait_for_all)
+{
+	if (deflater == nullptr)
+		return;
+	while (true)
+	{
+		// don't let the pool run too far ahead of the output
+		bool wait = wait_for_all || deflater->saturated();
+		auto job = deflater->take(wait);
+		if (!job)
+			return;
+		bool store = job->clen == 0;
+		int clen = store ? job->len : (int)job->clen;
+		add_to_jar_directory(job->name.c_str(), store, job->modtime, job->len, clen, job->crc);
+		write_jar_header(job->name.c_str(), store, job->modtime, job->len, clen, job->crc);
+		if (store)
+			write_data(job->data.data(), job->len);
+		else
+			write_data(job->deflated.data(), clen);
+	}
+}
+
 // Add a ZIP entry for a directory name no data
 void jar::addDirectoryToJarFile(const char *dir_name)
 {
+	write_deflated(true);
 	bool store = true;
 	add_to_jar_directory((const char *)dir_name, store, default_modtime, 0, 0, 0);
 	write_jar_header((const char *)dir_name, store, default_modtime, 0, 0, 0);
@@ -303,7 +557,13 @@ void jar::addDirectoryToJarFile(const char *dir_name)
 // Write out the central directory and close the jar file.
 void jar::closeJarFile(bool central)
 {
-	if (jarfp)
+	write_deflated(true);
+	if (write_output_fn != nullptr)
+	{
+		if (central)
+			write_central_directory();
+	}
+	else if (jarfp)
 	{
 		fflush(jarfp);
 		if (central)
@@ -360,80 +620,17 @@ bool jar::deflate_bytes(bytes &head, bytes &tail)
 {
 	int len = (int)(head.len + tail.len);
 
-	z_stream zs;
-	BYTES_OF(zs).clear();
-
-	// NOTE: the window size should always be -MAX_WBITS normally -15.
-	// unzip/zipup.c and java/Deflater.c
-
-	int error =
-		deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
-	if (error != Z_OK)
-	{
-		/*
-		switch (error)
-		{
-		case Z_MEM_ERROR:
-			PRINTCR((2, "Error: deflate error : Out of memory \n"));
-			break;
-		case Z_STREAM_ERROR:
-			PRINTCR((2, "Error: deflate error : Invalid compression level \n"));
-			break;
-		case Z_VERSION_ERROR:
-			PRINTCR((2, "Error: deflate error : Invalid version\n"));
-			break;
-		default:
-			PRINTCR((2, "Error: Internal deflate error error = %d\n", error));
-		}
-		*/
-		return false;
-	}
-
 	deflated.empty();
-	zs.next_out = (uchar *)deflated.grow(len + (len / 2));
-	zs.avail_out = (int)deflated.size();
-
-	zs.next_in = (uchar *)head.ptr;
-	zs.avail_in = (int)head.len;
-
-	bytes *first = &head;
-	bytes *last = &tail;
-	if (last->len == 0)
+	deflated.grow(len + (len / 2));
+	size_t clen = deflate_parts(zlib_level(compression), (uchar *)head.ptr, head.len,
+								(uchar *)tail.ptr, tail.len, (uchar *)deflated.base(),
+								deflated.size());
+	if (clen == 0)
 	{
-		first = nullptr;
-		last = &head;
-	}
-	else if (first->len == 0)
-	{
-		first = nullptr;
-	}
-
-	if (first != nullptr && error == Z_OK)
-	{
-		zs.next_in = (uchar *)first->ptr;
-		zs.avail_in = (int)first->len;
-		error = deflate(&zs, Z_NO_FLUSH);
-	}
-	if (error == Z_OK)
-	{
-		zs.next_in = (uchar *)last->ptr;
-		zs.avail_in = (int)last->len;
-		error = deflate(&zs, Z_FINISH);
-	}
-	if (error == Z_STREAM_END)
-	{
-		if (len > (int)zs.total_out)
-		{
-			deflated.b.len = zs.total_out;
-			deflateEnd(&zs);
-			return true;
-		}
-		deflateEnd(&zs);
 		return false;
 	}
-
-	deflateEnd(&zs);
-	return false;
+	deflated.b.len = clen;
+	return true;
 }
 
 // Callback for fetching data from a GZIP input stream
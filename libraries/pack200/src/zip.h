@@ -27,12 +27,20 @@ typedef unsigned short ushort;
 typedef unsigned int uint32_t;
 typedef unsigned char uchar;
 
+#include "unpack200.h"
+
 struct unpacker;
+struct jar_deflater;
 
 struct jar
 {
 	// JAR file writer
 	FILE *jarfp;
+
+	// alternatively, a callback that receives the JAR bytes
+	typedef bool (*write_output_fn_t)(void *cookie, const void *buf, size_t len);
+	write_output_fn_t write_output_fn;
+	void *write_output_cookie;
 	int default_modtime;
 
 	// Used by unix2dostime:
@@ -48,6 +56,12 @@ struct jar
 	// pointer to outer unpacker, for error checks etc.
 	unpacker *u;
 
+	// compression settings
+	unpack_200_compression compression;
+	int threads;
+	// worker pool for deflating entries, created on first use when threads > 1
+	jar_deflater *deflater;
+
 	// Public Methods
 	void openJarFile(const char *fname);
 	void addJarEntry(const char *fname, bool deflate_hint, int modtime, bytes &head,
@@ -57,11 +71,7 @@ struct jar
 
 	void init(unpacker *u_);
 
-	void free()
-	{
-		central_directory.free();
-		deflated.free();
-	}
+	void free();
 
 	void reset()
 	{
@@ -83,6 +93,11 @@ struct jar
 	uint32_t dostime(int y, int n, int d, int h, int m, int s);
 	uint32_t get_dostime(int modtime);
 
+	void queue_deflate(const char *fname, int modtime, int len, uint32_t crc, bytes &head,
+					   bytes &tail);
+	void write_deflated(bool wait_for_all);
+	ushort deflate_flags();
+
 	// The definitions of these depend on the NO_ZLIB option:
 	bool deflate_bytes(bytes &head, bytes &tail);
 	static uint32_t get_crc32(uint32_t c, unsigned char *ptr, uint32_t len);